@@ -0,0 +1,86 @@
+/**
+  * @file benchmark.h
+  *
+  * @brief Timing helpers shared by the benchmark examples.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+
+namespace benchmark
+{
+
+
+/** Prevent the optimizer from discarding a computed value. **/
+template<typename T>
+void KeepAlive(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+
+/** @return Seconds elapsed while calling function once. **/
+template<typename Function>
+double Time(Function &&function)
+{
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(end - start).count();
+}
+
+
+inline void PrintRate(double seconds, size_t byteCount)
+{
+    if (byteCount > 0)
+    {
+        std::cout << std::setw(12)
+            << static_cast<double>(byteCount) / seconds / 1e9 << " GB/s";
+    }
+
+    std::cout << std::endl;
+}
+
+
+/** Print the time per operation, and optionally the throughput. **/
+inline void Report(
+    const std::string &name,
+    double seconds,
+    size_t operationCount,
+    size_t byteCount = 0)
+{
+    std::cout << std::left << std::setw(44) << name << std::right
+        << std::fixed << std::setprecision(2)
+        << std::setw(12)
+        << seconds * 1e9 / static_cast<double>(operationCount) << " ns/op";
+
+    PrintRate(seconds, byteCount);
+}
+
+
+/** Print the total time of a single long operation. **/
+inline void ReportTotal(
+    const std::string &name,
+    double seconds,
+    size_t byteCount = 0)
+{
+    std::cout << std::left << std::setw(44) << name << std::right
+        << std::fixed << std::setprecision(2)
+        << std::setw(12) << seconds * 1e3 << " ms   ";
+
+    PrintRate(seconds, byteCount);
+}
+
+
+} // end namespace benchmark
@@ -0,0 +1,196 @@
+/**
+  * Compares a handwritten field-by-field serializer against
+  * io::WriteFields/io::ReadFields, which copy adjacent trivially copyable
+  * fields together.
+  */
+
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <jive/binary_fields.h>
+#include <jive/buffered_io.h>
+
+#include "benchmark.h"
+
+
+struct Sample
+{
+    uint64_t timestamp;
+    uint32_t channel;
+    uint32_t sequence;
+    float x;
+    float y;
+    float z;
+    float w;
+
+    static constexpr auto fields = std::make_tuple(
+        &Sample::timestamp,
+        &Sample::channel,
+        &Sample::sequence,
+        &Sample::x,
+        &Sample::y,
+        &Sample::z,
+        &Sample::w);
+};
+
+
+static constexpr size_t sampleCount = 2'000'000;
+
+
+// Serialize into a preallocated string, so the destination costs nothing.
+class Destination
+{
+public:
+    explicit Destination(size_t byteCount)
+        :
+        bytes_(),
+        offset_(0)
+    {
+        this->bytes_.reserve(byteCount);
+    }
+
+    jive::io::WriteFunction GetWriteFunction()
+    {
+        return [this](const void * const source, size_t size, size_t count)
+        {
+            this->bytes_.append(
+                static_cast<const char *>(source),
+                size * count);
+        };
+    }
+
+    jive::io::ReadSomeFunction GetReadFunction()
+    {
+        return [this](void * const target, size_t byteCount)
+        {
+            auto count = std::min(
+                byteCount,
+                this->bytes_.size() - this->offset_);
+
+            std::memcpy(target, this->bytes_.data() + this->offset_, count);
+            this->offset_ += count;
+
+            return count;
+        };
+    }
+
+private:
+    std::string bytes_;
+    size_t offset_;
+};
+
+
+int main()
+{
+    auto byteCount = sampleCount * sizeof(Sample);
+
+    Sample sample{1, 2, 3, 4.0f, 5.0f, 6.0f, 7.0f};
+
+    {
+        Destination destination(byteCount);
+
+        auto writeSeconds = benchmark::Time(
+            [&]()
+            {
+                jive::io::BufferedWriter writer(
+                    destination.GetWriteFunction());
+
+                for (size_t i = 0; i < sampleCount; ++i)
+                {
+                    sample.sequence = static_cast<uint32_t>(i);
+                    writer.Write(sample.timestamp);
+                    writer.Write(sample.channel);
+                    writer.Write(sample.sequence);
+                    writer.Write(sample.x);
+                    writer.Write(sample.y);
+                    writer.Write(sample.z);
+                    writer.Write(sample.w);
+                }
+            });
+
+        Sample target{};
+        uint64_t sum = 0;
+
+        auto readSeconds = benchmark::Time(
+            [&]()
+            {
+                jive::io::BufferedReader reader(
+                    destination.GetReadFunction());
+
+                for (size_t i = 0; i < sampleCount; ++i)
+                {
+                    target.timestamp = reader.Read<uint64_t>();
+                    target.channel = reader.Read<uint32_t>();
+                    target.sequence = reader.Read<uint32_t>();
+                    target.x = reader.Read<float>();
+                    target.y = reader.Read<float>();
+                    target.z = reader.Read<float>();
+                    target.w = reader.Read<float>();
+                    sum += target.sequence;
+                }
+            });
+
+        benchmark::KeepAlive(sum);
+
+        benchmark::Report(
+            "Handwritten write",
+            writeSeconds,
+            sampleCount,
+            byteCount);
+
+        benchmark::Report(
+            "Handwritten read",
+            readSeconds,
+            sampleCount,
+            byteCount);
+    }
+
+    {
+        Destination destination(byteCount);
+
+        auto writeSeconds = benchmark::Time(
+            [&]()
+            {
+                jive::io::BufferedWriter writer(
+                    destination.GetWriteFunction());
+
+                for (size_t i = 0; i < sampleCount; ++i)
+                {
+                    sample.sequence = static_cast<uint32_t>(i);
+                    jive::io::WriteFields(writer, sample);
+                }
+            });
+
+        Sample target{};
+        uint64_t sum = 0;
+
+        auto readSeconds = benchmark::Time(
+            [&]()
+            {
+                jive::io::BufferedReader reader(
+                    destination.GetReadFunction());
+
+                for (size_t i = 0; i < sampleCount; ++i)
+                {
+                    jive::io::ReadFields(reader, target);
+                    sum += target.sequence;
+                }
+            });
+
+        benchmark::KeepAlive(sum);
+
+        benchmark::Report(
+            "WriteFields",
+            writeSeconds,
+            sampleCount,
+            byteCount);
+
+        benchmark::Report(
+            "ReadFields",
+            readSeconds,
+            sampleCount,
+            byteCount);
+    }
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+/**
+  * Compares serializing a std::vector<float> one element at a time against
+  * io::WriteArray/io::ReadArray.
+  */
+
+#include <numeric>
+#include <sstream>
+#include <vector>
+#include <jive/binary_io.h>
+
+#include "benchmark.h"
+
+
+static constexpr size_t elementCount = 4'000'000;
+
+
+int main()
+{
+    std::vector<float> values(elementCount);
+    std::iota(values.begin(), values.end(), 0.0f);
+
+    auto byteCount = elementCount * sizeof(float);
+
+    {
+        std::stringstream stream;
+
+        auto writeSeconds = benchmark::Time(
+            [&]()
+            {
+                for (auto value: values)
+                {
+                    jive::io::Write(stream, value);
+                }
+            });
+
+        std::vector<float> recovered(elementCount);
+
+        auto readSeconds = benchmark::Time(
+            [&]()
+            {
+                for (auto &value: recovered)
+                {
+                    value = jive::io::Read<float>(stream);
+                }
+            });
+
+        benchmark::Report("Write per element", writeSeconds, elementCount, byteCount);
+        benchmark::Report("Read per element", readSeconds, elementCount, byteCount);
+    }
+
+    {
+        std::stringstream stream;
+
+        auto writeSeconds = benchmark::Time(
+            [&]()
+            {
+                jive::io::WriteArray<uint32_t>(stream, values);
+            });
+
+        std::vector<float> recovered;
+
+        auto readSeconds = benchmark::Time(
+            [&]()
+            {
+                recovered = jive::io::ReadArray<float>(stream);
+            });
+
+        benchmark::KeepAlive(recovered.back());
+
+        benchmark::Report("WriteArray", writeSeconds, elementCount, byteCount);
+        benchmark::Report("ReadArray", readSeconds, elementCount, byteCount);
+    }
+
+    return 0;
+}
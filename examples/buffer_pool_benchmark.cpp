@@ -0,0 +1,123 @@
+/**
+  * Compares allocation churn through jive::Buffer and jive::BufferPool.
+  */
+
+#include <random>
+#include <thread>
+#include <vector>
+#include <jive/buffer.h>
+#include <jive/buffer_pool.h>
+
+#include "benchmark.h"
+
+
+static constexpr size_t iterationCount = 2'000'000;
+
+
+std::vector<size_t> MakeSizes()
+{
+    // Typical message sizes, from a few bytes up to 64 KiB.
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<size_t> distribution(16, 65536);
+    std::vector<size_t> sizes(4096);
+
+    for (auto &size: sizes)
+    {
+        size = distribution(generator);
+    }
+
+    return sizes;
+}
+
+
+template<typename Allocate>
+double Churn(const std::vector<size_t> &sizes, Allocate &&allocate)
+{
+    return benchmark::Time(
+        [&]()
+        {
+            for (size_t i = 0; i < iterationCount; ++i)
+            {
+                auto buffer = allocate(sizes[i % sizes.size()]);
+                buffer.Get()[0] = static_cast<uint8_t>(i);
+                benchmark::KeepAlive(buffer.Get()[0]);
+            }
+        });
+}
+
+
+template<typename Allocate>
+double ChurnThreads(
+    size_t threadCount,
+    const std::vector<size_t> &sizes,
+    Allocate &&allocate)
+{
+    return benchmark::Time(
+        [&]()
+        {
+            std::vector<std::thread> threads;
+
+            for (size_t i = 0; i < threadCount; ++i)
+            {
+                threads.emplace_back(
+                    [&]()
+                    {
+                        Churn(sizes, allocate);
+                    });
+            }
+
+            for (auto &thread: threads)
+            {
+                thread.join();
+            }
+        });
+}
+
+
+int main()
+{
+    auto sizes = MakeSizes();
+    auto &pool = jive::BufferPool<uint8_t, 64>::Get();
+
+    auto allocateBuffer = [](size_t size)
+    {
+        return jive::Buffer<uint8_t, 64>(size);
+    };
+
+    auto allocatePooled = [&pool](size_t size)
+    {
+        return pool.Acquire(size);
+    };
+
+    benchmark::Report(
+        "Buffer",
+        Churn(sizes, allocateBuffer),
+        iterationCount);
+
+    benchmark::Report(
+        "BufferPool",
+        Churn(sizes, allocatePooled),
+        iterationCount);
+
+    size_t threadCount =
+        std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+
+    auto label = " x " + std::to_string(threadCount) + " threads";
+
+    benchmark::Report(
+        "Buffer" + label,
+        ChurnThreads(threadCount, sizes, allocateBuffer),
+        iterationCount * threadCount);
+
+    benchmark::Report(
+        "BufferPool" + label,
+        ChurnThreads(threadCount, sizes, allocatePooled),
+        iterationCount * threadCount);
+
+    auto stats = pool.GetStats();
+
+    std::cout << "Pool hit rate: " << stats.GetHitRate()
+        << ", outstanding bytes: " << stats.outstandingByteCount << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+  * Times the first touch and a sequential scan over a large jive::Buffer, for
+  * each allocation policy.
+  *
+  * Usage: buffer_scan_benchmark [megabytes]
+  */
+
+#include <numeric>
+#include <optional>
+#include <string>
+#include <jive/buffer.h>
+#include <jive/memory_map.h>
+
+#include "benchmark.h"
+
+
+using Element = uint64_t;
+
+
+template<typename Buffer>
+void Scan(const std::string &name, size_t elementCount)
+{
+    try
+    {
+        std::optional<Buffer> buffer;
+
+        auto allocateSeconds = benchmark::Time(
+            [&]()
+            {
+                buffer.emplace(elementCount);
+            });
+
+        auto data = buffer->Get();
+        auto byteCount = buffer->GetByteCount();
+
+        auto touchSeconds = benchmark::Time(
+            [&]()
+            {
+                for (size_t i = 0; i < elementCount; ++i)
+                {
+                    data[i] = i;
+                }
+            });
+
+        Element sum = 0;
+
+        auto scanSeconds = benchmark::Time(
+            [&]()
+            {
+                sum = std::accumulate(data, data + elementCount, Element{0});
+            });
+
+        benchmark::KeepAlive(sum);
+
+        benchmark::ReportTotal(name + " allocate", allocateSeconds);
+        benchmark::ReportTotal(name + " first write", touchSeconds, byteCount);
+        benchmark::ReportTotal(name + " scan", scanSeconds, byteCount);
+    }
+    catch (jive::MemoryMapError &error)
+    {
+        std::cout << name << ": " << error.what() << std::endl;
+    }
+}
+
+
+int main(int argumentCount, char **arguments)
+{
+    size_t megabytes = 1024;
+
+    if (argumentCount > 1)
+    {
+        megabytes = std::stoul(arguments[1]);
+    }
+
+    auto elementCount = megabytes * 1024 * 1024 / sizeof(Element);
+
+    using jive::HugePages;
+    using jive::MappedAllocation;
+
+    Scan<jive::Buffer<Element, 64>>("operator new", elementCount);
+
+    Scan<jive::Buffer<Element, 64, MappedAllocation<>>>(
+        "mmap",
+        elementCount);
+
+    Scan<jive::Buffer<Element, 64, MappedAllocation<HugePages::none, true>>>(
+        "mmap populate",
+        elementCount);
+
+    Scan<jive::HugePageBuffer<Element>>(
+        "THP",
+        elementCount);
+
+    Scan<jive::HugePageBuffer<Element, HugePages::transparent, true>>(
+        "THP populate",
+        elementCount);
+
+    Scan<jive::HugePageBuffer<Element, HugePages::reserved, true>>(
+        "hugetlb populate",
+        elementCount);
+
+    return 0;
+}
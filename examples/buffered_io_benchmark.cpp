@@ -0,0 +1,102 @@
+/**
+  * Compares serializing small values with io::Write/io::Read against
+  * io::BufferedWriter/io::BufferedReader.
+  */
+
+#include <sstream>
+#include <jive/binary_io.h>
+#include <jive/buffered_io.h>
+
+#include "benchmark.h"
+
+
+static constexpr size_t recordCount = 2'000'000;
+
+// Each record is a uint8_t, uint32_t and double.
+static constexpr size_t recordByteCount = 13;
+
+
+int main()
+{
+    auto byteCount = recordCount * recordByteCount;
+
+    {
+        std::stringstream stream;
+
+        auto writeSeconds = benchmark::Time(
+            [&]()
+            {
+                for (size_t i = 0; i < recordCount; ++i)
+                {
+                    jive::io::Write(stream, static_cast<uint8_t>(i));
+                    jive::io::Write(stream, static_cast<uint32_t>(i));
+                    jive::io::Write(stream, static_cast<double>(i));
+                }
+            });
+
+        double sum = 0;
+
+        auto readSeconds = benchmark::Time(
+            [&]()
+            {
+                for (size_t i = 0; i < recordCount; ++i)
+                {
+                    sum += jive::io::Read<uint8_t>(stream);
+                    sum += jive::io::Read<uint32_t>(stream);
+                    sum += jive::io::Read<double>(stream);
+                }
+            });
+
+        benchmark::KeepAlive(sum);
+        benchmark::Report("io::Write", writeSeconds, recordCount, byteCount);
+        benchmark::Report("io::Read", readSeconds, recordCount, byteCount);
+    }
+
+    {
+        std::stringstream stream;
+
+        auto writeSeconds = benchmark::Time(
+            [&]()
+            {
+                jive::io::BufferedWriter writer(stream);
+
+                for (size_t i = 0; i < recordCount; ++i)
+                {
+                    writer.Write(static_cast<uint8_t>(i));
+                    writer.Write(static_cast<uint32_t>(i));
+                    writer.Write(static_cast<double>(i));
+                }
+            });
+
+        double sum = 0;
+
+        auto readSeconds = benchmark::Time(
+            [&]()
+            {
+                jive::io::BufferedReader reader(stream);
+
+                for (size_t i = 0; i < recordCount; ++i)
+                {
+                    sum += reader.Read<uint8_t>();
+                    sum += reader.Read<uint32_t>();
+                    sum += reader.Read<double>();
+                }
+            });
+
+        benchmark::KeepAlive(sum);
+
+        benchmark::Report(
+            "BufferedWriter",
+            writeSeconds,
+            recordCount,
+            byteCount);
+
+        benchmark::Report(
+            "BufferedReader",
+            readSeconds,
+            recordCount,
+            byteCount);
+    }
+
+    return 0;
+}
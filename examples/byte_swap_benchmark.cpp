@@ -0,0 +1,156 @@
+/**
+  * Compares converting arrays to big-endian one element at a time against
+  * the bulk SwapBytes kernel, and the cost of big-endian WriteArray.
+  *
+  * SwapBytes uses SSSE3 or AVX2 only when the compiler targets them, so build
+  * with -march=native (or -mavx2) to measure the vector kernels.
+  */
+
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <jive/binary_io.h>
+#include <jive/endian_tools.h>
+
+#include "benchmark.h"
+
+
+static constexpr size_t byteCount = 1 << 20;
+static constexpr size_t repeatCount = 200;
+
+
+template<typename T>
+void CompareSwaps(const std::string &typeName)
+{
+    static constexpr size_t elementCount = byteCount / sizeof(T);
+
+    std::vector<T> values(elementCount);
+    std::iota(values.begin(), values.end(), T{1});
+    std::vector<T> converted(elementCount);
+
+    auto scalarSeconds = benchmark::Time(
+        [&]()
+        {
+            for (size_t repeat = 0; repeat < repeatCount; ++repeat)
+            {
+                for (size_t i = 0; i < elementCount; ++i)
+                {
+                    converted[i] = jive::HostToBigEndian(values[i]);
+                }
+
+                benchmark::KeepAlive(converted[repeat % elementCount]);
+            }
+        });
+
+    auto bulkSeconds = benchmark::Time(
+        [&]()
+        {
+            for (size_t repeat = 0; repeat < repeatCount; ++repeat)
+            {
+                jive::SwapBytes(values.data(), converted.data(), elementCount);
+                benchmark::KeepAlive(converted[repeat % elementCount]);
+            }
+        });
+
+    auto operationCount = elementCount * repeatCount;
+    auto totalByteCount = byteCount * repeatCount;
+
+    benchmark::Report(
+        "HostToBigEndian per element, " + typeName,
+        scalarSeconds,
+        operationCount,
+        totalByteCount);
+
+    benchmark::Report(
+        "SwapBytes, " + typeName,
+        bulkSeconds,
+        operationCount,
+        totalByteCount);
+}
+
+
+void CompareWrites()
+{
+    static constexpr size_t elementCount = 4'000'000;
+
+    std::vector<float> values(elementCount);
+    std::iota(values.begin(), values.end(), 0.0f);
+
+    auto totalByteCount = elementCount * sizeof(float);
+
+    std::stringstream perElement;
+
+    auto perElementSeconds = benchmark::Time(
+        [&]()
+        {
+            for (auto value: values)
+            {
+                jive::io::Write<std::endian::big>(perElement, value);
+            }
+        });
+
+    std::stringstream native;
+
+    auto nativeSeconds = benchmark::Time(
+        [&]()
+        {
+            jive::io::WriteArray(native, values);
+        });
+
+    std::stringstream bigEndian;
+
+    auto bigEndianSeconds = benchmark::Time(
+        [&]()
+        {
+            jive::io::WriteArray<std::endian::big>(bigEndian, values);
+        });
+
+    std::vector<float> recovered(elementCount);
+
+    auto readSeconds = benchmark::Time(
+        [&]()
+        {
+            jive::io::ReadArray<std::endian::big>(bigEndian, recovered);
+        });
+
+    benchmark::KeepAlive(recovered.back());
+
+    benchmark::Report(
+        "Write<big> per element",
+        perElementSeconds,
+        elementCount,
+        totalByteCount);
+
+    benchmark::Report(
+        "WriteArray, host order",
+        nativeSeconds,
+        elementCount,
+        totalByteCount);
+
+    benchmark::Report(
+        "WriteArray<big>",
+        bigEndianSeconds,
+        elementCount,
+        totalByteCount);
+
+    benchmark::Report(
+        "ReadArray<big>",
+        readSeconds,
+        elementCount,
+        totalByteCount);
+}
+
+
+int main()
+{
+    CompareSwaps<uint16_t>("uint16_t");
+    CompareSwaps<uint32_t>("uint32_t");
+    CompareSwaps<uint64_t>("uint64_t");
+    CompareSwaps<float>("float");
+    CompareSwaps<double>("double");
+
+    CompareWrites();
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/**
+  * Reads a stream of small objects over loopback with Client, comparing
+  * exact reads, which receive one object per call, with opportunistic reads
+  * and ReadMany, which take everything that has arrived.
+  */
+
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <jive/socket/client.h>
+
+#include "benchmark.h"
+
+
+struct Sample
+{
+    uint32_t id;
+    float value;
+};
+
+
+static constexpr size_t sampleCount = 1'000'000;
+static constexpr size_t batchCount = 1024;
+
+
+enum class Mode
+{
+    exact,
+    opportunistic,
+    many
+};
+
+
+static double TimeReads(Mode mode)
+{
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    listener.Listen();
+
+    jive::Client<65536> client(listener.GetLocalAddress());
+    auto server = listener.Accept();
+
+    std::thread writer(
+        [&server]()
+        {
+            std::vector<Sample> samples(batchCount);
+
+            for (size_t sent = 0; sent < sampleCount; sent += batchCount)
+            {
+                for (size_t i = 0; i < batchCount; ++i)
+                {
+                    samples[i] = Sample{static_cast<uint32_t>(sent + i), 1.0f};
+                }
+
+                size_t byteCount = samples.size() * sizeof(Sample);
+                size_t sentCount = 0;
+                auto bytes = reinterpret_cast<const char *>(samples.data());
+
+                while (sentCount < byteCount)
+                {
+                    sentCount += *server.SendWait(
+                        bytes + sentCount,
+                        byteCount - sentCount);
+                }
+            }
+        });
+
+    client.SetOpportunisticReads(mode != Mode::exact);
+    uint64_t checksum = 0;
+
+    auto seconds = benchmark::Time(
+        [&]()
+        {
+            if (mode == Mode::many)
+            {
+                std::array<Sample, batchCount> samples;
+
+                for (size_t read = 0; read < sampleCount; read += batchCount)
+                {
+                    client.ReadMany(std::span(samples));
+                    checksum += samples.back().id;
+                }
+
+                return;
+            }
+
+            for (size_t read = 0; read < sampleCount; ++read)
+            {
+                checksum += client.Read<Sample>().id;
+            }
+        });
+
+    writer.join();
+    benchmark::KeepAlive(checksum);
+
+    return seconds;
+}
+
+
+int main()
+{
+    auto byteCount = sampleCount * sizeof(Sample);
+
+    benchmark::Report(
+        "Exact Read<T>",
+        TimeReads(Mode::exact),
+        sampleCount,
+        byteCount);
+
+    benchmark::Report(
+        "Opportunistic Read<T>",
+        TimeReads(Mode::opportunistic),
+        sampleCount,
+        byteCount);
+
+    benchmark::Report(
+        "ReadMany",
+        TimeReads(Mode::many),
+        sampleCount,
+        byteCount);
+
+    return 0;
+}
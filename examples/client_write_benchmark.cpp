@@ -0,0 +1,90 @@
+/**
+  * Writes a stream of small objects over loopback with Client, comparing
+  * one send per object with writes coalesced by a high-water mark.
+  */
+
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <jive/socket/client.h>
+
+#include "benchmark.h"
+
+
+struct Sample
+{
+    uint32_t id;
+    float value;
+};
+
+
+static constexpr size_t sampleCount = 200'000;
+
+
+static double TimeWrites(size_t highWater)
+{
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    listener.Listen();
+
+    jive::Client<65536> client(listener.GetLocalAddress());
+    auto server = listener.Accept();
+
+    std::thread reader(
+        [&server]()
+        {
+            std::array<char, 65536> buffer;
+            size_t byteCount = sampleCount * sizeof(Sample);
+            size_t receivedCount = 0;
+
+            while (receivedCount < byteCount)
+            {
+                receivedCount += *server.ReceiveWait(
+                    buffer.data(),
+                    buffer.size());
+            }
+        });
+
+    client.SetWriteHighWater(highWater);
+
+    auto seconds = benchmark::Time(
+        [&]()
+        {
+            for (size_t i = 0; i < sampleCount; ++i)
+            {
+                client.Write(Sample{static_cast<uint32_t>(i), 1.0f});
+            }
+
+            client.Flush();
+        });
+
+    reader.join();
+
+    return seconds;
+}
+
+
+int main()
+{
+    auto byteCount = sampleCount * sizeof(Sample);
+
+    benchmark::Report(
+        "Unbuffered Write<T>",
+        TimeWrites(0),
+        sampleCount,
+        byteCount);
+
+    benchmark::Report(
+        "Write<T>, 4 KiB high water",
+        TimeWrites(4096),
+        sampleCount,
+        byteCount);
+
+    benchmark::Report(
+        "Write<T>, 64 KiB high water",
+        TimeWrites(65536),
+        sampleCount,
+        byteCount);
+
+    return 0;
+}
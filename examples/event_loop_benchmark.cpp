@@ -0,0 +1,128 @@
+/**
+  * Echoes small messages over thousands of loopback connections served by a
+  * single EventLoop thread. Each round sends one message on every connection
+  * before reading the replies, so the loop sees many ready sockets per wait.
+  */
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <jive/socket/event_loop.h>
+
+#include "benchmark.h"
+
+
+static constexpr size_t messageByteCount = 16;
+static constexpr size_t roundCount = 20;
+
+
+// Each connection uses two handles in this process.
+static size_t GetConnectionCount(size_t requestedCount)
+{
+    struct rlimit limit{};
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    getrlimit(RLIMIT_NOFILE, &limit);
+
+    auto available = static_cast<size_t>(limit.rlim_cur);
+
+    return std::min(requestedCount, (available - 32) / 2);
+}
+
+
+int main()
+{
+    auto connectionCount = GetConnectionCount(4000);
+
+    jive::EventLoop loop;
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    auto address = listener.GetLocalAddress();
+
+    loop.Listen(
+        std::move(listener),
+        [&loop](jive::Socket &&connection)
+        {
+            loop.Add(
+                std::move(connection),
+                {
+                    [&loop](jive::Socket &socket)
+                    {
+                        std::array<char, 4096> buffer;
+
+                        while (auto count = socket.ReceiveWait(
+                                buffer.data(),
+                                buffer.size()))
+                        {
+                            if (*count == 0)
+                            {
+                                loop.Remove(socket.GetHandle());
+                                break;
+                            }
+
+                            socket.SendWait(buffer.data(), *count);
+                        }
+                    },
+                    {}});
+        });
+
+    std::thread loopThread([&loop]() { loop.Run(); });
+
+    std::vector<jive::Socket> clients(connectionCount);
+
+    auto connectSeconds = benchmark::Time(
+        [&]()
+        {
+            for (auto &client: clients)
+            {
+                client.Connect(address);
+            }
+        });
+
+    std::array<char, messageByteCount> message{};
+
+    auto echoSeconds = benchmark::Time(
+        [&]()
+        {
+            for (size_t round = 0; round < roundCount; ++round)
+            {
+                for (auto &client: clients)
+                {
+                    client.SendWait(message.data(), message.size());
+                }
+
+                for (auto &client: clients)
+                {
+                    size_t receivedCount = 0;
+
+                    while (receivedCount < messageByteCount)
+                    {
+                        receivedCount += *client.ReceiveWait(
+                            message.data() + receivedCount,
+                            messageByteCount - receivedCount);
+                    }
+                }
+            }
+        });
+
+    clients.clear();
+    loop.Stop();
+    loopThread.join();
+
+    std::cout << connectionCount << " connections" << std::endl;
+
+    benchmark::Report("Connect and accept", connectSeconds, connectionCount);
+
+    auto messageCount = connectionCount * roundCount;
+
+    benchmark::Report(
+        "Echo round trip, per message",
+        echoSeconds,
+        messageCount);
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/**
+  * Streams variable-size frames over loopback through FramedChannel, read
+  * one at a time with ReadFrame, and in batches with Dispatch on a
+  * non-blocking socket.
+  */
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <jive/socket/framed_channel.h>
+
+#include "benchmark.h"
+
+
+static constexpr size_t frameCount = 1'000'000;
+static constexpr size_t batchCount = 64;
+
+
+struct Connection
+{
+    Connection()
+        :
+        server(),
+        client()
+    {
+        jive::Socket listener;
+        listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+        listener.Listen();
+
+        this->client.Connect(listener.GetLocalAddress());
+        this->server = listener.Accept();
+    }
+
+    jive::Socket server;
+    jive::Socket client;
+};
+
+
+static std::vector<std::byte> MakePayload(size_t maximumSize)
+{
+    std::vector<std::byte> payload(maximumSize);
+
+    for (size_t i = 0; i < payload.size(); ++i)
+    {
+        payload[i] = static_cast<std::byte>(i);
+    }
+
+    return payload;
+}
+
+
+// Sizes from 16 to 1039 bytes, cycling.
+static size_t GetFrameSize(size_t index)
+{
+    return 16 + (index * 37) % 1024;
+}
+
+
+static void WriteFrames(jive::Socket &socket)
+{
+    auto payload = MakePayload(2048);
+    jive::FramedChannel channel(socket);
+    std::vector<std::span<const std::byte>> batch;
+
+    for (size_t i = 0; i < frameCount; i += batchCount)
+    {
+        batch.clear();
+
+        for (size_t j = i; j < i + batchCount; ++j)
+        {
+            batch.push_back(std::span(payload).first(GetFrameSize(j)));
+        }
+
+        channel.WriteFrames(batch);
+    }
+}
+
+
+static void TimeFrames(bool isDispatched)
+{
+    Connection connection;
+    std::thread writer(WriteFrames, std::ref(connection.client));
+
+    jive::FramedChannel channel(connection.server);
+    size_t byteCount = 0;
+    size_t receivedCount = 0;
+
+    auto seconds = benchmark::Time(
+        [&]()
+        {
+            if (!isDispatched)
+            {
+                for (; receivedCount < frameCount; ++receivedCount)
+                {
+                    byteCount += channel.ReadFrame().size();
+                }
+
+                return;
+            }
+
+            connection.server.SetNonBlocking(true);
+
+            while (receivedCount < frameCount)
+            {
+                // Stands in for an EventLoop's wait.
+                struct pollfd events{};
+                events.fd = connection.server.GetHandle();
+                events.events = POLLIN;
+                poll(&events, 1, -1);
+
+                receivedCount += channel.Dispatch(
+                    [&byteCount](std::span<const std::byte> frame)
+                    {
+                        byteCount += frame.size();
+                    });
+            }
+        });
+
+    writer.join();
+
+    benchmark::Report(
+        isDispatched ? "Dispatch, per frame" : "ReadFrame, per frame",
+        seconds,
+        receivedCount,
+        byteCount);
+}
+
+
+int main()
+{
+    TimeFrames(false);
+    TimeFrames(true);
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+/**
+  * Echoes small messages over many loopback connections, served by each
+  * available IoEngine on its own thread. Each round sends one message on
+  * every connection before reading the replies, so the engine has many
+  * requests to submit at once.
+  */
+
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <jive/socket/make_io_engine.h>
+
+#include "benchmark.h"
+
+
+static constexpr size_t connectionCount = 200;
+static constexpr size_t messageByteCount = 64;
+static constexpr size_t roundCount = 200;
+
+
+static void Serve(
+    jive::IoEngine &engine,
+    std::vector<jive::Socket> &connections,
+    std::atomic_bool &isRunning)
+{
+    for (auto &connection: connections)
+    {
+        engine.Receive(
+            connection,
+            [&engine, &connection](std::span<const std::byte> data)
+            {
+                if (data.empty())
+                {
+                    return;
+                }
+
+                // The received data is only valid during the callback.
+                auto echo = std::make_shared<std::vector<std::byte>>(
+                    data.begin(),
+                    data.end());
+
+                engine.Send(
+                    connection,
+                    *echo,
+                    [echo](std::error_code) {});
+            });
+    }
+
+    while (isRunning)
+    {
+        engine.RunOnce(jive::TimeValue(std::chrono::milliseconds(10)));
+    }
+
+    for (auto &connection: connections)
+    {
+        engine.Remove(connection);
+    }
+}
+
+
+static double Echo(std::unique_ptr<jive::IoEngine> engine)
+{
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    listener.Listen();
+
+    std::vector<jive::Socket> clients(connectionCount);
+    std::vector<jive::Socket> connections;
+
+    for (auto &client: clients)
+    {
+        client.Connect(listener.GetLocalAddress());
+        connections.push_back(listener.Accept());
+    }
+
+    std::atomic_bool isRunning = true;
+
+    std::thread server(
+        [&]()
+        {
+            Serve(*engine, connections, isRunning);
+        });
+
+    std::array<char, messageByteCount> message{};
+
+    auto seconds = benchmark::Time(
+        [&]()
+        {
+            for (size_t round = 0; round < roundCount; ++round)
+            {
+                for (auto &client: clients)
+                {
+                    client.SendWait(message.data(), message.size());
+                }
+
+                for (auto &client: clients)
+                {
+                    size_t receivedCount = 0;
+
+                    while (receivedCount < messageByteCount)
+                    {
+                        receivedCount += *client.ReceiveWait(
+                            message.data() + receivedCount,
+                            messageByteCount - receivedCount);
+                    }
+                }
+            }
+        });
+
+    isRunning = false;
+    server.join();
+
+    return seconds;
+}
+
+
+int main()
+{
+    auto messageCount = connectionCount * roundCount;
+
+    benchmark::Report(
+        "EpollEngine echo, per message",
+        Echo(std::make_unique<jive::EpollEngine>()),
+        messageCount);
+
+    auto engine = jive::MakeIoEngine();
+    std::string name = engine->GetName();
+
+    if (name == "epoll")
+    {
+        std::cout << "io_uring is not available" << std::endl;
+
+        return 0;
+    }
+
+    benchmark::Report(
+        "UringEngine echo, per message",
+        Echo(std::move(engine)),
+        messageCount);
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+/**
+  * Calls a local echo server through RpcClient, waiting for each response
+  * before the next call, and with many calls in flight over one or several
+  * pooled connections.
+  */
+
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <jive/socket/rpc_client.h>
+
+#include "benchmark.h"
+
+
+static constexpr size_t callCount = 100'000;
+static constexpr size_t pipelineDepth = 256;
+static constexpr size_t requestSize = 64;
+
+
+class EchoServer
+{
+public:
+    EchoServer()
+        :
+        loop_(),
+        address_(),
+        thread_()
+    {
+        jive::Socket listener;
+        listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+        this->address_ = listener.GetLocalAddress();
+
+        this->loop_.Listen(
+            std::move(listener),
+            [this](jive::Socket &&connection)
+            {
+                this->Serve_(std::move(connection));
+            });
+
+        this->thread_ = std::thread(
+            [this]()
+            {
+                this->loop_.Run();
+            });
+    }
+
+    ~EchoServer()
+    {
+        this->loop_.Stop();
+        this->thread_.join();
+    }
+
+    const jive::ServiceAddress & GetAddress() const
+    {
+        return this->address_;
+    }
+
+private:
+    void Serve_(jive::Socket &&connection)
+    {
+        using Channel = std::unique_ptr<jive::FramedChannel>;
+        auto channel = std::make_shared<Channel>();
+
+        // Each reply is its own small write.
+        connection.SetOption<jive::options::NoDelay>(true);
+
+        this->loop_.Add(
+            std::move(connection),
+            {
+                [this, channel](jive::Socket &socket)
+                {
+                    if (!*channel)
+                    {
+                        *channel =
+                            std::make_unique<jive::FramedChannel>(socket);
+                    }
+
+                    auto &framed = **channel;
+
+                    framed.Dispatch(
+                        [&framed](std::span<const std::byte> frame)
+                        {
+                            framed.WriteFrame(frame);
+                        });
+
+                    if (framed.IsClosed())
+                    {
+                        channel->reset();
+                        this->loop_.Remove(socket.GetHandle());
+                    }
+                },
+                {}});
+    }
+
+    jive::EventLoop loop_;
+    jive::ServiceAddress address_;
+    std::thread thread_;
+};
+
+
+static void TimeCalls(
+    const EchoServer &server,
+    size_t connectionCount,
+    size_t depth)
+{
+    jive::RpcOptions options;
+    options.connectionCount = connectionCount;
+
+    jive::RpcClient client(server.GetAddress(), options);
+    std::vector<std::byte> request(requestSize, std::byte{42});
+
+    // Let the pool connect before timing.
+    client.Call(request).get();
+
+    std::vector<std::future<jive::RpcClient::Response>> responses;
+    responses.reserve(depth);
+    size_t byteCount = 0;
+
+    auto seconds = benchmark::Time(
+        [&]()
+        {
+            for (size_t i = 0; i < callCount; i += depth)
+            {
+                responses.clear();
+
+                for (size_t j = 0; j < depth; ++j)
+                {
+                    responses.push_back(client.Call(request));
+                }
+
+                for (auto &response: responses)
+                {
+                    byteCount += response.get().size();
+                }
+            }
+        });
+
+    benchmark::Report(
+        std::to_string(connectionCount) + " connection(s), "
+            + std::to_string(depth) + " in flight, per call",
+        seconds,
+        callCount,
+        byteCount);
+}
+
+
+int main()
+{
+    EchoServer server;
+
+    TimeCalls(server, 1, 1);
+    TimeCalls(server, 1, pipelineDepth);
+    TimeCalls(server, 4, pipelineDepth);
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+/**
+  * Measures the rate at which a Server accepts connections, with one worker
+  * and with one worker per hardware thread. Several client threads connect
+  * and reset their connections, so no ephemeral ports are left waiting in
+  * TIME_WAIT.
+  */
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <jive/socket/server.h>
+
+#include "benchmark.h"
+
+
+static constexpr size_t clientThreadCount = 4;
+static constexpr size_t connectionsPerThread = 2500;
+
+
+static void TimeAccepts(size_t workerCount)
+{
+    std::atomic<size_t> acceptedCount = 0;
+
+    jive::Server server(
+        jive::ServiceAddress("127.0.0.1", 0),
+        [&acceptedCount](jive::EventLoop &, jive::Socket &&)
+        {
+            // Closing at once is all this server does.
+            ++acceptedCount;
+        },
+        workerCount);
+
+    auto connectionCount = clientThreadCount * connectionsPerThread;
+
+    auto seconds = benchmark::Time(
+        [&]()
+        {
+            std::vector<std::thread> clients;
+
+            for (size_t i = 0; i < clientThreadCount; ++i)
+            {
+                clients.emplace_back(
+                    [&server]()
+                    {
+                        for (size_t j = 0; j < connectionsPerThread; ++j)
+                        {
+                            jive::Socket client;
+                            client.SetSocketOption(SO_LINGER, linger{1, 0});
+                            client.Connect(server.GetAddress());
+                        }
+                    });
+            }
+
+            for (auto &client: clients)
+            {
+                client.join();
+            }
+
+            while (acceptedCount < connectionCount)
+            {
+                std::this_thread::yield();
+            }
+        });
+
+    benchmark::Report(
+        "Accept with " + std::to_string(server.GetWorkerCount()) + " worker(s)",
+        seconds,
+        connectionCount);
+}
+
+
+int main()
+{
+    std::cout << std::thread::hardware_concurrency() << " hardware threads"
+        << std::endl;
+
+    TimeAccepts(1);
+    TimeAccepts(0);
+    TimeAccepts(4);
+
+    return 0;
+}
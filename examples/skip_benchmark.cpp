@@ -0,0 +1,98 @@
+/**
+  * Compares ways of skipping a large section of a file: reading through a
+  * ReadFunction 256 bytes at a time (the previous io::Skip), reading in
+  * 64 KiB chunks (the current io::Skip), and seeking.
+  */
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <unistd.h>
+#include <jive/binary_io.h>
+#include <jive/buffered_io.h>
+
+#include "benchmark.h"
+
+
+static constexpr size_t fileByteCount = size_t{64} << 20;
+
+
+int main()
+{
+    char fileName[] = "/tmp/jive_skip_benchmark_XXXXXX";
+    int file = mkstemp(fileName);
+
+    if (file == -1)
+    {
+        std::cerr << "Unable to create " << fileName << std::endl;
+        return 1;
+    }
+
+    unlink(fileName);
+
+    {
+        std::vector<uint8_t> bytes(fileByteCount);
+        jive::io::BufferedWriter writer(file);
+        writer.WriteBytes(bytes.data(), bytes.size());
+    }
+
+    jive::io::ReadFunction readFunction =
+        [file](void * const target, size_t itemSize, size_t itemCount)
+        {
+            if (read(file, target, itemSize * itemCount) < 0)
+            {
+                throw jive::io::BinaryIoError("Failed to read");
+            }
+        };
+
+    lseek(file, 0, SEEK_SET);
+
+    auto smallChunkSeconds = benchmark::Time(
+        [&]()
+        {
+            uint8_t dummyBytes[256];
+            size_t byteCount = fileByteCount;
+
+            while (byteCount > 0)
+            {
+                size_t loopCount = byteCount < 256 ? byteCount : 256;
+                readFunction(&dummyBytes, 1, loopCount);
+                byteCount -= loopCount;
+            }
+        });
+
+    lseek(file, 0, SEEK_SET);
+
+    auto largeChunkSeconds = benchmark::Time(
+        [&]()
+        {
+            jive::io::Skip(readFunction, fileByteCount);
+        });
+
+    lseek(file, 0, SEEK_SET);
+
+    auto seekSeconds = benchmark::Time(
+        [&]()
+        {
+            jive::io::Skip(file, fileByteCount);
+        });
+
+    close(file);
+
+    benchmark::ReportTotal(
+        "ReadFunction, 256 byte chunks",
+        smallChunkSeconds,
+        fileByteCount);
+
+    benchmark::ReportTotal(
+        "io::Skip(ReadFunction), 64 KiB chunks",
+        largeChunkSeconds,
+        fileByteCount);
+
+    benchmark::ReportTotal(
+        "io::Skip(fileDescriptor), lseek",
+        seekSeconds,
+        fileByteCount);
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+  * Measures loopback request and response latency under each SocketTuning
+  * preset. Each request is written as a header and a body, the pattern that
+  * Nagle's algorithm and delayed acknowledgements hold back.
+  */
+
+#include <array>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <jive/socket/tuning.h>
+
+#include "benchmark.h"
+
+
+static constexpr size_t headerByteCount = 16;
+static constexpr size_t bodyByteCount = 48;
+static constexpr size_t requestByteCount = headerByteCount + bodyByteCount;
+
+
+static void ReceiveExactly(jive::Socket &socket, char *target, size_t count)
+{
+    size_t receivedCount = 0;
+
+    while (receivedCount < count)
+    {
+        auto increment = *socket.ReceiveWait(
+            target + receivedCount,
+            count - receivedCount);
+
+        if (increment == 0)
+        {
+            throw jive::SocketDisconnected();
+        }
+
+        receivedCount += increment;
+    }
+}
+
+
+static void TimeRoundTrips(
+    const std::string &name,
+    const jive::SocketTuning &tuning,
+    size_t roundCount)
+{
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    listener.Listen();
+
+    jive::Socket client;
+    client.Connect(listener.GetLocalAddress());
+    auto server = listener.Accept();
+
+    tuning.Apply(client);
+    tuning.Apply(server);
+
+    std::thread responder(
+        [&server, &tuning, roundCount]()
+        {
+            std::array<char, requestByteCount> request;
+
+            for (size_t round = 0; round < roundCount; ++round)
+            {
+                ReceiveExactly(server, request.data(), request.size());
+
+                if (tuning.quickAck)
+                {
+                    // The kernel clears quick acknowledgement as it goes.
+                    server.SetOption<jive::options::QuickAck>(
+                        *tuning.quickAck);
+                }
+
+                server.SendWait(request.data(), request.size());
+            }
+        });
+
+    std::array<char, requestByteCount> message{};
+
+    auto seconds = benchmark::Time(
+        [&]()
+        {
+            for (size_t round = 0; round < roundCount; ++round)
+            {
+                client.SendWait(message.data(), headerByteCount);
+
+                client.SendWait(
+                    message.data() + headerByteCount,
+                    bodyByteCount);
+
+                ReceiveExactly(client, message.data(), message.size());
+            }
+        });
+
+    responder.join();
+
+    benchmark::Report(name, seconds, roundCount);
+}
+
+
+int main()
+{
+    // Without NoDelay, each body waits for the delayed acknowledgement of
+    // its header, so these take far fewer rounds.
+    TimeRoundTrips("Default", jive::SocketTuning{}, 50);
+    TimeRoundTrips("LowLatency", jive::SocketTuning::LowLatency(), 20000);
+
+    try
+    {
+        TimeRoundTrips(
+            "BusyPolling",
+            jive::SocketTuning::BusyPolling(),
+            20000);
+    }
+    catch (const jive::SocketError &error)
+    {
+        std::cout << "BusyPolling unavailable: " << error.what() << std::endl;
+    }
+
+    TimeRoundTrips("Throughput", jive::SocketTuning::Throughput(), 50);
+
+    return 0;
+}
@@ -0,0 +1,257 @@
+/**
+  * Compares Unix domain sockets with TCP and UDP over loopback: stream
+  * round trips, bulk stream throughput, and datagrams sent one per call or
+  * in batches.
+  */
+
+#include <array>
+#include <string>
+#include <thread>
+#include <vector>
+#include <jive/socket/datagram_batch.h>
+
+#include "benchmark.h"
+
+
+using namespace std::string_literals;
+
+
+static constexpr size_t roundTripCount = 20000;
+static constexpr size_t messageByteCount = 64;
+static constexpr size_t bulkByteCount = 512 * 1024 * 1024;
+static constexpr size_t datagramCount = 200000;
+static constexpr size_t batchCount = 64;
+
+
+static void ReceiveExactly(jive::Socket &socket, char *target, size_t count)
+{
+    size_t receivedCount = 0;
+
+    while (receivedCount < count)
+    {
+        auto increment = *socket.ReceiveWait(
+            target + receivedCount,
+            count - receivedCount);
+
+        if (increment == 0)
+        {
+            throw jive::SocketDisconnected();
+        }
+
+        receivedCount += increment;
+    }
+}
+
+
+struct Connection
+{
+    Connection(int family, const jive::Endpoint &endpoint)
+        :
+        client(family, SOCK_STREAM),
+        server()
+    {
+        jive::Socket listener(family, SOCK_STREAM);
+        listener.Bind(endpoint);
+        listener.Listen();
+
+        this->client.Connect(listener.GetLocalEndpoint());
+        this->server = listener.Accept();
+
+        if (family == AF_INET)
+        {
+            this->client.SetOption<jive::options::NoDelay>(true);
+            this->server.SetOption<jive::options::NoDelay>(true);
+        }
+    }
+
+    jive::Socket client;
+    jive::Socket server;
+};
+
+
+static void TimeStream(
+    const std::string &name,
+    int family,
+    const jive::Endpoint &endpoint)
+{
+    Connection connection(family, endpoint);
+
+    std::thread echo(
+        [&connection]()
+        {
+            std::array<char, messageByteCount> message;
+
+            for (size_t i = 0; i < roundTripCount; ++i)
+            {
+                ReceiveExactly(
+                    connection.server,
+                    message.data(),
+                    message.size());
+
+                connection.server.SendWait(message.data(), message.size());
+            }
+        });
+
+    std::array<char, messageByteCount> message{};
+
+    auto seconds = benchmark::Time(
+        [&]()
+        {
+            for (size_t i = 0; i < roundTripCount; ++i)
+            {
+                connection.client.SendWait(message.data(), message.size());
+
+                ReceiveExactly(
+                    connection.client,
+                    message.data(),
+                    message.size());
+            }
+        });
+
+    echo.join();
+    benchmark::Report(name + " round trip", seconds, roundTripCount);
+
+    std::thread sink(
+        [&connection]()
+        {
+            std::vector<char> buffer(256 * 1024);
+            size_t receivedCount = 0;
+
+            while (receivedCount < bulkByteCount)
+            {
+                receivedCount += *connection.server.ReceiveWait(
+                    buffer.data(),
+                    buffer.size());
+            }
+        });
+
+    std::vector<char> chunk(256 * 1024);
+
+    seconds = benchmark::Time(
+        [&]()
+        {
+            for (size_t sent = 0; sent < bulkByteCount; sent += chunk.size())
+            {
+                size_t sentCount = 0;
+
+                while (sentCount < chunk.size())
+                {
+                    sentCount += *connection.client.SendWait(
+                        chunk.data() + sentCount,
+                        chunk.size() - sentCount);
+                }
+            }
+
+            sink.join();
+        });
+
+    benchmark::Report(
+        name + " bulk, per chunk",
+        seconds,
+        bulkByteCount / chunk.size(),
+        bulkByteCount);
+}
+
+
+static void TimeDatagrams(
+    const std::string &name,
+    int family,
+    const jive::Endpoint &endpoint,
+    bool isBatched)
+{
+    jive::Socket receiver(family, SOCK_DGRAM);
+    receiver.Bind(endpoint);
+
+    // Large enough that the receiver rarely drops a datagram.
+    receiver.SetOption<jive::options::ReceiveBufferSize>(8 * 1024 * 1024);
+
+    jive::Socket sender(family, SOCK_DGRAM);
+    sender.Connect(receiver.GetLocalEndpoint());
+
+    std::array<std::byte, messageByteCount> message{};
+    size_t receivedCount = 0;
+
+    auto seconds = benchmark::Time(
+        [&]()
+        {
+            std::thread reader(
+                [&]()
+                {
+                    jive::ReceiveBatch batch(batchCount, messageByteCount);
+                    receiver.SetReceiveTimeOut(0, 200000);
+
+                    // Stop when datagrams stop arriving, in case some were
+                    // dropped.
+                    while (receivedCount < datagramCount)
+                    {
+                        auto count = batch.Receive(receiver);
+
+                        if (count == 0)
+                        {
+                            break;
+                        }
+
+                        receivedCount += count;
+                    }
+                });
+
+            if (isBatched)
+            {
+                jive::SendBatch batch;
+
+                for (size_t sent = 0; sent < datagramCount; sent += batchCount)
+                {
+                    for (size_t i = 0; i < batchCount; ++i)
+                    {
+                        batch.Add(message);
+                    }
+
+                    batch.Send(sender);
+                }
+            }
+            else
+            {
+                for (size_t sent = 0; sent < datagramCount; ++sent)
+                {
+                    sender.Send(message.data(), message.size(), 0);
+                }
+            }
+
+            reader.join();
+        });
+
+    benchmark::Report(
+        name + (isBatched ? " batched datagrams" : " single datagrams"),
+        seconds,
+        receivedCount);
+}
+
+
+int main()
+{
+    TimeStream("TCP", AF_INET, jive::ServiceAddress("127.0.0.1", 0));
+
+    TimeStream(
+        "Unix",
+        AF_UNIX,
+        jive::Endpoint::Unix("\0jive_unix_socket_benchmark_stream"s));
+
+    for (bool isBatched: {false, true})
+    {
+        TimeDatagrams(
+            "UDP",
+            AF_INET,
+            jive::ServiceAddress("127.0.0.1", 0),
+            isBatched);
+
+        TimeDatagrams(
+            "Unix",
+            AF_UNIX,
+            jive::Endpoint::Unix(
+                "\0jive_unix_socket_benchmark_datagram"s
+                    + std::to_string(isBatched)),
+            isBatched);
+    }
+
+    return 0;
+}
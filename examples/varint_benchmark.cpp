@@ -0,0 +1,130 @@
+/**
+  * Encoded size and decode throughput of fixed width, LEB128 varint, and
+  * Stream VByte arrays of small integers.
+  *
+  * DecodeStreamVByte uses SSSE3 only when the compiler targets it, so build
+  * with -march=native (or -mssse3) to measure the vector decoder.
+  */
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <span>
+#include <vector>
+#include <jive/varint.h>
+
+#include "benchmark.h"
+
+
+static constexpr size_t valueCount = 4'000'000;
+static constexpr size_t repeatCount = 20;
+
+
+int main()
+{
+    std::mt19937 engine(1);
+
+    // Typical counters and ids: mostly one or two bytes.
+    std::geometric_distribution<uint32_t> distribution(0.002);
+    std::vector<uint32_t> values(valueCount);
+
+    for (auto &value: values)
+    {
+        value = distribution(engine);
+    }
+
+    auto decodedByteCount = valueCount * sizeof(uint32_t) * repeatCount;
+    auto operationCount = valueCount * repeatCount;
+
+    std::vector<uint8_t> varints(
+        valueCount * jive::io::maximumVarintByteCount);
+
+    auto varintByteCount = jive::io::EncodeVarints(
+        std::span<const uint32_t>(values),
+        varints.data());
+
+    std::vector<uint8_t> streamVByte(
+        jive::io::GetStreamVByteMaximumByteCount(valueCount));
+
+    auto streamVByteCount =
+        jive::io::EncodeStreamVByte(values, streamVByte.data());
+
+    std::cout << "Encoded bytes per value:" << std::endl
+        << "  fixed        " << sizeof(uint32_t) << std::endl
+        << "  varint       "
+        << static_cast<double>(varintByteCount) / valueCount << std::endl
+        << "  stream vbyte "
+        << static_cast<double>(streamVByteCount) / valueCount << std::endl
+        << std::endl;
+
+    std::vector<uint32_t> decoded(valueCount);
+
+    auto fixedSeconds = benchmark::Time(
+        [&]()
+        {
+            for (size_t repeat = 0; repeat < repeatCount; ++repeat)
+            {
+                std::memcpy(
+                    decoded.data(),
+                    values.data(),
+                    valueCount * sizeof(uint32_t));
+
+                benchmark::KeepAlive(decoded[repeat]);
+            }
+        });
+
+    auto varintSeconds = benchmark::Time(
+        [&]()
+        {
+            for (size_t repeat = 0; repeat < repeatCount; ++repeat)
+            {
+                jive::io::DecodeVarints(
+                    varints.data(),
+                    varintByteCount,
+                    std::span<uint32_t>(decoded));
+
+                benchmark::KeepAlive(decoded[repeat]);
+            }
+        });
+
+    auto streamVByteSeconds = benchmark::Time(
+        [&]()
+        {
+            for (size_t repeat = 0; repeat < repeatCount; ++repeat)
+            {
+                jive::io::DecodeStreamVByte(
+                    streamVByte.data(),
+                    streamVByteCount,
+                    decoded);
+
+                benchmark::KeepAlive(decoded[repeat]);
+            }
+        });
+
+    if (decoded != values)
+    {
+        std::cerr << "Decoded values do not match" << std::endl;
+        return 1;
+    }
+
+    // Throughput is reported in decoded bytes.
+    benchmark::Report(
+        "Fixed width (memcpy)",
+        fixedSeconds,
+        operationCount,
+        decodedByteCount);
+
+    benchmark::Report(
+        "DecodeVarints",
+        varintSeconds,
+        operationCount,
+        decodedByteCount);
+
+    benchmark::Report(
+        "DecodeStreamVByte",
+        streamVByteSeconds,
+        operationCount,
+        decodedByteCount);
+
+    return 0;
+}
@@ -0,0 +1,406 @@
+/**
+  * @file binary_fields.h
+  *
+  * @brief Serialize structs from a single declaration of their fields.
+  *
+  * A type opts in by listing pointers to its data members in a static
+  * constexpr tuple named fields:
+  *
+  *     struct Reading
+  *     {
+  *         uint32_t id;
+  *         int16_t x;
+  *         int16_t y;
+  *         std::optional<double> temperature;
+  *         std::string label;
+  *
+  *         static constexpr auto fields = std::make_tuple(
+  *             &Reading::id,
+  *             &Reading::x,
+  *             &Reading::y,
+  *             &Reading::temperature,
+  *             &Reading::label);
+  *     };
+  *
+  *     io::WriteFields(writer, reading);
+  *     auto copy = io::ReadFields<Reading>(reader);
+  *
+  * Fields are stored in declaration order. Consecutive trivially copyable
+  * fields that are also adjacent in memory, with no padding between them, are
+  * transferred with a single copy. std::optional is stored as a flag byte
+  * followed by the value, std::string with a uint32_t length, and std::vector
+  * of trivially copyable elements with a uint32_t count. Fields may also be
+  * other types that declare fields.
+  *
+  * The writer is a BufferedWriter. The reader is a BufferedReader or a
+  * ViewReader. Counts read from the input are checked before anything is
+  * allocated for them: against the bytes left in a ViewReader, and against
+  * the optional maximumCount of ReadFields.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "jive/binary_io.h"
+#include "jive/optional.h"
+#include "jive/property.h"
+
+
+namespace jive
+{
+
+namespace io
+{
+
+
+template<typename T>
+concept HasFields = requires
+{
+    std::tuple_size<std::remove_cvref_t<decltype(T::fields)>>::value;
+};
+
+
+namespace detail
+{
+
+
+template<auto member>
+struct MemberTraits_;
+
+template<typename T, typename Owner, T Owner::* member>
+struct MemberTraits_<member>
+{
+    using type = typename PropertyTraits<T, Owner, member>::type;
+};
+
+
+template<typename T, size_t index>
+using FieldType =
+    typename MemberTraits_<std::get<index>(T::fields)>::type;
+
+
+template<typename T>
+inline constexpr size_t fieldCount =
+    std::tuple_size_v<std::remove_cvref_t<decltype(T::fields)>>;
+
+
+template<typename T>
+struct IsVector_: std::false_type {};
+
+template<typename T>
+struct IsVector_<std::vector<T>>: std::true_type {};
+
+
+/** Fields that are copied as raw bytes, and may share a single copy. **/
+template<typename T>
+inline constexpr bool isRawField =
+    std::is_trivially_copyable_v<T>
+    && !std::is_pointer_v<T>
+    && !IsOptional<T>
+    && !HasFields<T>;
+
+
+template<typename T, size_t ... I>
+constexpr auto MakeRawFlags(std::index_sequence<I...>)
+{
+    return std::array<bool, sizeof...(I)>{isRawField<FieldType<T, I>>...};
+}
+
+
+/** @return One past the last raw field in the run that starts at first. **/
+template<typename T, size_t first>
+constexpr size_t GetRunEnd()
+{
+    constexpr auto isRaw =
+        MakeRawFlags<T>(std::make_index_sequence<fieldCount<T>>{});
+
+    size_t end = first;
+
+    while (end < isRaw.size() && isRaw[end])
+    {
+        ++end;
+    }
+
+    return end;
+}
+
+
+template<typename T, size_t index>
+const std::byte * GetFieldAddress(const T &value)
+{
+    return reinterpret_cast<const std::byte *>(
+        &(value.*std::get<index>(T::fields)));
+}
+
+
+/**
+ ** @return true when each field in [first, first + sizeof...(I)) begins
+ ** where the previous one ends. After inlining, the compiler evaluates this
+ ** at compile time.
+ **/
+template<typename T, size_t first, size_t ... I>
+bool IsContiguous(const T &value, std::index_sequence<I...>)
+{
+    return (
+        (GetFieldAddress<T, first + I>(value)
+            + sizeof(FieldType<T, first + I>)
+            == GetFieldAddress<T, first + I + 1>(value))
+        && ...);
+}
+
+
+template<typename T, size_t first, size_t end>
+size_t GetRunByteCount()
+{
+    return []<size_t ... I>(std::index_sequence<I...>)
+    {
+        return (sizeof(FieldType<T, first + I>) + ... + size_t{0});
+    }(std::make_index_sequence<end - first>{});
+}
+
+
+template<typename Reader>
+void ReadInto(Reader &reader, void *target, size_t byteCount)
+{
+    if constexpr (requires { reader.ReadBytes(target, byteCount); })
+    {
+        reader.ReadBytes(target, byteCount);
+    }
+    else
+    {
+        // ViewReader returns a view of the source.
+        std::memcpy(target, reader.ReadBytes(byteCount).data(), byteCount);
+    }
+}
+
+
+} // end namespace detail
+
+
+template<HasFields T, typename Writer>
+void WriteFields(Writer &writer, const T &value);
+
+
+template<HasFields T, typename Reader>
+void ReadFields(
+    Reader &reader,
+    T &value,
+    size_t maximumCount = std::numeric_limits<size_t>::max());
+
+
+namespace detail
+{
+
+
+template<typename Writer, typename T>
+void WriteField(Writer &writer, const T &value)
+{
+    if constexpr (HasFields<T>)
+    {
+        WriteFields(writer, value);
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+        writer.template WriteString<uint32_t>(value);
+    }
+    else if constexpr (IsOptional<T>)
+    {
+        writer.Write(static_cast<uint8_t>(value.has_value()));
+
+        if (value)
+        {
+            WriteField(writer, *value);
+        }
+    }
+    else if constexpr (IsVector_<T>::value)
+    {
+        static_assert(isRawField<typename T::value_type>);
+
+        CheckArrayCount<uint32_t>(value.size());
+        writer.Write(static_cast<uint32_t>(value.size()));
+
+        writer.WriteBytes(
+            value.data(),
+            value.size() * sizeof(typename T::value_type));
+    }
+    else
+    {
+        static_assert(isRawField<T>, "Unsupported field type");
+        writer.WriteBytes(&value, sizeof(T));
+    }
+}
+
+
+template<typename Reader, typename T>
+void ReadField(Reader &reader, T &value, size_t maximumCount)
+{
+    if constexpr (HasFields<T>)
+    {
+        ReadFields(reader, value, maximumCount);
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+        if constexpr (
+            requires { reader.template ReadString<uint32_t>(maximumCount); })
+        {
+            value = reader.template ReadString<uint32_t>(maximumCount);
+        }
+        else
+        {
+            // ViewReader checks the count against what is left of its view.
+            value = reader.template ReadString<uint32_t>();
+        }
+    }
+    else if constexpr (IsOptional<T>)
+    {
+        if (reader.template Read<uint8_t>() == 0)
+        {
+            value.reset();
+
+            return;
+        }
+
+        ReadField(reader, value.emplace(), maximumCount);
+    }
+    else if constexpr (IsVector_<T>::value)
+    {
+        using Element = typename T::value_type;
+        static_assert(isRawField<Element>);
+
+        // Check the untrusted count before allocating from it.
+        auto count = static_cast<size_t>(reader.template Read<uint32_t>());
+        CheckMaximumCount(count, maximumCount);
+
+        if constexpr (requires { reader.GetRemaining(); })
+        {
+            if (count > reader.GetRemaining() / sizeof(Element))
+            {
+                throw BinaryIoError("Read past end of view");
+            }
+        }
+
+        value.resize(count);
+
+        ReadInto(
+            reader,
+            value.data(),
+            value.size() * sizeof(typename T::value_type));
+    }
+    else
+    {
+        static_assert(isRawField<T>, "Unsupported field type");
+        ReadInto(reader, &value, sizeof(T));
+    }
+}
+
+
+template<size_t index, typename Writer, typename T>
+void WriteFrom(Writer &writer, const T &value)
+{
+    if constexpr (index < fieldCount<T>)
+    {
+        constexpr auto end = GetRunEnd<T, index>();
+
+        if constexpr (end - index > 1)
+        {
+            if (IsContiguous<T, index>(
+                    value,
+                    std::make_index_sequence<end - index - 1>{}))
+            {
+                writer.WriteBytes(
+                    GetFieldAddress<T, index>(value),
+                    GetRunByteCount<T, index, end>());
+
+                WriteFrom<end>(writer, value);
+
+                return;
+            }
+        }
+
+        WriteField(writer, value.*std::get<index>(T::fields));
+        WriteFrom<index + 1>(writer, value);
+    }
+}
+
+
+template<size_t index, typename Reader, typename T>
+void ReadFrom(Reader &reader, T &value, size_t maximumCount)
+{
+    if constexpr (index < fieldCount<T>)
+    {
+        constexpr auto end = GetRunEnd<T, index>();
+
+        if constexpr (end - index > 1)
+        {
+            if (IsContiguous<T, index>(
+                    value,
+                    std::make_index_sequence<end - index - 1>{}))
+            {
+                ReadInto(
+                    reader,
+                    &(value.*std::get<index>(T::fields)),
+                    GetRunByteCount<T, index, end>());
+
+                ReadFrom<end>(reader, value, maximumCount);
+
+                return;
+            }
+        }
+
+        ReadField(reader, value.*std::get<index>(T::fields), maximumCount);
+        ReadFrom<index + 1>(reader, value, maximumCount);
+    }
+}
+
+
+} // end namespace detail
+
+
+template<HasFields T, typename Writer>
+void WriteFields(Writer &writer, const T &value)
+{
+    detail::WriteFrom<0>(writer, value);
+}
+
+
+/**
+ ** @param maximumCount Limits the count of each std::string and std::vector
+ ** field, so that a corrupt count from a BufferedReader fails before it is
+ ** allocated.
+ **/
+template<HasFields T, typename Reader>
+void ReadFields(Reader &reader, T &value, size_t maximumCount)
+{
+    detail::ReadFrom<0>(reader, value, maximumCount);
+}
+
+
+template<HasFields T, typename Reader>
+T ReadFields(
+    Reader &reader,
+    size_t maximumCount = std::numeric_limits<size_t>::max())
+{
+    T value{};
+    ReadFields(reader, value, maximumCount);
+
+    return value;
+}
+
+
+} // end namespace io
+
+} // end namespace jive
@@ -11,15 +11,21 @@
 
 #pragma once
 
+#include <algorithm>
 #include <istream>
 #include <ostream>
 #include <string>
 #include <cstdint>
+#include <exception>
 #include <functional>
 #include <limits>
+#include <optional>
+#include <vector>
 
 #include <type_traits>
+#include <bit>
 #include "jive/create_exception.h"
+#include "jive/endian_tools.h"
 
 #include "jive/detail/binary_io_detail.h"
 
@@ -97,17 +103,55 @@ template<
 void Write(const WriteFunction &writeFunction, const T &value);
 
 
+/*
+ * Endian-tagged scalar transfer.
+ *
+ * The value is stored in byteOrder, regardless of the host byte order.
+ *
+ *     io::Write<std::endian::big>(outputStream, sample);
+ *     auto sample = io::Read<std::endian::big, int16_t>(inputStream);
+ *
+ */
+
+template<std::endian byteOrder, Swappable T>
+T Read(std::istream &inputStream);
+
+
+template<std::endian byteOrder, Swappable T>
+T Read(const ReadFunction &readFunction);
+
+
+template<std::endian byteOrder, Swappable T>
+void Write(std::ostream &outputStream, T value);
+
+
+template<std::endian byteOrder, Swappable T>
+void Write(const WriteFunction &writeFunction, T value);
+
+
 /*
  * @brief Advance the readFunction
  *
  * @param readFunction The function object backed by a file, pipe, or stream
  * @param byteCount The number of bytes to skip.
- * @remark Thread-safe because dummyBytes is never read.
+ * @remark A ReadFunction cannot seek, so the bytes are read, in large chunks,
+ * into a per-thread scratch buffer. Prefer the std::istream or file
+ * descriptor (buffered_io.h) overloads when the source supports seeking.
  *
  */
 void Skip(const ReadFunction &readFunction, size_t byteCount);
 
 
+/*
+ * @brief Advance the inputStream by byteCount bytes.
+ *
+ * Seeks when the stream supports it. Otherwise, reads and discards the bytes,
+ * and throws BinaryIoError if the stream ends first.
+ *
+ */
+void Skip(std::istream &inputStream, size_t byteCount);
+
+
 template<typename T>
 void Skip(std::istream &inputStream)
 {
@@ -118,6 +162,13 @@ void Skip(std::istream &inputStream)
 /*
  * Serialize strings with CountType other than uint8_t
  *
+ * Read<std::string>/Write<std::string> store a uint8_t length, so they are
+ * limited to 255 characters. WriteString/ReadString store the length as
+ * CountType, so uint64_t supports strings of any length.
+ *
+ * When the standard library provides resize_and_overwrite, ReadString reads
+ * directly into the new string without zero-filling it first.
+ *
  */
 
 template<typename CountType = uint32_t>
@@ -126,10 +177,146 @@ void WriteString(
     const std::string_view &longString);
 
 
+template<typename CountType = uint32_t>
+void WriteString(
+    const WriteFunction &writeFunction,
+    const std::string_view &longString);
+
+
 template<typename CountType = uint32_t>
 std::string ReadString(std::istream &inputStream);
 
 
+template<typename CountType = uint32_t>
+std::string ReadString(const ReadFunction &readFunction);
+
+
+/*
+ * Bulk transfer of contiguous, trivially copyable elements.
+ *
+ * Values may be a std::span, std::vector, std::array, C array, or any
+ * Buffer-like class (jive::Buffer, MappedBuffer, ...). The whole block is
+ * transferred in a single call to the stream or function object.
+ *
+ * When CountType is given, the element count is written first, as
+ * CountType. Otherwise, only the elements are written, and the reader must
+ * know the count.
+ *
+ *     io::WriteArray(outputStream, values);            // elements only
+ *     io::WriteArray<uint32_t>(outputStream, values);  // count, elements
+ *
+ */
+
+template<typename CountType = void, detail::ArrayIo Values>
+void WriteArray(std::ostream &outputStream, const Values &values);
+
+
+template<typename CountType = void, detail::ArrayIo Values>
+void WriteArray(const WriteFunction &writeFunction, const Values &values);
+
+
+/** Fill values with exactly as many elements as it holds. **/
+template<typename Values>
+requires detail::ArrayIo<std::remove_cvref_t<Values>>
+void ReadArray(std::istream &inputStream, Values &&values);
+
+
+template<typename Values>
+requires detail::ArrayIo<std::remove_cvref_t<Values>>
+void ReadArray(const ReadFunction &readFunction, Values &&values);
+
+
+/**
+ ** Read an element count as CountType, then that many elements.
+ **
+ ** The count is untrusted, so it is checked before anything is allocated:
+ ** against maximumCount, and against the size of a seekable stream.
+ **
+ ** @tparam Result A container constructed from the element count, like
+ ** std::vector<T> or jive::Buffer<T>. Buffer skips the zero-fill.
+ **/
+template<
+    typename T,
+    typename CountType = uint32_t,
+    typename Result = std::vector<T>>
+Result ReadArray(
+    std::istream &inputStream,
+    size_t maximumCount = std::numeric_limits<size_t>::max());
+
+
+template<
+    typename T,
+    typename CountType = uint32_t,
+    typename Result = std::vector<T>>
+Result ReadArray(
+    const ReadFunction &readFunction,
+    size_t maximumCount = std::numeric_limits<size_t>::max());
+
+
+/*
+ * Endian-tagged bulk transfer.
+ *
+ * Elements (and the count, when CountType is given) are stored in byteOrder.
+ * When byteOrder differs from the host, the elements are converted with the
+ * vectorized SwapBytes, a block at a time on write and in place on read.
+ *
+ *     io::WriteArray<std::endian::big, uint32_t>(outputStream, samples);
+ *
+ *     auto samples =
+ *         io::ReadArray<std::endian::big, int16_t, uint32_t>(inputStream);
+ *
+ */
+
+template<
+    std::endian byteOrder,
+    typename CountType = void,
+    detail::ArrayIo Values>
+requires Swappable<detail::ArrayElement<Values>>
+void WriteArray(std::ostream &outputStream, const Values &values);
+
+
+template<
+    std::endian byteOrder,
+    typename CountType = void,
+    detail::ArrayIo Values>
+requires Swappable<detail::ArrayElement<Values>>
+void WriteArray(const WriteFunction &writeFunction, const Values &values);
+
+
+template<std::endian byteOrder, typename Values>
+requires (
+    detail::ArrayIo<std::remove_cvref_t<Values>>
+    && Swappable<detail::ArrayElement<std::remove_cvref_t<Values>>>)
+void ReadArray(std::istream &inputStream, Values &&values);
+
+
+template<std::endian byteOrder, typename Values>
+requires (
+    detail::ArrayIo<std::remove_cvref_t<Values>>
+    && Swappable<detail::ArrayElement<std::remove_cvref_t<Values>>>)
+void ReadArray(const ReadFunction &readFunction, Values &&values);
+
+
+template<
+    std::endian byteOrder,
+    Swappable T,
+    typename CountType = uint32_t,
+    typename Result = std::vector<T>>
+Result ReadArray(
+    std::istream &inputStream,
+    size_t maximumCount = std::numeric_limits<size_t>::max());
+
+
+template<
+    std::endian byteOrder,
+    Swappable T,
+    typename CountType = uint32_t,
+    typename Result = std::vector<T>>
+Result ReadArray(
+    const ReadFunction &readFunction,
+    size_t maximumCount = std::numeric_limits<size_t>::max());
+
+
 } // end namespace io
 
 
@@ -24,6 +24,10 @@
   * For non-trivial types, this class offers no advantages, so these have been
   * disabled.
   *
+  * The Allocator policy chooses where the memory comes from. The default uses
+  * aligned operator new. See memory_map.h for policies backed by mmap, with
+  * optional huge pages and prefaulting.
+  *
   * @author Jive Helix (jivehelix@gmail.com)
   * @date 07 May 2020
   * @copyright Jive Helix
@@ -32,6 +36,9 @@
 
 #pragma once
 
+#include <concepts>
+#include <cstddef>
+#include <span>
 #include <type_traits>
 #include <new>
 
@@ -57,10 +64,47 @@ size_t GetAlignedByteCount(size_t count)
 
 inline constexpr auto minimumAlign = sizeof(void *);
 
+inline constexpr size_t cacheLineSize = 64;
+
+inline constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+
+/**
+ ** The default Buffer allocation policy.
+ **
+ ** An allocation policy provides:
+ **
+ **     static void * Allocate(size_t byteCount, size_t align);
+ **     static void Deallocate(void *data, size_t byteCount, size_t align);
+ **
+ ** Deallocate receives the same byteCount and align that were passed to
+ ** Allocate. Allocate must not initialize the memory it returns.
+ **/
+struct AlignedNew
+{
+    static void * Allocate(size_t byteCount, size_t align)
+    {
+        return ::operator new(byteCount, std::align_val_t{align});
+    }
+
+    static void Deallocate(
+        void *data,
+        [[maybe_unused]] size_t byteCount,
+        size_t align)
+    {
+#if defined(__cpp_sized_deallocation)
+        ::operator delete(data, byteCount, std::align_val_t{align});
+#else
+        ::operator delete(data, std::align_val_t{align});
+#endif
+    }
+};
+
 
 template<
     typename T,
-    size_t align_ = (alignof(T) < minimumAlign) ? minimumAlign : alignof(T)>
+    size_t align_ = (alignof(T) < minimumAlign) ? minimumAlign : alignof(T),
+    typename Allocator = AlignedNew>
 class Buffer
 {
 public:
@@ -77,17 +121,23 @@ public:
 
     using type = T;
 
+    using allocator = Allocator;
+
     Buffer(size_t elementCount)
         :
         byteCount_(detail::GetAlignedByteCount<T, align>(elementCount)),
         elementCount_(elementCount),
         data_(
-            static_cast<T *>(
-                ::operator new(this->byteCount_, std::align_val_t{align})))
+            static_cast<T *>(Allocator::Allocate(this->byteCount_, align)))
     {
 
     }
 
+    /**
+     ** Read elementCount elements from inputStream.
+     **
+     ** For large files, MappedBuffer (mapped_buffer.h) avoids the copy.
+     **/
     template<typename InputStream>
     static Buffer FromStream(size_t elementCount, InputStream &inputStream)
     {
@@ -102,31 +152,36 @@ public:
 
     ~Buffer()
     {
-        if (this->data_ != nullptr)
-        {
-#if defined(__cpp_sized_deallocation)
-            ::operator delete(
-                this->data_,
-                this->byteCount_,
-                std::align_val_t{align});
-#else
-            ::operator delete(
-                this->data_,
-                std::align_val_t{align});
-#endif
-        }
+        this->Release_();
     }
 
     Buffer(const Buffer &) = delete;
 
     Buffer(Buffer &&other) noexcept
         :
+        byteCount_(other.byteCount_),
         elementCount_(other.elementCount_),
         data_(other.data_)
     {
         other.data_ = nullptr;
     }
 
+    Buffer & operator=(const Buffer &) = delete;
+
+    Buffer & operator=(Buffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            this->Release_();
+            this->byteCount_ = other.byteCount_;
+            this->elementCount_ = other.elementCount_;
+            this->data_ = other.data_;
+            other.data_ = nullptr;
+        }
+
+        return *this;
+    }
+
     size_t GetElementCount() const { return this->elementCount_; }
 
     size_t GetByteCount() const { return this->elementCount_ * sizeof(T); }
@@ -137,6 +192,16 @@ public:
 
     T * Get() { return this->data_; }
 
+private:
+    void Release_()
+    {
+        if (this->data_ != nullptr)
+        {
+            Allocator::Deallocate(this->data_, this->byteCount_, align);
+            this->data_ = nullptr;
+        }
+    }
+
 private:
     size_t byteCount_;
     size_t elementCount_;
@@ -144,4 +209,27 @@ private:
 };
 
 
+/**
+ ** Satisfied by Buffer, PooledBuffer, MappedBuffer, and any other contiguous
+ ** element storage with the same read interface. Write functions against this
+ ** concept to accept any of them.
+ **/
+template<typename T>
+concept ReadableBuffer = requires (const T &buffer)
+{
+    typename T::type;
+
+    { buffer.Get() } -> std::convertible_to<const typename T::type *>;
+    { buffer.GetElementCount() } -> std::convertible_to<size_t>;
+    { buffer.GetByteCount() } -> std::convertible_to<size_t>;
+};
+
+
+template<ReadableBuffer Buffer>
+std::span<const typename Buffer::type> AsSpan(const Buffer &buffer)
+{
+    return {buffer.Get(), buffer.GetElementCount()};
+}
+
+
 } // end namespace jive
@@ -0,0 +1,384 @@
+/**
+  * @file buffer_pool.h
+  *
+  * @brief Recycles the memory behind short-lived buffers.
+  *
+  * BufferPool<T, align> hands out PooledBuffer handles with the same interface
+  * as jive::Buffer. When a handle is destroyed, its memory returns to the pool
+  * instead of the system allocator, and the next request of a similar size
+  * reuses it.
+  *
+  * Requests are rounded up to power-of-two size classes. Each thread keeps a
+  * small cache of free blocks per size class, so most acquire/release pairs
+  * never take a lock. Threads exchange blocks with a shared, mutex-protected
+  * free list in batches. Requests larger than maximumPooledByteCount are not
+  * pooled.
+  *
+  * There is one pool per <T, align>, accessed through BufferPool::Get().
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "jive/buffer.h"
+
+
+namespace jive
+{
+
+
+struct BufferPoolStats
+{
+    // Requests served from a free list.
+    uint64_t hitCount;
+
+    // Requests that required a new allocation.
+    uint64_t missCount;
+
+    // Allocated bytes currently held by PooledBuffer handles.
+    uint64_t outstandingByteCount;
+
+    double GetHitRate() const
+    {
+        auto requestCount = this->hitCount + this->missCount;
+
+        if (requestCount == 0)
+        {
+            return 0.0;
+        }
+
+        return static_cast<double>(this->hitCount)
+            / static_cast<double>(requestCount);
+    }
+};
+
+
+template<typename T, size_t align>
+class BufferPool;
+
+
+template<
+    typename T,
+    size_t align_ = (alignof(T) < minimumAlign) ? minimumAlign : alignof(T)>
+class PooledBuffer
+{
+public:
+    static_assert(std::is_trivial_v<T>);
+
+    static constexpr auto align = align_;
+
+    using type = T;
+
+    PooledBuffer(const PooledBuffer &) = delete;
+    PooledBuffer & operator=(const PooledBuffer &) = delete;
+
+    PooledBuffer(PooledBuffer &&other) noexcept
+        :
+        byteCount_(other.byteCount_),
+        elementCount_(other.elementCount_),
+        data_(other.data_)
+    {
+        other.data_ = nullptr;
+    }
+
+    PooledBuffer & operator=(PooledBuffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            this->Release_();
+            this->byteCount_ = other.byteCount_;
+            this->elementCount_ = other.elementCount_;
+            this->data_ = other.data_;
+            other.data_ = nullptr;
+        }
+
+        return *this;
+    }
+
+    ~PooledBuffer()
+    {
+        this->Release_();
+    }
+
+    size_t GetElementCount() const { return this->elementCount_; }
+
+    size_t GetByteCount() const { return this->elementCount_ * sizeof(T); }
+
+    size_t GetAllocatedByteCount() const { return this->byteCount_; }
+
+    const T * Get() const { return this->data_; }
+
+    T * Get() { return this->data_; }
+
+private:
+    friend class BufferPool<T, align>;
+
+    PooledBuffer(size_t byteCount, size_t elementCount, T *data)
+        :
+        byteCount_(byteCount),
+        elementCount_(elementCount),
+        data_(data)
+    {
+
+    }
+
+    void Release_()
+    {
+        if (this->data_ != nullptr)
+        {
+            BufferPool<T, align>::Get().Release_(this->data_, this->byteCount_);
+            this->data_ = nullptr;
+        }
+    }
+
+private:
+    size_t byteCount_;
+    size_t elementCount_;
+    T *data_;
+};
+
+
+template<
+    typename T,
+    size_t align = (alignof(T) < minimumAlign) ? minimumAlign : alignof(T)>
+class BufferPool
+{
+public:
+    static_assert(std::is_trivial_v<T>);
+    static_assert((align & (align - 1)) == 0);
+
+    static constexpr size_t minimumBlockByteCount = 64;
+    static constexpr size_t maximumPooledByteCount = size_t{1} << 26;
+
+    // Free blocks kept by each thread, per size class.
+    static constexpr size_t localBlockCount = 16;
+
+    static constexpr size_t classCount =
+        std::bit_width(maximumPooledByteCount / minimumBlockByteCount);
+
+    static BufferPool & Get()
+    {
+        static BufferPool pool;
+        return pool;
+    }
+
+    PooledBuffer<T, align> Acquire(size_t elementCount)
+    {
+        auto requestedByteCount = std::max(
+            elementCount * sizeof(T),
+            size_t{1});
+
+        // The counts change only once a block is in hand, so that a failed
+        // allocation leaves the stats as they were.
+        if (requestedByteCount > maximumPooledByteCount)
+        {
+            auto byteCount =
+                detail::GetAlignedByteCount<T, align>(elementCount);
+
+            auto block = static_cast<T *>(Allocate_(byteCount));
+
+            this->missCount_.fetch_add(1, std::memory_order_relaxed);
+
+            this->outstandingByteCount_.fetch_add(
+                byteCount,
+                std::memory_order_relaxed);
+
+            return PooledBuffer<T, align>(byteCount, elementCount, block);
+        }
+
+        auto sizeClass = GetSizeClass_(requestedByteCount);
+        auto byteCount = GetClassByteCount_(sizeClass);
+
+        auto &local = localCache_.blocks[sizeClass];
+
+        if (local.empty())
+        {
+            this->Refill_(sizeClass, local);
+        }
+
+        void *block;
+
+        if (local.empty())
+        {
+            block = Allocate_(byteCount);
+            this->missCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            block = local.back();
+            local.pop_back();
+            this->hitCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        this->outstandingByteCount_.fetch_add(
+            byteCount,
+            std::memory_order_relaxed);
+
+        return PooledBuffer<T, align>(
+            byteCount,
+            elementCount,
+            static_cast<T *>(block));
+    }
+
+    BufferPoolStats GetStats() const
+    {
+        return {
+            this->hitCount_.load(std::memory_order_relaxed),
+            this->missCount_.load(std::memory_order_relaxed),
+            this->outstandingByteCount_.load(std::memory_order_relaxed)};
+    }
+
+    /** Free the blocks held in the shared free lists. **/
+    void Trim()
+    {
+        std::lock_guard lock(this->mutex_);
+
+        for (size_t sizeClass = 0; sizeClass < classCount; ++sizeClass)
+        {
+            for (void *block: this->shared_[sizeClass])
+            {
+                Deallocate_(block, GetClassByteCount_(sizeClass));
+            }
+
+            this->shared_[sizeClass].clear();
+        }
+    }
+
+    ~BufferPool()
+    {
+        this->Trim();
+    }
+
+    BufferPool(const BufferPool &) = delete;
+    BufferPool & operator=(const BufferPool &) = delete;
+
+private:
+    friend class PooledBuffer<T, align>;
+
+    using FreeList = std::vector<void *>;
+
+    // Returns its blocks to the shared free lists when the thread exits.
+    struct LocalCache
+    {
+        std::array<FreeList, classCount> blocks;
+
+        ~LocalCache()
+        {
+            BufferPool::Get().ReturnAll_(this->blocks);
+        }
+    };
+
+    BufferPool()
+        :
+        mutex_(),
+        shared_(),
+        hitCount_(0),
+        missCount_(0),
+        outstandingByteCount_(0)
+    {
+
+    }
+
+    static size_t GetSizeClass_(size_t byteCount)
+    {
+        auto blockCount =
+            (byteCount + minimumBlockByteCount - 1) / minimumBlockByteCount;
+
+        return static_cast<size_t>(std::bit_width(blockCount - 1));
+    }
+
+    static size_t GetClassByteCount_(size_t sizeClass)
+    {
+        return minimumBlockByteCount << sizeClass;
+    }
+
+    static void * Allocate_(size_t byteCount)
+    {
+        return ::operator new(byteCount, std::align_val_t{align});
+    }
+
+    static void Deallocate_(void *block, [[maybe_unused]] size_t byteCount)
+    {
+#if defined(__cpp_sized_deallocation)
+        ::operator delete(block, byteCount, std::align_val_t{align});
+#else
+        ::operator delete(block, std::align_val_t{align});
+#endif
+    }
+
+    void Release_(void *block, size_t byteCount)
+    {
+        this->outstandingByteCount_.fetch_sub(
+            byteCount,
+            std::memory_order_relaxed);
+
+        if (byteCount > maximumPooledByteCount)
+        {
+            Deallocate_(block, byteCount);
+            return;
+        }
+
+        auto sizeClass = GetSizeClass_(byteCount);
+        auto &local = localCache_.blocks[sizeClass];
+
+        if (local.size() >= localBlockCount)
+        {
+            // Keep half, and share the rest with other threads.
+            std::lock_guard lock(this->mutex_);
+            auto &shared = this->shared_[sizeClass];
+            auto half = local.begin() + localBlockCount / 2;
+            shared.insert(shared.end(), half, local.end());
+            local.erase(half, local.end());
+        }
+
+        local.push_back(block);
+    }
+
+    void Refill_(size_t sizeClass, FreeList &local)
+    {
+        std::lock_guard lock(this->mutex_);
+        auto &shared = this->shared_[sizeClass];
+
+        auto count = std::min(shared.size(), localBlockCount / 2);
+        auto first = shared.end() - static_cast<std::ptrdiff_t>(count);
+        local.insert(local.end(), first, shared.end());
+        shared.erase(first, shared.end());
+    }
+
+    void ReturnAll_(std::array<FreeList, classCount> &blocks)
+    {
+        std::lock_guard lock(this->mutex_);
+
+        for (size_t sizeClass = 0; sizeClass < classCount; ++sizeClass)
+        {
+            auto &shared = this->shared_[sizeClass];
+            auto &local = blocks[sizeClass];
+            shared.insert(shared.end(), local.begin(), local.end());
+            local.clear();
+        }
+    }
+
+private:
+    static inline thread_local LocalCache localCache_{};
+
+    std::mutex mutex_;
+    std::array<FreeList, classCount> shared_;
+    std::atomic<uint64_t> hitCount_;
+    std::atomic<uint64_t> missCount_;
+    std::atomic<uint64_t> outstandingByteCount_;
+};
+
+
+} // end namespace jive
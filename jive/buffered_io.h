@@ -0,0 +1,633 @@
+/**
+  * @file buffered_io.h
+  *
+  * @brief Binary serialization through a contiguous staging buffer.
+  *
+  * io::Write and io::Read make one call to std::ostream::write, or one
+  * std::function call, per value. BufferedWriter and BufferedReader copy
+  * values into and out of a local byte buffer with an inlined bounds check,
+  * and only touch the underlying file descriptor, stream, or function object
+  * when the buffer must be flushed or refilled.
+  *
+  * The byte format matches binary_io.h, so data written by one can be read by
+  * the other.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "jive/binary_io.h"
+#include "jive/buffer.h"
+#include "jive/create_exception.h"
+#include "jive/endian_tools.h"
+#include "jive/error.h"
+#include "jive/optional.h"
+
+
+namespace jive
+{
+
+namespace io
+{
+
+
+CREATE_SYSTEM_ERROR(BufferedIoError, std::system_error);
+
+
+/**
+  * Reads up to byteCount bytes into target.
+  *
+  * @return The count of bytes read, or 0 at the end of the input.
+  */
+using ReadSomeFunction = std::function<size_t (void * const, size_t)>;
+
+
+/**
+  * Advances the source by byteCount bytes, or throws BinaryIoError.
+  */
+using SkipFunction = std::function<void (size_t)>;
+
+
+namespace detail
+{
+
+
+inline size_t ReadDescriptor(
+    int fileDescriptor,
+    void * const target,
+    size_t byteCount)
+{
+    while (true)
+    {
+        auto count = ::read(fileDescriptor, target, byteCount);
+
+        if (count >= 0)
+        {
+            return static_cast<size_t>(count);
+        }
+
+        if (errno != EINTR)
+        {
+            throw BufferedIoError(
+                SystemError(errno),
+                "Failed to read from descriptor");
+        }
+    }
+}
+
+
+} // end namespace detail
+
+
+/**
+  * Advance fileDescriptor by byteCount bytes.
+  *
+  * Files seek in constant time, and throw rather than seek past their end.
+  * Pipes and sockets cannot seek, so their bytes are read and discarded in
+  * large chunks.
+  */
+inline void Skip(int fileDescriptor, size_t byteCount)
+{
+    if (byteCount == 0)
+    {
+        return;
+    }
+
+    auto offset = static_cast<off_t>(byteCount);
+    auto position = ::lseek(fileDescriptor, offset, SEEK_CUR);
+
+    if (position != -1)
+    {
+        // Regular files seek past their end without failing.
+        struct stat status;
+
+        if (::fstat(fileDescriptor, &status) == 0
+            && S_ISREG(status.st_mode)
+            && position > status.st_size)
+        {
+            ::lseek(fileDescriptor, -offset, SEEK_CUR);
+
+            throw BinaryIoError("Skip past end of input");
+        }
+
+        return;
+    }
+
+    if (errno != ESPIPE)
+    {
+        throw BufferedIoError(SystemError(errno), "Failed to seek");
+    }
+
+    auto skipBuffer = detail::GetSkipBuffer();
+
+    while (byteCount > 0)
+    {
+        auto count = detail::ReadDescriptor(
+            fileDescriptor,
+            skipBuffer,
+            std::min(byteCount, detail::skipChunkByteCount));
+
+        if (count == 0)
+        {
+            throw BinaryIoError("Skip past end of input");
+        }
+
+        byteCount -= count;
+    }
+}
+
+
+inline constexpr size_t defaultBufferedByteCount = 64 * 1024;
+
+
+class BufferedWriter
+{
+public:
+    using FlushFunction = std::function<void (const uint8_t *, size_t)>;
+
+    explicit BufferedWriter(
+        std::ostream &outputStream,
+        size_t capacity = defaultBufferedByteCount)
+        :
+        BufferedWriter(
+            [&outputStream](const uint8_t *data, size_t byteCount)
+            {
+                outputStream.write(
+                    reinterpret_cast<const char *>(data),
+                    static_cast<std::streamsize>(byteCount));
+
+                if (!outputStream)
+                {
+                    throw BinaryIoError("Failed to write to stream");
+                }
+            },
+            capacity)
+    {
+
+    }
+
+    /** Flush to a file descriptor. The descriptor is not closed. **/
+    explicit BufferedWriter(
+        int fileDescriptor,
+        size_t capacity = defaultBufferedByteCount)
+        :
+        BufferedWriter(
+            [fileDescriptor](const uint8_t *data, size_t byteCount)
+            {
+                WriteDescriptor_(fileDescriptor, data, byteCount);
+            },
+            capacity)
+    {
+
+    }
+
+    explicit BufferedWriter(
+        const WriteFunction &writeFunction,
+        size_t capacity = defaultBufferedByteCount)
+        :
+        BufferedWriter(
+            [writeFunction](const uint8_t *data, size_t byteCount)
+            {
+                writeFunction(data, 1, byteCount);
+            },
+            capacity)
+    {
+
+    }
+
+    /** Flushes any buffered bytes, discarding errors. **/
+    ~BufferedWriter()
+    {
+        try
+        {
+            this->Flush();
+        }
+        catch (...)
+        {
+            // Call Flush directly to observe errors.
+        }
+    }
+
+    BufferedWriter(const BufferedWriter &) = delete;
+    BufferedWriter & operator=(const BufferedWriter &) = delete;
+
+    /** Append byteCount bytes, flushing first if they do not fit. **/
+    void WriteBytes(const void *source, size_t byteCount)
+    {
+        if (byteCount <= this->capacity_ - this->size_)
+        {
+            std::memcpy(this->buffer_.Get() + this->size_, source, byteCount);
+            this->size_ += byteCount;
+
+            return;
+        }
+
+        this->WriteOverflow_(source, byteCount);
+    }
+
+    /**
+     ** Write arithmetic types, standard layout structs, std::string (with a
+     ** one byte length), and std::optional of those.
+     **/
+    template<typename T>
+    requires (
+        detail::EnableBinaryIo<T>::value
+        || detail::EnableOptionalIo<T>::value)
+    void Write(const T &value)
+    {
+        if constexpr (std::is_same_v<T, std::string>)
+        {
+            if (value.size() > std::numeric_limits<uint8_t>::max())
+            {
+                throw std::length_error(
+                    "String length is limited to 255 characters");
+            }
+
+            this->Write(static_cast<uint8_t>(value.size()));
+            this->WriteBytes(value.data(), value.size());
+        }
+        else if constexpr (IsOptional<T>)
+        {
+            this->Write(static_cast<uint8_t>(value.has_value()));
+
+            if (value)
+            {
+                this->Write(*value);
+            }
+        }
+        else
+        {
+            this->WriteBytes(&value, sizeof(T));
+        }
+    }
+
+    /** Write value in byteOrder. **/
+    template<std::endian byteOrder, Swappable T>
+    void Write(T value)
+    {
+        this->Write(ConvertByteOrder<byteOrder>(value));
+    }
+
+    /** Write the length as CountType, followed by the characters. **/
+    template<typename CountType = uint32_t>
+    void WriteString(std::string_view value)
+    {
+        if (value.size() > std::numeric_limits<CountType>::max())
+        {
+            throw std::length_error(
+                "String length is limited to "
+                + std::to_string(std::numeric_limits<CountType>::max()));
+        }
+
+        this->Write(static_cast<CountType>(value.size()));
+        this->WriteBytes(value.data(), value.size());
+    }
+
+    /** Pass all buffered bytes to the destination. **/
+    void Flush()
+    {
+        if (this->size_ > 0)
+        {
+            // Clear first, so a throwing destination does not see the same
+            // bytes again from the destructor.
+            auto size = this->size_;
+            this->size_ = 0;
+            this->flush_(this->buffer_.Get(), size);
+        }
+    }
+
+    size_t GetBufferedByteCount() const { return this->size_; }
+
+    size_t GetCapacity() const { return this->capacity_; }
+
+private:
+    BufferedWriter(FlushFunction &&flush, size_t capacity)
+        :
+        flush_(std::move(flush)),
+        capacity_(std::max(capacity, size_t{1})),
+        size_(0),
+        buffer_(capacity_)
+    {
+
+    }
+
+    void WriteOverflow_(const void *source, size_t byteCount)
+    {
+        this->Flush();
+
+        if (byteCount >= this->capacity_)
+        {
+            // Too large to stage. Send it directly.
+            this->flush_(static_cast<const uint8_t *>(source), byteCount);
+
+            return;
+        }
+
+        std::memcpy(this->buffer_.Get(), source, byteCount);
+        this->size_ = byteCount;
+    }
+
+    static void WriteDescriptor_(
+        int fileDescriptor,
+        const uint8_t *data,
+        size_t byteCount)
+    {
+        while (byteCount > 0)
+        {
+            auto written = ::write(fileDescriptor, data, byteCount);
+
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                throw BufferedIoError(
+                    SystemError(errno),
+                    "Failed to write to descriptor");
+            }
+
+            data += written;
+            byteCount -= static_cast<size_t>(written);
+        }
+    }
+
+private:
+    FlushFunction flush_;
+    size_t capacity_;
+    size_t size_;
+    Buffer<uint8_t> buffer_;
+};
+
+
+class BufferedReader
+{
+public:
+    explicit BufferedReader(
+        std::istream &inputStream,
+        size_t capacity = defaultBufferedByteCount)
+        :
+        BufferedReader(
+            [&inputStream](void * const target, size_t byteCount) -> size_t
+            {
+                inputStream.read(
+                    static_cast<char *>(target),
+                    static_cast<std::streamsize>(byteCount));
+
+                return static_cast<size_t>(inputStream.gcount());
+            },
+            [&inputStream](size_t byteCount)
+            {
+                io::Skip(inputStream, byteCount);
+            },
+            capacity)
+    {
+
+    }
+
+    /** Read from a file descriptor. The descriptor is not closed. **/
+    explicit BufferedReader(
+        int fileDescriptor,
+        size_t capacity = defaultBufferedByteCount)
+        :
+        BufferedReader(
+            [fileDescriptor](void * const target, size_t byteCount)
+            {
+                return detail::ReadDescriptor(
+                    fileDescriptor,
+                    target,
+                    byteCount);
+            },
+            [fileDescriptor](size_t byteCount)
+            {
+                io::Skip(fileDescriptor, byteCount);
+            },
+            capacity)
+    {
+
+    }
+
+    /** Skip discards bytes through the buffer. **/
+    explicit BufferedReader(
+        ReadSomeFunction readSome,
+        size_t capacity = defaultBufferedByteCount)
+        :
+        BufferedReader(std::move(readSome), SkipFunction{}, capacity)
+    {
+
+    }
+
+    /** Skip passes anything beyond the buffered bytes to skip. **/
+    BufferedReader(
+        ReadSomeFunction readSome,
+        SkipFunction skip,
+        size_t capacity = defaultBufferedByteCount)
+        :
+        readSome_(std::move(readSome)),
+        skip_(std::move(skip)),
+        capacity_(std::max(capacity, size_t{1})),
+        begin_(0),
+        end_(0),
+        buffer_(capacity_)
+    {
+
+    }
+
+    BufferedReader(const BufferedReader &) = delete;
+    BufferedReader & operator=(const BufferedReader &) = delete;
+
+    /** Copy exactly byteCount bytes to target, or throw BinaryIoError. **/
+    void ReadBytes(void *target, size_t byteCount)
+    {
+        if (byteCount <= this->end_ - this->begin_)
+        {
+            std::memcpy(target, this->buffer_.Get() + this->begin_, byteCount);
+            this->begin_ += byteCount;
+
+            return;
+        }
+
+        this->ReadUnderflow_(static_cast<uint8_t *>(target), byteCount);
+    }
+
+    template<typename T>
+    requires (
+        detail::EnableBinaryIo<T>::value
+        || detail::EnableOptionalIo<T>::value)
+    T Read()
+    {
+        if constexpr (std::is_same_v<T, std::string>)
+        {
+            std::string result(this->Read<uint8_t>(), '\0');
+            this->ReadBytes(result.data(), result.size());
+
+            return result;
+        }
+        else if constexpr (IsOptional<T>)
+        {
+            if (this->Read<uint8_t>() == 0)
+            {
+                return {};
+            }
+
+            return this->Read<RemoveOptional<T>>();
+        }
+        else
+        {
+            T value;
+            this->ReadBytes(&value, sizeof(T));
+
+            return value;
+        }
+    }
+
+    /** Read a value stored in byteOrder. **/
+    template<std::endian byteOrder, Swappable T>
+    T Read()
+    {
+        return ConvertByteOrder<byteOrder>(this->Read<T>());
+    }
+
+    /**
+     ** @param maximumCount The count from the input is checked against it
+     ** before the string is allocated.
+     **/
+    template<typename CountType = uint32_t>
+    std::string ReadString(
+        size_t maximumCount = std::numeric_limits<size_t>::max())
+    {
+        auto count = static_cast<size_t>(this->Read<CountType>());
+        detail::CheckMaximumCount(count, maximumCount);
+
+        return detail::MakeString(
+            count,
+            [this](char *data, size_t byteCount)
+            {
+                this->ReadBytes(data, byteCount);
+            });
+    }
+
+    void Skip(size_t byteCount)
+    {
+        if (this->skip_ && byteCount > this->end_ - this->begin_)
+        {
+            byteCount -= this->end_ - this->begin_;
+            this->begin_ = this->end_ = 0;
+            this->skip_(byteCount);
+
+            return;
+        }
+
+        while (byteCount > 0)
+        {
+            if (this->begin_ == this->end_ && !this->Refill_())
+            {
+                throw BinaryIoError("Skip past end of input");
+            }
+
+            auto skipped = std::min(byteCount, this->end_ - this->begin_);
+            this->begin_ += skipped;
+            byteCount -= skipped;
+        }
+    }
+
+    /** @return true when no bytes remain in the buffer or the source. **/
+    bool IsEnd()
+    {
+        return this->begin_ == this->end_ && !this->Refill_();
+    }
+
+    size_t GetBufferedByteCount() const { return this->end_ - this->begin_; }
+
+    size_t GetCapacity() const { return this->capacity_; }
+
+private:
+    void ReadUnderflow_(uint8_t *target, size_t byteCount)
+    {
+        auto buffered = this->end_ - this->begin_;
+        std::memcpy(target, this->buffer_.Get() + this->begin_, buffered);
+        this->begin_ = this->end_ = 0;
+        target += buffered;
+        byteCount -= buffered;
+
+        if (byteCount >= this->capacity_)
+        {
+            // Too large to stage. Read it directly.
+            while (byteCount > 0)
+            {
+                auto count = this->readSome_(target, byteCount);
+
+                if (count == 0)
+                {
+                    throw BinaryIoError("Read past end of input");
+                }
+
+                target += count;
+                byteCount -= count;
+            }
+
+            return;
+        }
+
+        while (this->end_ < byteCount)
+        {
+            if (!this->Refill_())
+            {
+                throw BinaryIoError("Read past end of input");
+            }
+        }
+
+        std::memcpy(target, this->buffer_.Get(), byteCount);
+        this->begin_ = byteCount;
+    }
+
+    /** Append to the buffer from the source. @return false at the end. **/
+    bool Refill_()
+    {
+        if (this->begin_ == this->end_)
+        {
+            this->begin_ = this->end_ = 0;
+        }
+
+        auto count = this->readSome_(
+            this->buffer_.Get() + this->end_,
+            this->capacity_ - this->end_);
+
+        this->end_ += count;
+
+        return count > 0;
+    }
+
+private:
+    ReadSomeFunction readSome_;
+    SkipFunction skip_;
+    size_t capacity_;
+    size_t begin_;
+    size_t end_;
+    Buffer<uint8_t> buffer_;
+};
+
+
+} // end namespace io
+
+} // end namespace jive
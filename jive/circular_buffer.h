@@ -6,12 +6,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cassert>
 #include <cstdint>
 #include <type_traits>
 #include <ostream>
 #include <iomanip>
 #include <cstring>
+#include <span>
 #include "jive/circular_index.h"
+#include "jive/buffer.h"
 
 #undef min
 #undef max
@@ -40,6 +45,47 @@ namespace detail
             return static_cast<uint16_t>(value);
         }
     }
+
+
+    /** Fixed capacity, stored inline. **/
+    template<typename T, size_t N, size_t align>
+    class CircularStorage
+    {
+    public:
+        static constexpr size_t GetCapacity() { return N; }
+
+        T * Get() { return this->elements_; }
+
+        const T * Get() const { return this->elements_; }
+
+    private:
+        alignas(align) T elements_[N];
+    };
+
+
+    /** Capacity chosen at runtime, allocated through jive::Buffer. **/
+    template<typename T, size_t align>
+    class CircularStorage<T, 0, align>
+    {
+    public:
+        explicit CircularStorage(size_t capacity)
+            :
+            buffer_(capacity)
+        {
+
+        }
+
+        size_t GetCapacity() const { return this->buffer_.GetElementCount(); }
+
+        T * Get() { return this->buffer_.Get(); }
+
+        const T * Get() const { return this->buffer_.Get(); }
+
+    private:
+        Buffer<T, align> buffer_;
+    };
+
+
 } // end namespace detail
 
 
@@ -69,37 +115,68 @@ std::ostream & operator<<(
 }
 
 
-template<typename T, size_t N>
+/**
+ ** @tparam N The capacity, fixed at compile time. When N is 0, the capacity is
+ ** passed to the constructor and the elements are allocated on the heap.
+ **
+ ** @tparam align Alignment of the element storage. Runtime-sized buffers
+ ** default to cache line alignment, and accept hugePageSize for very large
+ ** buffers.
+ **/
+template<
+    typename T,
+    size_t N,
+    size_t align = (N == 0) ? cacheLineSize : alignof(T)>
 class CircularBuffer
 {
 public:
-    CircularBuffer()
+    CircularBuffer() requires (N != 0)
         :
+        storage_(),
         writeIndex_(),
-        readIndex_()
+        readIndex_(),
+        size_(0)
+    {
+
+    }
+
+    explicit CircularBuffer(size_t capacity) requires (N == 0)
+        :
+        storage_(capacity),
+        writeIndex_(CircularIndex<N>::Create(capacity)),
+        readIndex_(CircularIndex<N>::Create(capacity)),
+        size_(0)
     {
 
     }
 
+    size_t GetCapacity() const
+    {
+        return this->storage_.GetCapacity();
+    }
+
     void Reset()
     {
         this->writeIndex_.Reset();
         this->readIndex_.Reset();
+        this->size_ = 0;
     }
 
-    bool IsEmpty()
+    bool IsEmpty() const
     {
-        return (this->readIndex_ == this->writeIndex_);
+        return this->size_ == 0;
     }
 
+    // The indices alone cannot distinguish a full buffer from an empty one,
+    // so the size is tracked separately.
     size_t GetSize() const
     {
-        return this->writeIndex_ - this->readIndex_;
+        return this->size_;
     }
 
     size_t GetAvailable() const
     {
-        return N - this->GetSize();
+        return this->GetCapacity() - this->GetSize();
     }
 
     T FrontElement()
@@ -109,7 +186,7 @@ public:
             throw std::out_of_range("Buffer is empty");
         }
 
-        return this->elements_[static_cast<size_t>(this->readIndex_)];
+        return this->GetElements_()[static_cast<size_t>(this->readIndex_)];
     }
 
     T BackElement()
@@ -119,24 +196,24 @@ public:
             throw std::out_of_range("Buffer is empty");
         }
 
-        return this->elements_[this->writeIndex_ - CircularIndex<N>(1)];
+        return this->GetElements_()[this->writeIndex_ - this->MakeIndex_(1)];
     }
 
     std::ostream & PrintElements(std::ostream &outputStream)
     {
         auto index = this->readIndex_;
-        auto endIndex = this->writeIndex_;
-        
-        while (index != endIndex)
+
+        for (size_t count = 0; count < this->size_; ++count)
         {
             if constexpr (std::is_integral_v<T> && sizeof(T) == 1)
             {
                 outputStream << PromoteByte(
-                    this->elements_[static_cast<size_t>(index)]) << " ";
+                    this->GetElements_()[static_cast<size_t>(index)]) << " ";
             }
             else
             {
-                outputStream << this->elements_[static_cast<size_t>(index)] << " ";
+                outputStream
+                    << this->GetElements_()[static_cast<size_t>(index)] << " ";
             }
 
             ++index;
@@ -147,18 +224,18 @@ public:
 
     std::ostream & PrintContents(std::ostream &outputStream)
     {
-        auto index = 0;
-        auto endIndex = N;
+        size_t index = 0;
+        auto endIndex = this->GetCapacity();
         
         while (index != endIndex)
         {
             if constexpr (std::is_integral_v<T> && sizeof(T) == 1)
             {
-                outputStream << PromoteByte(this->elements_[index]) << " ";
+                outputStream << PromoteByte(this->GetElements_()[index]) << " ";
             }
             else
             {
-                outputStream << this->elements_[index] << " ";
+                outputStream << this->GetElements_()[index] << " ";
             }
 
             ++index;
@@ -178,11 +255,11 @@ public:
         // space, we do not need to consider the position of the readIndex_ in
         // this check. If the readIndex_ is after the write index, then count
         // places us before the readIndex_.
-        auto countToEnd = N - this->writeIndex_;
+        auto countToEnd = this->GetCapacity() - this->writeIndex_;
         auto tailCount = std::min(count, countToEnd);
 
         std::memcpy(
-            &this->elements_[static_cast<size_t>(this->writeIndex_)],
+            &this->GetElements_()[static_cast<size_t>(this->writeIndex_)],
             source,
             sizeof(T) * tailCount);
 
@@ -192,16 +269,78 @@ public:
             auto remainder = count - tailCount;
 
             std::memcpy(
-                &this->elements_[0],
+                &this->GetElements_()[0],
                 source + tailCount,
                 sizeof(T) * remainder);
         }
         
-        this->writeIndex_ += CircularIndex<N>(count);
+        this->writeIndex_ += this->MakeIndex_(count);
+        this->size_ += count;
 
         return true;
     }
 
+    /**
+     ** Write count elements, discarding the oldest elements to make room.
+     **
+     ** Use this to keep a history of the most recent values. When count
+     ** exceeds the capacity, only the newest elements of source are kept.
+     **/
+    void Overwrite(const T *source, size_t count)
+    {
+        auto capacity = this->GetCapacity();
+
+        if (count > capacity)
+        {
+            source += count - capacity;
+            count = capacity;
+        }
+
+        auto available = this->GetAvailable();
+
+        if (count > available)
+        {
+            this->Remove(count - available);
+        }
+
+        [[maybe_unused]] bool success = this->Write(source, count);
+        assert(success);
+    }
+
+    /**
+     ** Copy the newest elements into target, oldest first, without consuming
+     ** them.
+     **
+     ** @return The count of elements copied, which is the lesser of
+     ** target.size() and GetSize().
+     **/
+    size_t Snapshot(std::span<T> target) const
+    {
+        auto count = std::min(target.size(), this->size_);
+        auto capacity = this->GetCapacity();
+
+        auto first =
+            (static_cast<size_t>(this->writeIndex_) + capacity - count)
+            % capacity;
+
+        auto tailCount = std::min(count, capacity - first);
+
+        std::memcpy(
+            target.data(),
+            &this->GetElements_()[first],
+            sizeof(T) * tailCount);
+
+        if (count > tailCount)
+        {
+            std::memcpy(
+                target.data() + tailCount,
+                &this->GetElements_()[0],
+                sizeof(T) * (count - tailCount));
+        }
+
+        return count;
+    }
+
     bool Peek(T * target, size_t count)
     {
         if (count > this->GetSize())
@@ -209,12 +348,12 @@ public:
             return false;
         }
 
-        auto countToEnd = N - this->readIndex_;
+        auto countToEnd = this->GetCapacity() - this->readIndex_;
         auto tailCount = std::min(count, countToEnd);
 
         std::memcpy(
             target,
-            &this->elements_[static_cast<size_t>(this->readIndex_)],
+            &this->GetElements_()[static_cast<size_t>(this->readIndex_)],
             sizeof(T) * tailCount);
 
         if (count > tailCount)
@@ -224,7 +363,7 @@ public:
 
             std::memcpy(
                 target + tailCount,
-                &this->elements_[0],
+                &this->GetElements_()[0],
                 sizeof(T) * remainder);
         }
 
@@ -237,13 +376,59 @@ public:
         {
             // The Peek copied to target.
             // Increment the readIndex_ to consume the data.
-            this->readIndex_ += CircularIndex<N>(count);
+            this->readIndex_ += this->MakeIndex_(count);
+            this->size_ -= count;
             return true;
         }
 
         return false;
     }
 
+    /**
+     ** @return The free space, in the order it is filled: from the write
+     ** index toward the end of the storage, then from the start of the
+     ** storage. The second region is empty unless the free space wraps.
+     **
+     ** After filling a prefix of the regions (for example, with readv), call
+     ** CommitWrite with the count of elements written.
+     **/
+    std::array<std::span<T>, 2> GetWritableRegions()
+    {
+        auto writeIndex = static_cast<size_t>(this->writeIndex_);
+        auto available = this->GetAvailable();
+        auto firstCount = std::min(available, this->GetCapacity() - writeIndex);
+
+        return {
+            std::span<T>(this->GetElements_() + writeIndex, firstCount),
+            std::span<T>(this->GetElements_(), available - firstCount)};
+    }
+
+    void CommitWrite(size_t count)
+    {
+        assert(count <= this->GetAvailable());
+
+        this->writeIndex_ += this->MakeIndex_(count);
+        this->size_ += count;
+    }
+
+    /**
+     ** @return The stored elements, oldest first, as at most two regions.
+     ** After consuming a prefix of them (for example, with writev), call
+     ** Remove with the count of elements consumed.
+     **/
+    std::array<std::span<const T>, 2> GetReadableRegions() const
+    {
+        auto readIndex = static_cast<size_t>(this->readIndex_);
+        auto elements = this->GetElements_();
+
+        auto firstCount =
+            std::min(this->size_, this->GetCapacity() - readIndex);
+
+        return {
+            std::span<const T>(elements + readIndex, firstCount),
+            std::span<const T>(elements, this->size_ - firstCount)};
+    }
+
     size_t GetWriteIndex() const
     {
         return static_cast<size_t>(this->writeIndex_);
@@ -256,37 +441,68 @@ public:
  
     void Remove(size_t count)
     {
+        assert(count <= this->size_);
+
         // Increment the readIndex_ to consume the data.
-        this->readIndex_ += CircularIndex<N>(count);
+        this->readIndex_ += this->MakeIndex_(count);
+        this->size_ -= count;
     }
 
-    template<typename, size_t>
+    template<typename, size_t, size_t>
     friend class AsPointer;
 
 private:
+    CircularIndex<N> MakeIndex_(size_t index) const
+    {
+        if constexpr (N == 0)
+        {
+            return CircularIndex<N>(this->GetCapacity(), index);
+        }
+        else
+        {
+            return CircularIndex<N>(index);
+        }
+    }
+
+    T * GetElements_()
+    {
+        return this->storage_.Get();
+    }
+
+    const T * GetElements_() const
+    {
+        return this->storage_.Get();
+    }
+
     /**
      ** @return The count of bytes that can be written without overwriting
      ** either the end of the buffer or the read index.
      **/
     size_t GetWritableSize() const
     {
-        auto countToEnd = N - static_cast<size_t>(this->writeIndex_);
+        auto countToEnd =
+            this->GetCapacity() - static_cast<size_t>(this->writeIndex_);
 
         return std::min(this->GetAvailable(), countToEnd);
     }
 
 private:
+    detail::CircularStorage<T, N, align> storage_;
     CircularIndex<N> writeIndex_;
     CircularIndex<N> readIndex_;
-    T elements_[N];
+    size_t size_;
 };
 
 
-template<typename T, size_t N>
+template<typename T, size_t align = cacheLineSize>
+using DynamicCircularBuffer = CircularBuffer<T, 0, align>;
+
+
+template<typename T, size_t N, size_t align>
 class AsPointer
 {
 public:
-    AsPointer(CircularBuffer<T, N> &targetBuffer)
+    AsPointer(CircularBuffer<T, N, align> &targetBuffer)
         :
         targetBuffer_(targetBuffer),
         writeCount_(0)
@@ -301,27 +517,30 @@ public:
 
     T * Get()
     {
-        return &this->targetBuffer_.elements_[
+        return &this->targetBuffer_.GetElements_()[
             static_cast<size_t>(this->targetBuffer_.writeIndex_)];
     }
 
     void SetWriteCount(size_t count)
     {
         assert(count <= this->GetWritableSize());
-        this->writeCount_ = CircularIndex<N>(count);
+        this->writeCount_ = count;
     }
 
     ~AsPointer()
     {
         if (this->writeCount_ > 0)
         {
-            this->targetBuffer_.writeIndex_ += this->writeCount_;
+            this->targetBuffer_.writeIndex_ +=
+                this->targetBuffer_.MakeIndex_(this->writeCount_);
+
+            this->targetBuffer_.size_ += this->writeCount_;
         }
     }
 
 private:
-    CircularBuffer<T, N> &targetBuffer_;
-    CircularIndex<N> writeCount_;
+    CircularBuffer<T, N, align> &targetBuffer_;
+    size_t writeCount_;
 };
 
 
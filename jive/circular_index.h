@@ -89,8 +89,11 @@ public:
 
     }
 
+    // A runtime wrapCount belongs to the index, so that an assigned buffer
+    // wraps at its new capacity.
     CircularIndex & operator=(const CircularIndex &other)
     {
+        this->wrapCount_ = other.wrapCount_;
         this->index_ = other.index_;
         return *this;
     }
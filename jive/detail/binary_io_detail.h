@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <ranges>
 #include <type_traits>
 #include <jive/optional.h>
+#include <jive/buffer.h>
 
 namespace jive
 {
@@ -61,6 +63,57 @@ struct EnableOptionalIo
     > {};
 
 
+/*
+ * Enabler for WriteArray/ReadArray.
+ *
+ * Contiguous, sized ranges (std::span, std::vector, std::array, C arrays) and
+ * Buffer-like classes, holding trivially copyable elements.
+ */
+template<typename T>
+concept ContiguousRange =
+    std::ranges::contiguous_range<T>
+    && std::ranges::sized_range<T>
+    && std::is_trivially_copyable_v<std::ranges::range_value_t<T>>;
+
+
+template<typename T>
+concept ArrayIo = ContiguousRange<T> || ::jive::ReadableBuffer<T>;
+
+
+template<ArrayIo Values>
+auto GetArrayData(Values &values)
+{
+    if constexpr (ContiguousRange<Values>)
+    {
+        return std::ranges::data(values);
+    }
+    else
+    {
+        return values.Get();
+    }
+}
+
+
+template<ArrayIo Values>
+size_t GetArrayCount(const Values &values)
+{
+    if constexpr (ContiguousRange<Values>)
+    {
+        return static_cast<size_t>(std::ranges::size(values));
+    }
+    else
+    {
+        return values.GetElementCount();
+    }
+}
+
+
+template<ArrayIo Values>
+using ArrayElement =
+    std::remove_cv_t<std::remove_pointer_t<decltype(
+        GetArrayData(std::declval<Values &>()))>>;
+
+
 } // end namespace detail
 
 } // end namespace io
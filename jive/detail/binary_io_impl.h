@@ -39,10 +39,15 @@ inline std::string Read<std::string>(std::istream &inputStream)
         throw BinaryIoError("Failed to extract string.");
     }
 
-    size_t resultLength = static_cast<size_t>(stringLength);
-    char buffer[256]{};
-    inputStream.read(&buffer[0], stringLength);
-    return std::string(&buffer[0], resultLength);
+    std::string result(static_cast<size_t>(stringLength), '\0');
+    inputStream.read(result.data(), stringLength);
+
+    if (inputStream.gcount() != stringLength)
+    {
+        throw BinaryIoError("Failed to extract string.");
+    }
+
+    return result;
 }
 
 
@@ -91,7 +96,7 @@ inline void Write<std::string>(
 
     if (valueSize > maximumSize)
     {
-        throw std::length_error("String length is limited to 256 characters");
+        throw std::length_error("String length is limited to 255 characters");
     }
 
     uint8_t stringSize = static_cast<uint8_t>(valueSize);
@@ -140,9 +145,9 @@ inline std::string Read<std::string>(const ReadFunction &readFunction)
 {
     uint8_t stringSize;
     readFunction(&stringSize, 1, 1);
-    char buffer[256]{};
-    readFunction(&buffer[0], 1, stringSize);
-    return std::string(&buffer[0], stringSize);
+    std::string result(stringSize, '\0');
+    readFunction(result.data(), 1, stringSize);
+    return result;
 }
 
 template<>
@@ -164,48 +169,279 @@ inline void Write<std::string>(
 }
 
 
-/*
- * @brief Advance the readFunction
- *
- * @param readFunction The function object backed by a file, pipe, or stream
- * @param byteCount The number of bytes to skip.
- * @remark Thread-safe because dummyBytes is never read.
- *
- */
+template<std::endian byteOrder, Swappable T>
+T Read(std::istream &inputStream)
+{
+    return ConvertByteOrder<byteOrder>(Read<T>(inputStream));
+}
+
+
+template<std::endian byteOrder, Swappable T>
+T Read(const ReadFunction &readFunction)
+{
+    return ConvertByteOrder<byteOrder>(Read<T>(readFunction));
+}
+
+
+template<std::endian byteOrder, Swappable T>
+void Write(std::ostream &outputStream, T value)
+{
+    Write(outputStream, ConvertByteOrder<byteOrder>(value));
+}
+
+
+template<std::endian byteOrder, Swappable T>
+void Write(const WriteFunction &writeFunction, T value)
+{
+    Write(writeFunction, ConvertByteOrder<byteOrder>(value));
+}
+
+
+namespace detail
+{
+
+
+// The largest count of bytes discarded by one read while skipping.
+inline constexpr size_t skipChunkByteCount = 64 * 1024;
+
+
+inline uint8_t * GetSkipBuffer()
+{
+    static thread_local std::vector<uint8_t> skipBuffer(skipChunkByteCount);
+
+    return skipBuffer.data();
+}
+
+
+// Counts read from the input are checked against a seekable stream's size
+// only above this, because seeking to the end may discard its buffer.
+inline constexpr size_t checkedReadByteCount = 64 * 1024;
+
+
+/** @return The bytes left in inputStream, or nothing when it cannot seek. **/
+inline std::optional<size_t> GetRemainingByteCount(std::istream &inputStream)
+{
+    auto position = inputStream.tellg();
+
+    if (position == std::istream::pos_type(-1))
+    {
+        return {};
+    }
+
+    inputStream.seekg(0, std::istream::end);
+    auto end = inputStream.tellg();
+    inputStream.seekg(position);
+
+    if (end == std::istream::pos_type(-1) || end < position)
+    {
+        inputStream.clear();
+
+        return {};
+    }
+
+    return static_cast<size_t>(end - position);
+}
+
+
+/** @return count * elementSize, or the largest size_t if that overflows. **/
+inline size_t GetByteCount(size_t count, size_t elementSize)
+{
+    if (count > std::numeric_limits<size_t>::max() / elementSize)
+    {
+        return std::numeric_limits<size_t>::max();
+    }
+
+    return count * elementSize;
+}
+
+
+/**
+ ** Throw when a count from the input claims more bytes than inputStream
+ ** holds, so that a corrupt count fails before it is allocated.
+ **/
+inline void CheckStreamHolds(std::istream &inputStream, size_t byteCount)
+{
+    if (byteCount <= checkedReadByteCount)
+    {
+        return;
+    }
+
+    auto remaining = GetRemainingByteCount(inputStream);
+
+    if (remaining && byteCount > *remaining)
+    {
+        throw BinaryIoError("Count exceeds the size of the stream");
+    }
+}
+
+
+inline void CheckMaximumCount(size_t count, size_t maximumCount)
+{
+    if (count > maximumCount)
+    {
+        throw BinaryIoError(
+            "Count of " + std::to_string(count) + " exceeds the maximum of "
+            + std::to_string(maximumCount));
+    }
+}
+
+
+} // end namespace detail
+
+
 inline void Skip(const ReadFunction &readFunction, size_t byteCount)
 {
-    static uint8_t dummyBytes[256];
+    auto skipBuffer = detail::GetSkipBuffer();
+
     while (byteCount > 0)
     {
-        // Limit each loop count to available dummyBytes
-        size_t loopCount = byteCount < 256 ? byteCount : 256;
-        readFunction(&dummyBytes, 1, loopCount);
+        size_t loopCount = std::min(byteCount, detail::skipChunkByteCount);
+        readFunction(skipBuffer, 1, loopCount);
         byteCount -= loopCount;
     }
 }
 
 
+inline void Skip(std::istream &inputStream, size_t byteCount)
+{
+    if (byteCount == 0)
+    {
+        return;
+    }
+
+    // Some streams seek past their end without failing, so seek to the last
+    // skipped byte and read it, which fails at the end. The read fills the
+    // buffer that the next read would, so a skip still costs one seek.
+    inputStream.seekg(
+        static_cast<std::streamoff>(byteCount - 1),
+        std::istream::cur);
+
+    if (inputStream)
+    {
+        inputStream.ignore(1);
+
+        if (inputStream.gcount() != 1)
+        {
+            throw BinaryIoError("Skip past end of stream");
+        }
+
+        return;
+    }
+
+    // A failed seek leaves the position unchanged.
+    inputStream.clear();
+
+    while (byteCount > 0)
+    {
+        auto loopCount = static_cast<std::streamsize>(
+            std::min(byteCount, detail::skipChunkByteCount));
+
+        inputStream.ignore(loopCount);
+
+        if (inputStream.gcount() != loopCount)
+        {
+            throw BinaryIoError("Skip past end of stream");
+        }
+
+        byteCount -= static_cast<size_t>(loopCount);
+    }
+}
+
+
+namespace detail
+{
+
+
 template<typename CountType>
-void WriteString(
-    std::ostream &outputStream,
-    const std::string_view &longString)
+void CheckStringLength(size_t charCount)
 {
+    static_assert(std::is_unsigned_v<CountType>);
+
     static constexpr auto maxCharCount =
         std::numeric_limits<CountType>::max();
 
-    size_t charCount = longString.size();
-
     if (charCount > maxCharCount)
     {
         throw std::length_error(
             "String length is limited to " + std::to_string(maxCharCount));
     }
+}
+
+
+/**
+ ** @return A string of charCount characters, filled by
+ ** read(char *, charCount).
+ **/
+template<typename ReadCharacters>
+std::string MakeString(size_t charCount, ReadCharacters &&read)
+{
+    std::string result;
+
+#if defined(__cpp_lib_string_resize_and_overwrite)
+    // The operation must not throw, so a failed read is rethrown after it
+    // returns.
+    std::exception_ptr error;
+
+    result.resize_and_overwrite(
+        charCount,
+        [&read, &error](char *data, size_t count) noexcept -> size_t
+        {
+            try
+            {
+                read(data, count);
+
+                return count;
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+
+                return 0;
+            }
+        });
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+#else
+    result.resize(charCount);
+    read(result.data(), charCount);
+#endif
+
+    return result;
+}
+
+
+} // end namespace detail
+
+
+template<typename CountType>
+void WriteString(
+    std::ostream &outputStream,
+    const std::string_view &longString)
+{
+    size_t charCount = longString.size();
+    detail::CheckStringLength<CountType>(charCount);
 
     Write(outputStream, static_cast<CountType>(charCount));
 
     outputStream.write(
         longString.data(),
-        static_cast<signed>(charCount));
+        static_cast<std::streamsize>(charCount));
+}
+
+
+template<typename CountType>
+void WriteString(
+    const WriteFunction &writeFunction,
+    const std::string_view &longString)
+{
+    size_t charCount = longString.size();
+    detail::CheckStringLength<CountType>(charCount);
+
+    Write(writeFunction, static_cast<CountType>(charCount));
+    writeFunction(longString.data(), 1, charCount);
 }
 
 
@@ -219,9 +455,318 @@ std::string ReadString(std::istream &inputStream)
         throw BinaryIoError("Failed to extract charCount");
     }
 
-    std::string result;
-    result.resize(charCount);
-    inputStream.read(&result[0], static_cast<std::streamsize>(charCount));
+    detail::CheckStreamHolds(inputStream, static_cast<size_t>(charCount));
+
+    return detail::MakeString(
+        static_cast<size_t>(charCount),
+        [&inputStream](char *data, size_t count)
+        {
+            auto byteCount = static_cast<std::streamsize>(count);
+            inputStream.read(data, byteCount);
+
+            if (inputStream.gcount() != byteCount)
+            {
+                throw BinaryIoError("Failed to extract string");
+            }
+        });
+}
+
+
+template<typename CountType>
+std::string ReadString(const ReadFunction &readFunction)
+{
+    auto charCount = static_cast<size_t>(Read<CountType>(readFunction));
+
+    return detail::MakeString(
+        charCount,
+        [&readFunction](char *data, size_t count)
+        {
+            readFunction(data, 1, count);
+        });
+}
+
+
+namespace detail
+{
+
+
+template<typename CountType>
+void CheckArrayCount(size_t count)
+{
+    static constexpr auto maximumCount = std::numeric_limits<CountType>::max();
+
+    if (count > maximumCount)
+    {
+        throw std::length_error(
+            "Array length is limited to " + std::to_string(maximumCount));
+    }
+}
+
+
+} // end namespace detail
+
+
+template<typename CountType, detail::ArrayIo Values>
+void WriteArray(std::ostream &outputStream, const Values &values)
+{
+    using T = detail::ArrayElement<Values>;
+    auto count = detail::GetArrayCount(values);
+
+    if constexpr (!std::is_void_v<CountType>)
+    {
+        detail::CheckArrayCount<CountType>(count);
+        Write(outputStream, static_cast<CountType>(count));
+    }
+
+    outputStream.write(
+        reinterpret_cast<const char *>(detail::GetArrayData(values)),
+        static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+
+template<typename CountType, detail::ArrayIo Values>
+void WriteArray(const WriteFunction &writeFunction, const Values &values)
+{
+    using T = detail::ArrayElement<Values>;
+    auto count = detail::GetArrayCount(values);
+
+    if constexpr (!std::is_void_v<CountType>)
+    {
+        detail::CheckArrayCount<CountType>(count);
+        Write(writeFunction, static_cast<CountType>(count));
+    }
+
+    writeFunction(detail::GetArrayData(values), sizeof(T), count);
+}
+
+
+template<typename Values>
+requires detail::ArrayIo<std::remove_cvref_t<Values>>
+void ReadArray(std::istream &inputStream, Values &&values)
+{
+    using T = detail::ArrayElement<std::remove_cvref_t<Values>>;
+    auto byteCount =
+        static_cast<std::streamsize>(detail::GetArrayCount(values) * sizeof(T));
+
+    inputStream.read(
+        reinterpret_cast<char *>(detail::GetArrayData(values)),
+        byteCount);
+
+    if (inputStream.gcount() != byteCount)
+    {
+        throw BinaryIoError("Failed to extract array");
+    }
+}
+
+
+template<typename Values>
+requires detail::ArrayIo<std::remove_cvref_t<Values>>
+void ReadArray(const ReadFunction &readFunction, Values &&values)
+{
+    using T = detail::ArrayElement<std::remove_cvref_t<Values>>;
+
+    readFunction(
+        detail::GetArrayData(values),
+        sizeof(T),
+        detail::GetArrayCount(values));
+}
+
+
+template<typename T, typename CountType, typename Result>
+Result ReadArray(std::istream &inputStream, size_t maximumCount)
+{
+    CountType countValue = Read<CountType>(inputStream);
+
+    if (inputStream.gcount() != sizeof(CountType))
+    {
+        throw BinaryIoError("Failed to extract array count");
+    }
+
+    auto count = static_cast<size_t>(countValue);
+    detail::CheckMaximumCount(count, maximumCount);
+
+    detail::CheckStreamHolds(
+        inputStream,
+        detail::GetByteCount(count, sizeof(T)));
+
+    Result result(count);
+    ReadArray(inputStream, result);
+
+    return result;
+}
+
+
+template<typename T, typename CountType, typename Result>
+Result ReadArray(const ReadFunction &readFunction, size_t maximumCount)
+{
+    auto count = static_cast<size_t>(Read<CountType>(readFunction));
+    detail::CheckMaximumCount(count, maximumCount);
+
+    Result result(count);
+    ReadArray(readFunction, result);
+
+    return result;
+}
+
+
+namespace detail
+{
+
+
+// Bytes converted per call to the stream or function object.
+inline constexpr size_t swapBlockByteCount = 4096;
+
+
+/**
+ ** Convert values to byteOrder a block at a time, passing each converted
+ ** block to write(const T *, count).
+ **/
+template<std::endian byteOrder, typename T, typename Write>
+void WriteSwapped(const T *values, size_t count, Write &&write)
+{
+    if constexpr (byteOrder == std::endian::native)
+    {
+        write(values, count);
+    }
+    else
+    {
+        static constexpr size_t blockCount = swapBlockByteCount / sizeof(T);
+        alignas(32) T block[blockCount];
+
+        while (count > 0)
+        {
+            auto chunk = std::min(count, blockCount);
+            SwapBytes(values, &block[0], chunk);
+            write(&block[0], chunk);
+            values += chunk;
+            count -= chunk;
+        }
+    }
+}
+
+
+} // end namespace detail
+
+
+template<std::endian byteOrder, typename CountType, detail::ArrayIo Values>
+requires Swappable<detail::ArrayElement<Values>>
+void WriteArray(std::ostream &outputStream, const Values &values)
+{
+    using T = detail::ArrayElement<Values>;
+    auto count = detail::GetArrayCount(values);
+
+    if constexpr (!std::is_void_v<CountType>)
+    {
+        detail::CheckArrayCount<CountType>(count);
+        Write<byteOrder>(outputStream, static_cast<CountType>(count));
+    }
+
+    detail::WriteSwapped<byteOrder>(
+        detail::GetArrayData(values),
+        count,
+        [&outputStream](const T *data, size_t chunk)
+        {
+            outputStream.write(
+                reinterpret_cast<const char *>(data),
+                static_cast<std::streamsize>(chunk * sizeof(T)));
+        });
+}
+
+
+template<std::endian byteOrder, typename CountType, detail::ArrayIo Values>
+requires Swappable<detail::ArrayElement<Values>>
+void WriteArray(const WriteFunction &writeFunction, const Values &values)
+{
+    using T = detail::ArrayElement<Values>;
+    auto count = detail::GetArrayCount(values);
+
+    if constexpr (!std::is_void_v<CountType>)
+    {
+        detail::CheckArrayCount<CountType>(count);
+        Write<byteOrder>(writeFunction, static_cast<CountType>(count));
+    }
+
+    detail::WriteSwapped<byteOrder>(
+        detail::GetArrayData(values),
+        count,
+        [&writeFunction](const T *data, size_t chunk)
+        {
+            writeFunction(data, sizeof(T), chunk);
+        });
+}
+
+
+template<std::endian byteOrder, typename Values>
+requires (
+    detail::ArrayIo<std::remove_cvref_t<Values>>
+    && Swappable<detail::ArrayElement<std::remove_cvref_t<Values>>>)
+void ReadArray(std::istream &inputStream, Values &&values)
+{
+    ReadArray(inputStream, values);
+
+    ConvertByteOrder<byteOrder>(
+        detail::GetArrayData(values),
+        detail::GetArrayCount(values));
+}
+
+
+template<std::endian byteOrder, typename Values>
+requires (
+    detail::ArrayIo<std::remove_cvref_t<Values>>
+    && Swappable<detail::ArrayElement<std::remove_cvref_t<Values>>>)
+void ReadArray(const ReadFunction &readFunction, Values &&values)
+{
+    ReadArray(readFunction, values);
+
+    ConvertByteOrder<byteOrder>(
+        detail::GetArrayData(values),
+        detail::GetArrayCount(values));
+}
+
+
+template<
+    std::endian byteOrder,
+    Swappable T,
+    typename CountType,
+    typename Result>
+Result ReadArray(std::istream &inputStream, size_t maximumCount)
+{
+    CountType countValue = Read<byteOrder, CountType>(inputStream);
+
+    if (inputStream.gcount() != sizeof(CountType))
+    {
+        throw BinaryIoError("Failed to extract array count");
+    }
+
+    auto count = static_cast<size_t>(countValue);
+    detail::CheckMaximumCount(count, maximumCount);
+
+    detail::CheckStreamHolds(
+        inputStream,
+        detail::GetByteCount(count, sizeof(T)));
+
+    Result result(count);
+    ReadArray<byteOrder>(inputStream, result);
+
+    return result;
+}
+
+
+template<
+    std::endian byteOrder,
+    Swappable T,
+    typename CountType,
+    typename Result>
+Result ReadArray(const ReadFunction &readFunction, size_t maximumCount)
+{
+    auto count =
+        static_cast<size_t>(Read<byteOrder, CountType>(readFunction));
+
+    detail::CheckMaximumCount(count, maximumCount);
+
+    Result result(count);
+    ReadArray<byteOrder>(readFunction, result);
+
     return result;
 }
 
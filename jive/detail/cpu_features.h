@@ -0,0 +1,62 @@
+/**
+  * @file cpu_features.h
+  *
+  * @brief Runtime checks for the x86 instruction sets that jive uses.
+  *
+  * Kernels marked JIVE_TARGET("avx2") or JIVE_TARGET("ssse3") compile in
+  * any x86 build, without -mavx2 or -mssse3, and callers select them with
+  * HasAvx2 or HasSsse3. When the compiler already targets an instruction
+  * set, its check is a constant.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#if (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__GNUC__) || defined(__clang__))
+
+#define JIVE_X86_DISPATCH 1
+#define JIVE_TARGET(instructionSet) __attribute__((target(instructionSet)))
+
+#include <immintrin.h>
+
+#endif
+
+
+namespace jive
+{
+
+namespace detail
+{
+
+#ifdef JIVE_X86_DISPATCH
+
+inline bool HasSsse3()
+{
+#if defined(__SSSE3__)
+    return true;
+#else
+    static const bool hasSsse3 = __builtin_cpu_supports("ssse3");
+    return hasSsse3;
+#endif
+}
+
+
+inline bool HasAvx2()
+{
+#if defined(__AVX2__)
+    return true;
+#else
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2;
+#endif
+}
+
+#endif // JIVE_X86_DISPATCH
+
+} // end namespace detail
+
+} // end namespace jive
@@ -3,6 +3,10 @@
   *
   * @brief Templated functions for simple endian conversions.
   *
+  * SwapBytes reverses the byte order of whole arrays. On x86, it uses AVX2
+  * or SSSE3 byte shuffles when the processor supports them, chosen at run
+  * time, and falls back to scalar byte swaps otherwise.
+  *
   * @author Jive Helix (jivehelix@gmail.com)
   * @date 14 Nov 2017
   * @copyright Jive Helix
@@ -10,10 +14,15 @@
   */
 
 #pragma once
+#include <array>
 #include <cstdint>
+#include <cstring>
 #include <cassert>
 #include <type_traits>
 #include <algorithm>
+#include <bit>
+
+#include "jive/detail/cpu_features.h"
 
 #ifdef __APPLE__
  /*
@@ -361,11 +370,263 @@ T HostToBigEndian(void *data)
 }
 
 
+template<typename T>
+concept Swappable =
+    (std::is_arithmetic_v<T> || std::is_enum_v<T>)
+    && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+
+namespace detail
+{
+
+    template<size_t width>
+    struct UnsignedBySize_;
+
+    template<> struct UnsignedBySize_<1> { using type = uint8_t; };
+    template<> struct UnsignedBySize_<2> { using type = uint16_t; };
+    template<> struct UnsignedBySize_<4> { using type = uint32_t; };
+    template<> struct UnsignedBySize_<8> { using type = uint64_t; };
+
+    template<size_t width>
+    using UnsignedBySize = typename UnsignedBySize_<width>::type;
+
+    template<typename U>
+    U SwapUnsigned(U value)
+    {
+        if constexpr (sizeof(U) == 1)
+        {
+            return value;
+        }
+#if defined(_MSC_VER) && !defined(__clang__)
+        else if constexpr (sizeof(U) == 2)
+        {
+            return _byteswap_ushort(value);
+        }
+        else if constexpr (sizeof(U) == 4)
+        {
+            return _byteswap_ulong(value);
+        }
+        else
+        {
+            return _byteswap_uint64(value);
+        }
+#else
+        else if constexpr (sizeof(U) == 2)
+        {
+            return __builtin_bswap16(value);
+        }
+        else if constexpr (sizeof(U) == 4)
+        {
+            return __builtin_bswap32(value);
+        }
+        else
+        {
+            return __builtin_bswap64(value);
+        }
+#endif
+    }
+
+    // Shuffle control that reverses each width-byte group in a 32 byte block.
+    template<size_t width>
+    constexpr std::array<uint8_t, 32> MakeSwapMask()
+    {
+        std::array<uint8_t, 32> mask{};
+
+        for (size_t i = 0; i < mask.size(); ++i)
+        {
+            // _mm256_shuffle_epi8 indexes within each 16 byte lane.
+            auto lanePosition = i % 16;
+            auto group = lanePosition / width;
+
+            mask[i] = static_cast<uint8_t>(
+                group * width + (width - 1 - lanePosition % width));
+        }
+
+        return mask;
+    }
+
+#ifdef JIVE_X86_DISPATCH
+
+    template<size_t width>
+    JIVE_TARGET("avx2")
+    size_t SwapBlocksAvx2(
+        const uint8_t *input,
+        uint8_t *output,
+        size_t byteCount)
+    {
+        alignas(32) static constexpr auto mask = MakeSwapMask<width>();
+
+        const __m256i mask256 =
+            _mm256_load_si256(reinterpret_cast<const __m256i *>(mask.data()));
+
+        size_t offset = 0;
+
+        for (; offset + 32 <= byteCount; offset += 32)
+        {
+            __m256i block = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(input + offset));
+
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i *>(output + offset),
+                _mm256_shuffle_epi8(block, mask256));
+        }
+
+        return offset;
+    }
+
+    template<size_t width>
+    JIVE_TARGET("ssse3")
+    size_t SwapBlocksSsse3(
+        const uint8_t *input,
+        uint8_t *output,
+        size_t byteCount)
+    {
+        alignas(16) static constexpr auto mask = MakeSwapMask<width>();
+
+        const __m128i mask128 =
+            _mm_load_si128(reinterpret_cast<const __m128i *>(mask.data()));
+
+        size_t offset = 0;
+
+        for (; offset + 16 <= byteCount; offset += 16)
+        {
+            __m128i block = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(input + offset));
+
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i *>(output + offset),
+                _mm_shuffle_epi8(block, mask128));
+        }
+
+        return offset;
+    }
+
+#endif // JIVE_X86_DISPATCH
+
+    /**
+     ** Swap as many whole blocks as the processor's instruction set allows.
+     **
+     ** @return The count of bytes processed.
+     **/
+    template<size_t width>
+    size_t SwapBlocks(
+        [[maybe_unused]] const uint8_t *input,
+        [[maybe_unused]] uint8_t *output,
+        [[maybe_unused]] size_t byteCount)
+    {
+        size_t offset = 0;
+
+#ifdef JIVE_X86_DISPATCH
+        if (HasAvx2())
+        {
+            offset = SwapBlocksAvx2<width>(input, output, byteCount);
+        }
+
+        // Finishes a 16 byte block that AVX2 left over.
+        if (HasSsse3())
+        {
+            offset += SwapBlocksSsse3<width>(
+                input + offset,
+                output + offset,
+                byteCount - offset);
+        }
+#endif
+
+        return offset;
+    }
+
+} // end namespace detail
+
+
+/** @return value with its bytes in reverse order. **/
+template<Swappable T>
+T ByteSwap(T value)
+{
+    using U = detail::UnsignedBySize<sizeof(T)>;
+
+    U bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    bits = detail::SwapUnsigned(bits);
+    std::memcpy(&value, &bits, sizeof(T));
+
+    return value;
+}
+
+
+/**
+ ** Reverse the byte order of count elements from input, storing the results
+ ** in output. input and output may be the same array.
+ **/
+template<Swappable T>
+void SwapBytes(const T *input, T *output, size_t count)
+{
+    if constexpr (sizeof(T) == 1)
+    {
+        if (input != output)
+        {
+            std::memmove(output, input, count);
+        }
+
+        return;
+    }
+    else
+    {
+        auto byteCount = count * sizeof(T);
+
+        auto offset = detail::SwapBlocks<sizeof(T)>(
+            reinterpret_cast<const uint8_t *>(input),
+            reinterpret_cast<uint8_t *>(output),
+            byteCount);
+
+        for (size_t i = offset / sizeof(T); i < count; ++i)
+        {
+            output[i] = ByteSwap(input[i]);
+        }
+    }
+}
+
+
+/** Reverse the byte order of count elements in place. **/
+template<Swappable T>
+void SwapBytes(T *data, size_t count)
+{
+    SwapBytes(static_cast<const T *>(data), data, count);
+}
+
+
+/** Convert count elements between host order and byteOrder, in place. **/
+template<std::endian byteOrder, Swappable T>
+void ConvertByteOrder(T *data, size_t count)
+{
+    if constexpr (byteOrder != std::endian::native)
+    {
+        SwapBytes(data, count);
+    }
+}
+
+
+/** Convert a value between host order and byteOrder. **/
+template<std::endian byteOrder, Swappable T>
+T ConvertByteOrder(T value)
+{
+    if constexpr (byteOrder != std::endian::native)
+    {
+        return ByteSwap(value);
+    }
+    else
+    {
+        return value;
+    }
+}
+
+
 namespace detail
 {
 
     struct ToBigEndian
     {
+        static constexpr auto byteOrder = std::endian::big;
+
         template<typename T>
         T operator()(T value)
         {
@@ -375,6 +636,8 @@ namespace detail
 
     struct FromBigEndian
     {
+        static constexpr auto byteOrder = std::endian::big;
+
         template<typename T>
         T operator()(T value)
         {
@@ -384,6 +647,8 @@ namespace detail
 
     struct ToLittleEndian
     {
+        static constexpr auto byteOrder = std::endian::little;
+
         template<typename T>
         T operator()(T value)
         {
@@ -393,6 +658,8 @@ namespace detail
 
     struct FromLittleEndian
     {
+        static constexpr auto byteOrder = std::endian::little;
+
         template<typename T>
         T operator()(T value)
         {
@@ -412,6 +679,24 @@ void RangeSwap(
     InputIterator inputEnd,
     OutputIterator outputBegin)
 {
+    using InputValue =
+        std::remove_cv_t<std::remove_pointer_t<InputIterator>>;
+
+    if constexpr (
+        Operation::byteOrder != std::endian::native
+        && std::is_pointer_v<InputIterator>
+        && std::is_same_v<OutputIterator, InputValue *>
+        && Swappable<InputValue>)
+    {
+        // The operation reverses every element of a contiguous array.
+        SwapBytes(
+            inputBegin,
+            outputBegin,
+            static_cast<size_t>(inputEnd - inputBegin));
+
+        return;
+    }
+
     if constexpr (1 == sizeof(std::remove_pointer_t<InputIterator>))
     {
         // Can't swap single byte values.
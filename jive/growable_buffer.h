@@ -0,0 +1,319 @@
+/**
+  * @file growable_buffer.h
+  *
+  * @brief A resizable Buffer that never initializes its elements.
+  *
+  * Use GrowableBuffer where std::vector would pay to value-initialize every
+  * element on resize, for example when building an outgoing message in place.
+  *
+  * Capacity grows geometrically. Once an allocation reaches remapByteCount, it
+  * moves to an anonymous mapping, and later growth uses mremap, which can
+  * extend the mapping in place or move its pages without copying them.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <type_traits>
+#include <sys/mman.h>
+
+#include "jive/buffer.h"
+#include "jive/memory_map.h"
+
+
+namespace jive
+{
+
+
+template<
+    typename T,
+    size_t align_ = (alignof(T) < minimumAlign) ? minimumAlign : alignof(T)>
+class GrowableBuffer
+{
+public:
+    static_assert(std::is_trivial_v<T>);
+    static_assert(align_ % sizeof(void *) == 0);
+    static_assert((align_ & (align_ - 1)) == 0);
+
+    static constexpr auto align = align_;
+
+    using type = T;
+
+#ifdef __linux__
+    // mremap returns page-aligned memory, so it cannot honor larger alignment.
+    static constexpr bool canRemap = (align <= 4096);
+#else
+    static constexpr bool canRemap = false;
+#endif
+
+    // Allocations of at least this many bytes are mapped and grow by mremap.
+    static constexpr size_t remapByteCount = size_t{1} << 20;
+
+    GrowableBuffer()
+        :
+        elementCount_(0),
+        capacity_(0),
+        allocatedByteCount_(0),
+        isMapped_(false),
+        data_(nullptr)
+    {
+
+    }
+
+    explicit GrowableBuffer(size_t capacity)
+        :
+        GrowableBuffer()
+    {
+        this->Reserve(capacity);
+    }
+
+    ~GrowableBuffer()
+    {
+        this->Release_();
+    }
+
+    GrowableBuffer(const GrowableBuffer &) = delete;
+    GrowableBuffer & operator=(const GrowableBuffer &) = delete;
+
+    GrowableBuffer(GrowableBuffer &&other) noexcept
+        :
+        elementCount_(other.elementCount_),
+        capacity_(other.capacity_),
+        allocatedByteCount_(other.allocatedByteCount_),
+        isMapped_(other.isMapped_),
+        data_(other.data_)
+    {
+        other.Forget_();
+    }
+
+    GrowableBuffer & operator=(GrowableBuffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            this->Release_();
+            this->elementCount_ = other.elementCount_;
+            this->capacity_ = other.capacity_;
+            this->allocatedByteCount_ = other.allocatedByteCount_;
+            this->isMapped_ = other.isMapped_;
+            this->data_ = other.data_;
+            other.Forget_();
+        }
+
+        return *this;
+    }
+
+    /** Ensure room for at least capacity elements without reallocating. **/
+    void Reserve(size_t capacity)
+    {
+        if (capacity > this->capacity_)
+        {
+            this->Reallocate_(capacity);
+        }
+    }
+
+    /**
+     ** Change the element count. New elements are left uninitialized.
+     **
+     ** Growth beyond the capacity is geometric, so repeated small increases
+     ** cost amortized constant time.
+     **/
+    void ResizeUninitialized(size_t elementCount)
+    {
+        if (elementCount > this->capacity_)
+        {
+            this->Grow_(elementCount);
+        }
+
+        this->elementCount_ = elementCount;
+    }
+
+    /** values may lie inside this buffer. **/
+    void Append(std::span<const T> values)
+    {
+        if (values.empty())
+        {
+            return;
+        }
+
+        auto offset = this->elementCount_;
+        std::less<const T *> isBefore;
+
+        // Growth may move the contents, so find values again afterwards.
+        bool isInside = !isBefore(values.data(), this->data_)
+            && isBefore(values.data(), this->data_ + offset);
+
+        auto sourceIndex = isInside
+            ? static_cast<size_t>(values.data() - this->data_)
+            : size_t{0};
+
+        this->ResizeUninitialized(offset + values.size());
+
+        auto source = isInside ? this->data_ + sourceIndex : values.data();
+
+        std::memcpy(
+            this->data_ + offset,
+            source,
+            values.size() * sizeof(T));
+    }
+
+    void Append(const T &value)
+    {
+        this->Append(std::span<const T>(&value, 1));
+    }
+
+    /** Set the element count to zero, keeping the capacity. **/
+    void Clear()
+    {
+        this->elementCount_ = 0;
+    }
+
+    size_t GetElementCount() const { return this->elementCount_; }
+
+    size_t GetByteCount() const { return this->elementCount_ * sizeof(T); }
+
+    size_t GetCapacity() const { return this->capacity_; }
+
+    size_t GetAllocatedByteCount() const { return this->allocatedByteCount_; }
+
+    bool IsMapped() const { return this->isMapped_; }
+
+    const T * Get() const { return this->data_; }
+
+    T * Get() { return this->data_; }
+
+private:
+    using Mapped = MappedAllocation<>;
+
+    void Grow_(size_t minimumCapacity)
+    {
+        this->Reallocate_(
+            std::max(minimumCapacity, this->capacity_ + this->capacity_ / 2));
+    }
+
+    void Reallocate_(size_t capacity)
+    {
+        auto byteCount = capacity * sizeof(T);
+
+        if constexpr (canRemap)
+        {
+            if (byteCount >= remapByteCount)
+            {
+                this->Remap_(byteCount);
+                return;
+            }
+        }
+
+        assert(!this->isMapped_);
+
+        auto allocatedByteCount =
+            detail::GetAlignedByteCount<T, align>(capacity);
+
+        auto data = static_cast<T *>(
+            AlignedNew::Allocate(allocatedByteCount, align));
+
+        this->CopyAndRelease_(data);
+
+        this->data_ = data;
+        this->allocatedByteCount_ = allocatedByteCount;
+        this->capacity_ = allocatedByteCount / sizeof(T);
+    }
+
+    void Remap_(size_t byteCount)
+    {
+        auto mappedByteCount = Mapped::GetMappedByteCount(byteCount);
+
+        if (this->isMapped_)
+        {
+#ifdef __linux__
+            void *remapped = mremap(
+                this->data_,
+                this->allocatedByteCount_,
+                mappedByteCount,
+                MREMAP_MAYMOVE);
+
+            if (remapped == MAP_FAILED)
+            {
+                throw MemoryMapError(
+                    SystemError(errno),
+                    "Failed to grow mapping");
+            }
+
+            this->data_ = static_cast<T *>(remapped);
+#endif
+        }
+        else
+        {
+            auto data = static_cast<T *>(
+                Mapped::Allocate(mappedByteCount, align));
+
+            this->CopyAndRelease_(data);
+            this->data_ = data;
+            this->isMapped_ = true;
+        }
+
+        this->allocatedByteCount_ = mappedByteCount;
+        this->capacity_ = mappedByteCount / sizeof(T);
+    }
+
+    void CopyAndRelease_(T *data)
+    {
+        if (this->data_ != nullptr)
+        {
+            if (this->elementCount_ > 0)
+            {
+                std::memcpy(data, this->data_, this->GetByteCount());
+            }
+
+            this->Release_();
+        }
+    }
+
+    void Release_()
+    {
+        if (this->data_ == nullptr)
+        {
+            return;
+        }
+
+        if (this->isMapped_)
+        {
+            Mapped::Deallocate(this->data_, this->allocatedByteCount_, align);
+        }
+        else
+        {
+            AlignedNew::Deallocate(
+                this->data_,
+                this->allocatedByteCount_,
+                align);
+        }
+
+        this->data_ = nullptr;
+    }
+
+    void Forget_()
+    {
+        this->elementCount_ = 0;
+        this->capacity_ = 0;
+        this->allocatedByteCount_ = 0;
+        this->isMapped_ = false;
+        this->data_ = nullptr;
+    }
+
+private:
+    size_t elementCount_;
+    size_t capacity_;
+    size_t allocatedByteCount_;
+    bool isMapped_;
+    T *data_;
+};
+
+
+} // end namespace jive
@@ -0,0 +1,278 @@
+/**
+  * @file mapped_buffer.h
+  *
+  * @brief A read-only view of a file's contents, backed by mmap.
+  *
+  * MappedBuffer has the same read interface as Buffer, so it can replace
+  * Buffer::FromStream for large files. Construction is O(1): pages are read
+  * from the page cache on first access, and nothing is copied to the heap.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "jive/memory_map.h"
+
+
+namespace jive
+{
+
+
+/** Tells the kernel how the mapping will be read. **/
+enum class MapAdvice
+{
+    normal,
+
+    // Read ahead aggressively, and drop pages soon after they are read.
+    sequential,
+
+    // Disable read-ahead.
+    random,
+
+    // Start reading the whole file into the page cache now.
+    willNeed
+};
+
+
+namespace detail
+{
+
+
+inline int GetAdvice(MapAdvice advice)
+{
+    switch (advice)
+    {
+        case MapAdvice::sequential:
+            return MADV_SEQUENTIAL;
+
+        case MapAdvice::random:
+            return MADV_RANDOM;
+
+        case MapAdvice::willNeed:
+            return MADV_WILLNEED;
+
+        case MapAdvice::normal:
+        default:
+            return MADV_NORMAL;
+    }
+}
+
+
+} // end namespace detail
+
+
+template<typename T>
+class MappedBuffer
+{
+public:
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    using type = T;
+
+    /**
+     ** Map the contents of fileName, starting at byteOffset, which must be a
+     ** multiple of alignof(T).
+     **
+     ** @param elementCount The count of elements to map. By default, maps as
+     ** many whole elements as the file holds after byteOffset.
+     **/
+    explicit MappedBuffer(
+        const std::string &fileName,
+        MapAdvice advice = MapAdvice::sequential,
+        size_t byteOffset = 0,
+        std::optional<size_t> elementCount = {})
+        :
+        elementCount_(0),
+        mappedData_(nullptr),
+        mappedByteCount_(0),
+        data_(nullptr)
+    {
+        // The mapping starts on a page boundary, so the elements are aligned
+        // only when the offset is.
+        if (byteOffset % alignof(T) != 0)
+        {
+            throw MemoryMapError(
+                std::make_error_code(std::errc::invalid_argument),
+                "Offset is not aligned for the element type");
+        }
+
+        int handle = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (handle == -1)
+        {
+            throw MemoryMapError(
+                SystemError(errno),
+                "Failed to open " + fileName);
+        }
+
+        struct stat fileStatus;
+
+        if (fstat(handle, &fileStatus) == -1)
+        {
+            auto errorNumber = errno;
+            close(handle);
+
+            throw MemoryMapError(
+                SystemError(errorNumber),
+                "Failed to get size of " + fileName);
+        }
+
+        auto fileSize = static_cast<size_t>(fileStatus.st_size);
+
+        if (byteOffset > fileSize)
+        {
+            close(handle);
+
+            throw MemoryMapError(
+                std::make_error_code(std::errc::invalid_argument),
+                "Offset is beyond the end of " + fileName);
+        }
+
+        auto availableCount = (fileSize - byteOffset) / sizeof(T);
+
+        if (elementCount)
+        {
+            if (*elementCount > availableCount)
+            {
+                close(handle);
+
+                throw MemoryMapError(
+                    std::make_error_code(std::errc::invalid_argument),
+                    "Requested more elements than " + fileName + " holds");
+            }
+
+            this->elementCount_ = *elementCount;
+        }
+        else
+        {
+            this->elementCount_ = availableCount;
+        }
+
+        if (this->elementCount_ == 0)
+        {
+            // mmap rejects empty mappings.
+            close(handle);
+            return;
+        }
+
+        // mmap requires the file offset to be a multiple of the page size.
+        auto pageOffset = byteOffset % GetPageSize();
+        this->mappedByteCount_ = pageOffset + this->elementCount_ * sizeof(T);
+
+        void *mapped = mmap(
+            nullptr,
+            this->mappedByteCount_,
+            PROT_READ,
+            MAP_PRIVATE,
+            handle,
+            static_cast<off_t>(byteOffset - pageOffset));
+
+        auto errorNumber = errno;
+
+        // The mapping keeps its own reference to the file.
+        close(handle);
+
+        if (mapped == MAP_FAILED)
+        {
+            throw MemoryMapError(
+                SystemError(errorNumber),
+                "Failed to map " + fileName);
+        }
+
+        this->mappedData_ = mapped;
+
+        this->data_ = reinterpret_cast<const T *>(
+            static_cast<const uint8_t *>(mapped) + pageOffset);
+
+        this->Advise(advice);
+    }
+
+    ~MappedBuffer()
+    {
+        this->Release_();
+    }
+
+    MappedBuffer(const MappedBuffer &) = delete;
+    MappedBuffer & operator=(const MappedBuffer &) = delete;
+
+    MappedBuffer(MappedBuffer &&other) noexcept
+        :
+        elementCount_(other.elementCount_),
+        mappedData_(other.mappedData_),
+        mappedByteCount_(other.mappedByteCount_),
+        data_(other.data_)
+    {
+        other.mappedData_ = nullptr;
+        other.data_ = nullptr;
+        other.elementCount_ = 0;
+    }
+
+    MappedBuffer & operator=(MappedBuffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            this->Release_();
+            this->elementCount_ = other.elementCount_;
+            this->mappedData_ = other.mappedData_;
+            this->mappedByteCount_ = other.mappedByteCount_;
+            this->data_ = other.data_;
+            other.mappedData_ = nullptr;
+            other.data_ = nullptr;
+            other.elementCount_ = 0;
+        }
+
+        return *this;
+    }
+
+    /** Change the read-ahead hint for the whole mapping. **/
+    void Advise(MapAdvice advice)
+    {
+        if (this->mappedData_ != nullptr)
+        {
+            // Advisory only, so failure is not an error.
+            madvise(
+                this->mappedData_,
+                this->mappedByteCount_,
+                detail::GetAdvice(advice));
+        }
+    }
+
+    size_t GetElementCount() const { return this->elementCount_; }
+
+    size_t GetByteCount() const { return this->elementCount_ * sizeof(T); }
+
+    size_t GetAllocatedByteCount() const { return this->mappedByteCount_; }
+
+    const T * Get() const { return this->data_; }
+
+private:
+    void Release_()
+    {
+        if (this->mappedData_ != nullptr)
+        {
+            munmap(this->mappedData_, this->mappedByteCount_);
+            this->mappedData_ = nullptr;
+        }
+    }
+
+private:
+    size_t elementCount_;
+    void *mappedData_;
+    size_t mappedByteCount_;
+    const T *data_;
+};
+
+
+} // end namespace jive
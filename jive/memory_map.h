@@ -0,0 +1,236 @@
+/**
+  * @file memory_map.h
+  *
+  * @brief Shared helpers for classes that manage virtual memory directly.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "jive/error.h"
+#include "jive/create_exception.h"
+#include "jive/buffer.h"
+
+
+namespace jive
+{
+
+
+CREATE_SYSTEM_ERROR(MemoryMapError, std::system_error);
+
+
+inline size_t GetPageSize()
+{
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    return pageSize;
+}
+
+
+/** @return byteCount rounded up to the next multiple of multiple. **/
+inline size_t RoundUp(size_t byteCount, size_t multiple)
+{
+    auto error = byteCount % multiple;
+
+    return (error == 0)
+        ? byteCount
+        : byteCount + (multiple - error);
+}
+
+
+enum class HugePages
+{
+    // Regular pages.
+    none,
+
+    // Ask the kernel to back the region with transparent huge pages
+    // (madvise MADV_HUGEPAGE). The region is aligned to hugePageSize.
+    transparent,
+
+    // Map from the reserved huge page pool (MAP_HUGETLB). Fails unless the
+    // system has huge pages reserved (vm.nr_hugepages).
+    reserved
+};
+
+
+/**
+ ** A Buffer allocation policy backed by anonymous mmap.
+ **
+ ** Use it for large buffers that should bypass the heap:
+ **
+ **     jive::Buffer<float, 64, jive::MappedAllocation<>> buffer(count);
+ **
+ ** @tparam hugePages Request huge pages to reduce TLB misses.
+ ** @tparam populate Prefault every page during allocation (MAP_POPULATE), so
+ ** the first pass over the buffer does not take page faults.
+ **
+ ** The kernel supplies zeroed pages on first touch. There is no per-element
+ ** initialization.
+ **/
+template<HugePages hugePages = HugePages::none, bool populate = false>
+struct MappedAllocation
+{
+    static size_t GetMappedByteCount(size_t byteCount)
+    {
+        if constexpr (hugePages == HugePages::reserved)
+        {
+            return RoundUp(byteCount, hugePageSize);
+        }
+        else
+        {
+            return RoundUp(byteCount, GetPageSize());
+        }
+    }
+
+    static size_t GetMappedAlign(size_t align)
+    {
+        if constexpr (hugePages == HugePages::transparent)
+        {
+            return std::max(align, hugePageSize);
+        }
+        else
+        {
+            return align;
+        }
+    }
+
+    static void * Allocate(size_t byteCount, size_t align)
+    {
+        // mmap rejects a length of zero, but an empty Buffer is valid.
+        if (byteCount == 0)
+        {
+            return nullptr;
+        }
+
+        auto mappedByteCount = GetMappedByteCount(byteCount);
+        auto mappedAlign = GetMappedAlign(align);
+
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+        if constexpr (hugePages == HugePages::reserved)
+        {
+            flags |= MAP_HUGETLB;
+        }
+
+        if constexpr (populate && hugePages != HugePages::transparent)
+        {
+            flags |= MAP_POPULATE;
+        }
+
+        // Alignment larger than a page requires reserving extra address
+        // space, and trimming the excess after the aligned start is known.
+        bool overAlign =
+            (hugePages != HugePages::reserved)
+            && (mappedAlign > GetPageSize());
+
+        auto requestedByteCount = overAlign
+            ? mappedByteCount + mappedAlign
+            : mappedByteCount;
+
+        void *mapped = mmap(
+            nullptr,
+            requestedByteCount,
+            PROT_READ | PROT_WRITE,
+            flags,
+            -1,
+            0);
+
+        if (mapped == MAP_FAILED)
+        {
+            throw MemoryMapError(
+                SystemError(errno),
+                "Failed to map " + std::to_string(requestedByteCount)
+                    + " bytes");
+        }
+
+        auto first = reinterpret_cast<uintptr_t>(mapped);
+        auto aligned = first;
+
+        if (overAlign)
+        {
+            aligned = RoundUp(first, mappedAlign);
+            auto end = first + requestedByteCount;
+            auto alignedEnd = aligned + mappedByteCount;
+
+            if (aligned > first)
+            {
+                munmap(mapped, aligned - first);
+            }
+
+            if (end > alignedEnd)
+            {
+                munmap(reinterpret_cast<void *>(alignedEnd), end - alignedEnd);
+            }
+        }
+
+        auto result = reinterpret_cast<void *>(aligned);
+
+        if constexpr (hugePages == HugePages::transparent)
+        {
+            // Advisory only. Kernels without THP support keep regular pages.
+            madvise(result, mappedByteCount, MADV_HUGEPAGE);
+
+            if constexpr (populate)
+            {
+                // MAP_POPULATE would fault in regular pages before madvise
+                // could request huge pages, so prefault afterwards.
+                Prefault_(result, mappedByteCount);
+            }
+        }
+
+        return result;
+    }
+
+    static void Deallocate(void *data, size_t byteCount, size_t)
+    {
+        if (byteCount == 0)
+        {
+            return;
+        }
+
+        munmap(data, GetMappedByteCount(byteCount));
+    }
+
+private:
+    static void Prefault_(void *data, size_t byteCount)
+    {
+#ifdef MADV_POPULATE_WRITE
+        if (madvise(data, byteCount, MADV_POPULATE_WRITE) == 0)
+        {
+            return;
+        }
+#endif
+
+        // Older kernels: write one byte per page.
+        auto bytes = static_cast<volatile uint8_t *>(data);
+
+        for (size_t i = 0; i < byteCount; i += GetPageSize())
+        {
+            bytes[i] = 0;
+        }
+    }
+};
+
+
+/** A Buffer backed by huge pages, aligned to hugePageSize. **/
+template<
+    typename T,
+    HugePages hugePages = HugePages::transparent,
+    bool populate = false>
+using HugePageBuffer = Buffer<
+    T,
+    hugePageSize,
+    MappedAllocation<hugePages, populate>>;
+
+
+} // end namespace jive
@@ -0,0 +1,303 @@
+/**
+  * @file mirrored_buffer.h
+  *
+  * @brief A ring buffer that maps the same physical pages twice in a row.
+  *
+  * Because the second mapping aliases the first, element capacity + i is the
+  * same memory as element i. Every readable or writable region is a single
+  * contiguous span, even when it wraps past the physical end of the buffer.
+  * Wrapped reads and writes need only one memcpy, and a wrapped region can be
+  * passed directly to recv, send, or a parser without copying.
+  *
+  * The capacity is rounded up so that the mapping covers whole pages.
+  *
+  * Linux only (memfd_create).
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "jive/memory_map.h"
+
+
+namespace jive
+{
+
+
+template<typename T>
+class MirroredBuffer
+{
+public:
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    using type = T;
+
+    /**
+     ** @param minimumCapacity The element count is rounded up to fill whole
+     ** pages.
+     **/
+    explicit MirroredBuffer(size_t minimumCapacity)
+        :
+        byteCount_(
+            RoundUp(
+                std::max(minimumCapacity, size_t{1}) * sizeof(T),
+                std::lcm(GetPageSize(), sizeof(T)))),
+        capacity_(byteCount_ / sizeof(T)),
+        data_(nullptr),
+        readIndex_(0),
+        size_(0)
+    {
+        int handle = memfd_create("jive_mirrored_buffer", MFD_CLOEXEC);
+
+        if (handle == -1)
+        {
+            throw MemoryMapError(
+                SystemError(errno),
+                "Failed to create memory file");
+        }
+
+        if (ftruncate(handle, static_cast<off_t>(this->byteCount_)) == -1)
+        {
+            auto errorNumber = errno;
+            close(handle);
+
+            throw MemoryMapError(
+                SystemError(errorNumber),
+                "Failed to size memory file");
+        }
+
+        // Reserve enough address space for both views.
+        void *reserved = mmap(
+            nullptr,
+            2 * this->byteCount_,
+            PROT_NONE,
+            MAP_PRIVATE | MAP_ANONYMOUS,
+            -1,
+            0);
+
+        if (reserved == MAP_FAILED)
+        {
+            auto errorNumber = errno;
+            close(handle);
+
+            throw MemoryMapError(
+                SystemError(errorNumber),
+                "Failed to reserve address space");
+        }
+
+        auto base = static_cast<uint8_t *>(reserved);
+
+        for (auto offset: {size_t{0}, this->byteCount_})
+        {
+            void *view = mmap(
+                base + offset,
+                this->byteCount_,
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_FIXED,
+                handle,
+                0);
+
+            if (view == MAP_FAILED)
+            {
+                auto errorNumber = errno;
+                munmap(reserved, 2 * this->byteCount_);
+                close(handle);
+
+                throw MemoryMapError(
+                    SystemError(errorNumber),
+                    "Failed to map mirrored view");
+            }
+        }
+
+        // The mappings hold their own reference to the memory file.
+        close(handle);
+
+        this->data_ = static_cast<T *>(reserved);
+    }
+
+    ~MirroredBuffer()
+    {
+        if (this->data_ != nullptr)
+        {
+            munmap(this->data_, 2 * this->byteCount_);
+        }
+    }
+
+    MirroredBuffer(const MirroredBuffer &) = delete;
+    MirroredBuffer & operator=(const MirroredBuffer &) = delete;
+
+    MirroredBuffer(MirroredBuffer &&other) noexcept
+        :
+        byteCount_(other.byteCount_),
+        capacity_(other.capacity_),
+        data_(other.data_),
+        readIndex_(other.readIndex_),
+        size_(other.size_)
+    {
+        other.data_ = nullptr;
+        other.Reset();
+    }
+
+    MirroredBuffer & operator=(MirroredBuffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (this->data_ != nullptr)
+            {
+                munmap(this->data_, 2 * this->byteCount_);
+            }
+
+            this->byteCount_ = other.byteCount_;
+            this->capacity_ = other.capacity_;
+            this->data_ = other.data_;
+            this->readIndex_ = other.readIndex_;
+            this->size_ = other.size_;
+
+            other.data_ = nullptr;
+            other.Reset();
+        }
+
+        return *this;
+    }
+
+    void Reset()
+    {
+        this->readIndex_ = 0;
+        this->size_ = 0;
+    }
+
+    bool IsEmpty() const
+    {
+        return this->size_ == 0;
+    }
+
+    size_t GetCapacity() const
+    {
+        return this->capacity_;
+    }
+
+    size_t GetSize() const
+    {
+        return this->size_;
+    }
+
+    size_t GetAvailable() const
+    {
+        return this->capacity_ - this->size_;
+    }
+
+    /**
+     ** @return All unread elements as one contiguous span.
+     **/
+    std::span<const T> GetReadable() const
+    {
+        return {this->data_ + this->readIndex_, this->size_};
+    }
+
+    std::span<T> GetReadable()
+    {
+        return {this->data_ + this->readIndex_, this->size_};
+    }
+
+    /**
+     ** @return All free space as one contiguous span.
+     **
+     ** Fill some or all of it, then call CommitWrite with the count of
+     ** elements written.
+     **/
+    std::span<T> GetWritable()
+    {
+        return {
+            this->data_ + this->readIndex_ + this->size_,
+            this->GetAvailable()};
+    }
+
+    void CommitWrite(size_t count)
+    {
+        assert(count <= this->GetAvailable());
+        this->size_ += count;
+    }
+
+    bool Write(const T *source, size_t count)
+    {
+        if (count > this->GetAvailable())
+        {
+            return false;
+        }
+
+        std::memcpy(this->GetWritable().data(), source, sizeof(T) * count);
+        this->size_ += count;
+
+        return true;
+    }
+
+    bool Peek(T *target, size_t count) const
+    {
+        if (count > this->size_)
+        {
+            return false;
+        }
+
+        std::memcpy(target, this->data_ + this->readIndex_, sizeof(T) * count);
+
+        return true;
+    }
+
+    bool Read(T *target, size_t count)
+    {
+        if (this->Peek(target, count))
+        {
+            this->Remove(count);
+            return true;
+        }
+
+        return false;
+    }
+
+    void Remove(size_t count)
+    {
+        assert(count <= this->size_);
+
+        this->size_ -= count;
+        this->readIndex_ += count;
+
+        if (this->readIndex_ >= this->capacity_)
+        {
+            // Move back into the first view.
+            this->readIndex_ -= this->capacity_;
+        }
+    }
+
+    size_t GetReadIndex() const
+    {
+        return this->readIndex_;
+    }
+
+    size_t GetWriteIndex() const
+    {
+        return (this->readIndex_ + this->size_) % this->capacity_;
+    }
+
+private:
+    size_t byteCount_;
+    size_t capacity_;
+    T *data_;
+    size_t readIndex_;
+    size_t size_;
+};
+
+
+} // end namespace jive
@@ -0,0 +1,141 @@
+/**
+  * @file record_index.h
+  *
+  * @brief Navigate length-prefixed records without reading their payloads.
+  *
+  * A length-prefixed record is a CountType byte count followed by that many
+  * payload bytes, as written by io::WriteString<CountType> or
+  * io::WriteArray<CountType> of bytes. RecordIndex reads only the prefixes and
+  * skips each payload, so building an index costs one seek per record on a
+  * file, mapped memory, or seekable stream.
+  *
+  * The reader is any class with Read<CountType>(), Skip(byteCount), and
+  * IsEnd(), like BufferedReader or ViewReader.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "jive/binary_io.h"
+
+
+namespace jive
+{
+
+namespace io
+{
+
+
+template<typename Reader, typename CountType>
+concept RecordReader = requires (Reader &reader, size_t byteCount)
+{
+    reader.template Read<CountType>();
+    reader.Skip(byteCount);
+    { reader.IsEnd() } -> std::convertible_to<bool>;
+};
+
+
+/** Skip recordCount length-prefixed records. **/
+template<typename CountType = uint32_t, typename Reader>
+requires RecordReader<Reader, CountType>
+void SkipRecords(Reader &reader, size_t recordCount)
+{
+    for (size_t i = 0; i < recordCount; ++i)
+    {
+        reader.Skip(static_cast<size_t>(reader.template Read<CountType>()));
+    }
+}
+
+
+template<typename CountType = uint32_t>
+class RecordIndex
+{
+public:
+    RecordIndex()
+        :
+        offsets_(),
+        byteCounts_()
+    {
+
+    }
+
+    /**
+     ** Index every record from the reader's position to the end of its
+     ** input. Offsets are relative to that starting position.
+     **/
+    template<typename Reader>
+    requires RecordReader<Reader, CountType>
+    static RecordIndex Build(Reader &reader)
+    {
+        RecordIndex index;
+        uint64_t offset = 0;
+
+        while (!reader.IsEnd())
+        {
+            auto byteCount =
+                static_cast<size_t>(reader.template Read<CountType>());
+
+            offset += sizeof(CountType);
+            index.offsets_.push_back(offset);
+            index.byteCounts_.push_back(byteCount);
+
+            reader.Skip(byteCount);
+            offset += byteCount;
+        }
+
+        return index;
+    }
+
+    size_t GetCount() const { return this->offsets_.size(); }
+
+    /** @return The offset of the payload, after its length prefix. **/
+    uint64_t GetOffset(size_t index) const
+    {
+        assert(index < this->offsets_.size());
+        return this->offsets_[index];
+    }
+
+    size_t GetByteCount(size_t index) const
+    {
+        assert(index < this->byteCounts_.size());
+        return this->byteCounts_[index];
+    }
+
+    /**
+     ** @return The payload of record index, from the same bytes the index
+     ** was built from (for example, through a ViewReader).
+     **/
+    std::span<const std::byte> GetRecord(
+        std::span<const std::byte> source,
+        size_t index) const
+    {
+        auto offset = this->GetOffset(index);
+        auto byteCount = this->GetByteCount(index);
+
+        if (offset + byteCount > source.size())
+        {
+            throw BinaryIoError("Record is outside of the source");
+        }
+
+        return source.subspan(static_cast<size_t>(offset), byteCount);
+    }
+
+private:
+    std::vector<uint64_t> offsets_;
+    std::vector<size_t> byteCounts_;
+};
+
+
+} // end namespace io
+
+} // end namespace jive
@@ -0,0 +1,180 @@
+/**
+  * @file sample_history.h
+  *
+  * @brief Keeps the most recent N samples from a single producer, and lets
+  * any number of reader threads copy them without locking.
+  *
+  * The producer never waits. Readers detect a torn copy by comparing sequence
+  * counters before and after they copy, and retry. A copy is only torn when
+  * the producer has wrapped around onto the copied slots, so readers asking
+  * for much less than N samples almost always succeed on the first attempt.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+
+namespace jive
+{
+
+
+template<typename T, size_t N>
+class SampleHistory
+{
+public:
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(N > 0);
+
+    SampleHistory()
+        :
+        pending_(0),
+        committed_(0),
+        elements_{}
+    {
+
+    }
+
+    SampleHistory(const SampleHistory &) = delete;
+    SampleHistory & operator=(const SampleHistory &) = delete;
+
+    static constexpr size_t GetCapacity() { return N; }
+
+    /** @return The count of samples written since construction. **/
+    uint64_t GetWriteCount() const
+    {
+        return this->committed_.load(std::memory_order_acquire);
+    }
+
+    /** Only one thread may write. **/
+    void Write(const T &sample)
+    {
+        this->Write(&sample, 1);
+    }
+
+    /** Only one thread may write. **/
+    void Write(const T *samples, size_t count)
+    {
+        auto end = this->committed_.load(std::memory_order_relaxed) + count;
+
+        if (count > N)
+        {
+            samples += count - N;
+            count = N;
+        }
+
+        // Announce which slots are about to change before changing them.
+        this->pending_.store(end, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        this->Copy_(samples, end - count, count);
+
+        this->committed_.store(end, std::memory_order_release);
+    }
+
+    /**
+     ** Make a single attempt to copy the newest samples into target, oldest
+     ** first.
+     **
+     ** @return The count of samples copied, or an empty optional if the
+     ** producer overwrote part of the copy while it was in progress.
+     **/
+    std::optional<size_t> TrySnapshot(std::span<T> target) const
+    {
+        uint64_t end = this->committed_.load(std::memory_order_acquire);
+
+        auto count = static_cast<size_t>(
+            std::min<uint64_t>({target.size(), end, N}));
+
+        if (count == 0)
+        {
+            return count;
+        }
+
+        uint64_t first = end - count;
+        auto index = static_cast<size_t>(first % N);
+        auto tailCount = std::min(count, N - index);
+
+        std::memcpy(
+            target.data(),
+            &this->elements_[index],
+            sizeof(T) * tailCount);
+
+        if (count > tailCount)
+        {
+            std::memcpy(
+                target.data() + tailCount,
+                &this->elements_[0],
+                sizeof(T) * (count - tailCount));
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // Slots holding samples older than pending - N may have been reused.
+        uint64_t pending = this->pending_.load(std::memory_order_relaxed);
+
+        if (pending > first + N)
+        {
+            return {};
+        }
+
+        return count;
+    }
+
+    /**
+     ** Copy the newest samples into target, oldest first, retrying until the
+     ** copy is consistent.
+     **
+     ** @return The count of samples copied.
+     **/
+    size_t Snapshot(std::span<T> target) const
+    {
+        std::optional<size_t> result;
+
+        while (!(result = this->TrySnapshot(target)))
+        {
+
+        }
+
+        return *result;
+    }
+
+private:
+    void Copy_(const T *samples, uint64_t first, size_t count)
+    {
+        auto index = static_cast<size_t>(first % N);
+        auto tailCount = std::min(count, N - index);
+
+        std::memcpy(&this->elements_[index], samples, sizeof(T) * tailCount);
+
+        if (count > tailCount)
+        {
+            std::memcpy(
+                &this->elements_[0],
+                samples + tailCount,
+                sizeof(T) * (count - tailCount));
+        }
+    }
+
+private:
+    // Written by the producer before it modifies elements_.
+    std::atomic<uint64_t> pending_;
+
+    // Written by the producer after elements_ are complete.
+    std::atomic<uint64_t> committed_;
+
+    T elements_[N];
+};
+
+
+} // end namespace jive
@@ -12,8 +12,15 @@
 #pragma once
 
 #include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <array>
+#include <cstddef>
+#include <cstring>
 #include <ostream>
+#include <string>
+#include <string_view>
 #include "jive/socket/error.h"
 #include "jive/strings.h"
 #include "jive/range.h"
@@ -144,4 +151,205 @@ std::ostream & operator<<(
 }
 
 
+/**
+ ** An address in any family the sockets support: IPv4, IPv6, or a Unix
+ ** domain path. A ServiceAddress converts implicitly, as IPv4.
+ **/
+class Endpoint
+{
+public:
+    Endpoint()
+        :
+        storage_{},
+        length_(0)
+    {
+
+    }
+
+    Endpoint(const ServiceAddress &serviceAddress)
+        :
+        storage_{},
+        length_(sizeof(SocketAddress))
+    {
+        auto socketAddress = serviceAddress.GetSocketAddress();
+        memcpy(&this->storage_, &socketAddress, sizeof(SocketAddress));
+    }
+
+    /** Copy an address filled in by the system, as by accept. **/
+    Endpoint(const struct sockaddr *address, socklen_t length)
+        :
+        storage_{},
+        length_(length)
+    {
+        if (length > sizeof(this->storage_))
+        {
+            throw SocketError(
+                std::make_error_code(std::errc::bad_address),
+                "Address is too long");
+        }
+
+        memcpy(&this->storage_, address, length);
+    }
+
+    static Endpoint Ipv6(const char *address, uint16_t port)
+    {
+        struct sockaddr_in6 socketAddress{};
+        socketAddress.sin6_family = AF_INET6;
+        socketAddress.sin6_port = HostToBigEndian(port);
+
+        if (1 != inet_pton(AF_INET6, address, &socketAddress.sin6_addr))
+        {
+            throw SocketError(
+                std::make_error_code(std::errc::bad_address),
+                "Expected an IPv6 address");
+        }
+
+        return Endpoint(
+            reinterpret_cast<const struct sockaddr *>(&socketAddress),
+            sizeof(socketAddress));
+    }
+
+    /**
+     ** A Unix domain socket path. A path that starts with '\0' names an
+     ** abstract socket, which leaves no file behind.
+     **/
+    static Endpoint Unix(std::string_view path)
+    {
+        struct sockaddr_un socketAddress{};
+        socketAddress.sun_family = AF_UNIX;
+
+        bool isAbstract = !path.empty() && path.front() == '\0';
+
+        // A file path needs room for its terminating null.
+        if (path.size() + (isAbstract ? 0 : 1)
+            > sizeof(socketAddress.sun_path))
+        {
+            throw SocketError(
+                std::make_error_code(std::errc::filename_too_long),
+                "Unix socket path is too long");
+        }
+
+        memcpy(socketAddress.sun_path, path.data(), path.size());
+
+        auto length = offsetof(struct sockaddr_un, sun_path) + path.size()
+            + (isAbstract ? 0 : 1);
+
+        return Endpoint(
+            reinterpret_cast<const struct sockaddr *>(&socketAddress),
+            static_cast<socklen_t>(length));
+    }
+
+    /** @return AF_INET, AF_INET6, AF_UNIX, or AF_UNSPEC when empty. **/
+    int GetFamily() const
+    {
+        if (this->length_ < sizeof(sa_family_t))
+        {
+            return AF_UNSPEC;
+        }
+
+        return this->storage_.ss_family;
+    }
+
+    /** @return The port, or 0 for families without one. **/
+    uint16_t GetPort() const
+    {
+        switch (this->GetFamily())
+        {
+            case AF_INET:
+                return BigEndianToHost(this->As_<sockaddr_in>().sin_port);
+
+            case AF_INET6:
+                return BigEndianToHost(this->As_<sockaddr_in6>().sin6_port);
+
+            default:
+                return 0;
+        }
+    }
+
+    ServiceAddress GetServiceAddress() const
+    {
+        if (this->GetFamily() != AF_INET)
+        {
+            throw SocketError(
+                std::make_error_code(std::errc::address_family_not_supported),
+                "Expected an IPv4 address");
+        }
+
+        return ServiceAddress(this->As_<sockaddr_in>());
+    }
+
+    const struct sockaddr * GetNative() const
+    {
+        return reinterpret_cast<const struct sockaddr *>(&this->storage_);
+    }
+
+    socklen_t GetLength() const
+    {
+        return this->length_;
+    }
+
+    std::string ToString() const
+    {
+        switch (this->GetFamily())
+        {
+            case AF_INET:
+                return this->GetServiceAddress().ToString();
+
+            case AF_INET6:
+            {
+                std::array<char, INET6_ADDRSTRLEN> text{};
+
+                inet_ntop(
+                    AF_INET6,
+                    &this->As_<sockaddr_in6>().sin6_addr,
+                    text.data(),
+                    text.size());
+
+                return "[" + std::string(text.data()) + "]:"
+                    + std::to_string(this->GetPort());
+            }
+
+            case AF_UNIX:
+            {
+                auto path = this->As_<sockaddr_un>().sun_path;
+
+                auto pathLength = this->length_
+                    - offsetof(struct sockaddr_un, sun_path);
+
+                if (pathLength > 0 && path[0] == '\0')
+                {
+                    // Abstract names are shown with a leading '@'.
+                    return "@" + std::string(path + 1, pathLength - 1);
+                }
+
+                return std::string(path, strnlen(path, pathLength));
+            }
+
+            default:
+                return "unspecified";
+        }
+    }
+
+private:
+    template<typename T>
+    const T & As_() const
+    {
+        return *reinterpret_cast<const T *>(&this->storage_);
+    }
+
+private:
+    struct sockaddr_storage storage_;
+    socklen_t length_;
+};
+
+
+inline
+std::ostream & operator<<(
+    std::ostream &outputStream,
+    const Endpoint &endpoint)
+{
+    return outputStream << endpoint.ToString();
+}
+
+
 } // end namespace jive
@@ -14,6 +14,12 @@
 #undef min
 #undef max
 
+#include <array>
+#include <climits>
+#include <span>
+#include <type_traits>
+#include <sys/uio.h>
+
 #include "jive/socket/socket.h"
 #include "jive/circular_buffer.h"
 
@@ -22,26 +28,163 @@ namespace jive
 {
 
 
+/**
+ ** By default, Read receives only the bytes still missing for the requested
+ ** object. With opportunistic reads, each receive takes everything that has
+ ** arrived, up to the free space in the read buffer, so a stream of small
+ ** objects costs one receive for many objects instead of one each.
+ **
+ ** Writes are sent immediately unless a write high-water mark is set. Then
+ ** they are copied into a write buffer, and sent together when it reaches
+ ** the mark, on Flush, or before a read has to wait for the peer.
+ **
+ ** @tparam BufferSize The capacity of the read buffer. When BufferSize is 0,
+ ** the capacity is chosen at runtime and the buffer is allocated on the heap.
+ **/
 template<size_t BufferSize>
 class Client: public Socket
 {
 public:
-    Client(const ServiceAddress &serviceAddress)
+    /** Connect a stream socket of the endpoint's family. **/
+    Client(const Endpoint &endpoint) requires (BufferSize != 0)
+        :
+        Socket(endpoint.GetFamily(), SOCK_STREAM),
+        readBuffer_(),
+        writeBuffer_(),
+        isOpportunistic_(false),
+        writeHighWater_(0)
+    {
+        this->Connect(endpoint);
+    }
+
+    Client(const Endpoint &endpoint, size_t bufferSize)
+        requires (BufferSize == 0)
+        :
+        Socket(endpoint.GetFamily(), SOCK_STREAM),
+        readBuffer_(bufferSize),
+        writeBuffer_(bufferSize),
+        isOpportunistic_(false),
+        writeHighWater_(0)
+    {
+        this->Connect(endpoint);
+    }
+
+    /** Sends any buffered writes, discarding errors. **/
+    ~Client()
+    {
+        if (this->GetHandle() == -1)
+        {
+            return;
+        }
+
+        try
+        {
+            this->Flush();
+        }
+        catch (...)
+        {
+            // Call Flush directly to observe errors.
+        }
+    }
+
+    Client(Client &&) = default;
+
+    /** Sends this client's buffered writes first, discarding errors. **/
+    Client & operator=(Client &&other)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        if (this->GetHandle() != -1)
+        {
+            try
+            {
+                this->Flush();
+            }
+            catch (...)
+            {
+                // Call Flush directly to observe errors.
+            }
+        }
+
+        Socket::operator=(std::move(other));
+        this->readBuffer_ = std::move(other.readBuffer_);
+        this->writeBuffer_ = std::move(other.writeBuffer_);
+        this->isOpportunistic_ = other.isOpportunistic_;
+        this->writeHighWater_ = other.writeHighWater_;
+
+        return *this;
+    }
+
+    void SetOpportunisticReads(bool isOpportunistic)
+    {
+        this->isOpportunistic_ = isOpportunistic;
+    }
+
+    bool HasOpportunisticReads() const
+    {
+        return this->isOpportunistic_;
+    }
+
+    /**
+     ** Hold writes until byteCount bytes are buffered. The mark is limited
+     ** to the buffer capacity, and 0, the default, sends each write at once.
+     **/
+    void SetWriteHighWater(size_t byteCount)
+    {
+        this->writeHighWater_ =
+            std::min(byteCount, this->writeBuffer_.GetCapacity());
+
+        if (this->writeBuffer_.GetSize() >= this->writeHighWater_)
+        {
+            this->Flush();
+        }
+    }
+
+    size_t GetWriteHighWater() const
     {
-        this->Connect(serviceAddress);
+        return this->writeHighWater_;
     }
 
+    /** @return The number of written bytes that have not been sent. **/
+    size_t GetPendingWriteCount() const
+    {
+        return this->writeBuffer_.GetSize();
+    }
+
+    /**
+     ** Send everything that is buffered. When isMoreComing, MSG_MORE asks
+     ** the kernel to hold a partial segment for the data that follows.
+     **/
+    void Flush(bool isMoreComing = false)
+    {
+        this->SendBuffered_({}, isMoreComing ? MSG_MORE : 0);
+    }
+
+#ifdef TCP_CORK
+    /**
+     ** While corked, the kernel sends only full segments, so that several
+     ** writes or flushes share them. Uncorking sends whatever remains.
+     **/
+    void SetCorked(bool isCorked)
+    {
+        this->SetOption<options::Cork>(isCorked);
+    }
+#endif
+
     template<typename T>
     void Write(const T &data)
     {
-        this->Send(&data, sizeof(T), 0);
+        this->Write(&data, sizeof(T));
     }
 
     template<typename T>
     T Read()
     {
         static_assert(
-            sizeof(T) <= BufferSize,
+            BufferSize == 0 || sizeof(T) <= BufferSize,
             "Increase the buffer size to receive larger objects.");
 
         T result;
@@ -59,9 +202,59 @@ public:
         return result;
     }
 
+    /**
+     ** Read objects until target is full. Each receive asks for all of the
+     ** remaining objects that fit in the read buffer, in either read mode.
+     **/
+    template<typename T, size_t Extent>
+    void ReadMany(std::span<T, Extent> target)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        static_assert(
+            BufferSize == 0 || sizeof(T) <= BufferSize,
+            "Increase the buffer size to receive larger objects.");
+
+        auto bytes = reinterpret_cast<uint8_t *>(target.data());
+        size_t remaining = target.size_bytes();
+
+        while (remaining > 0)
+        {
+            this->FillReadBuffer_(sizeof(T), remaining);
+
+            // Take only whole objects, so a partial one stays buffered.
+            auto count = std::min(
+                remaining,
+                this->readBuffer_.GetSize() / sizeof(T) * sizeof(T));
+
+            [[maybe_unused]] bool success =
+                this->readBuffer_.Read(bytes, count);
+
+            assert(success);
+
+            bytes += count;
+            remaining -= count;
+        }
+    }
+
+    /** Read byteCount bytes, starting with any that are already buffered. **/
     void Read(void *target, size_t byteCount)
     {
-        size_t receivedCount = 0;
+        size_t receivedCount =
+            std::min(byteCount, this->readBuffer_.GetSize());
+
+        if (receivedCount > 0)
+        {
+            this->readBuffer_.Read(
+                static_cast<uint8_t *>(target),
+                receivedCount);
+        }
+
+        if (receivedCount < byteCount)
+        {
+            // The peer may be waiting for buffered writes before it replies.
+            this->Flush();
+        }
 
         while (receivedCount < byteCount)
         {
@@ -80,24 +273,100 @@ public:
         }
     }
 
+    /**
+     ** Buffer the bytes when there is a high-water mark and room for them.
+     ** Otherwise, send them at once, behind anything already buffered.
+     **/
     void Write(const void *source, size_t byteCount)
     {
-        size_t sentCount = 0;
+        auto bytes = static_cast<const uint8_t *>(source);
 
-        while (sentCount < byteCount)
+        if (this->writeHighWater_ == 0
+            || byteCount > this->writeBuffer_.GetAvailable())
         {
-            auto increment = this->SendWait(
-                static_cast<const uint8_t *>(source) + sentCount,
-                byteCount - sentCount);
+            // Gather the buffered bytes and these into the same sendmsg.
+            this->SendBuffered_(std::span(bytes, byteCount), 0);
 
-            if (!increment)
+            return;
+        }
+
+        [[maybe_unused]] bool success =
+            this->writeBuffer_.Write(bytes, byteCount);
+
+        assert(success);
+
+        if (this->writeBuffer_.GetSize() >= this->writeHighWater_)
+        {
+            this->Flush();
+        }
+    }
+
+    /**
+     ** Send several objects with one sendmsg, so that they leave together,
+     ** in as few segments as possible.
+     **/
+    template<typename ... T>
+    void WriteMany(const T &... objects)
+    {
+        if (this->writeHighWater_ > 0)
+        {
+            (this->Write(&objects, sizeof(T)), ...);
+
+            return;
+        }
+
+        std::array<iovec, sizeof...(T)> buffers{
+            iovec{const_cast<T *>(&objects), sizeof(T)}...};
+
+        this->WriteVector(buffers);
+    }
+
+    /**
+     ** Send every buffer, in order, gathering as many as possible into each
+     ** sendmsg. The entries are advanced past the data as it is sent.
+     **/
+    void WriteVector(std::span<iovec> buffers)
+    {
+        // Buffered writes go first.
+        this->Flush();
+
+        while (!buffers.empty())
+        {
+            auto sentCount = this->SendVector(
+                buffers.first(std::min<size_t>(buffers.size(), IOV_MAX)),
+                0);
+
+            if (sentCount < 0)
             {
+                if (WouldBlock(errno))
+                {
+                    throw SocketError(
+                        std::make_error_code(std::errc::timed_out),
+                        "Socket timed out");
+                }
+
                 throw SocketError(
-                    std::make_error_code(std::errc::timed_out),
-                    "Socket timed out");
+                    SystemError(errno),
+                    "Failed to send data to socket");
+            }
+
+            // Skip the buffers that were sent completely, and advance into
+            // one that was sent partially.
+            auto remaining = static_cast<size_t>(sentCount);
+
+            while (!buffers.empty() && remaining >= buffers.front().iov_len)
+            {
+                remaining -= buffers.front().iov_len;
+                buffers = buffers.subspan(1);
             }
 
-            sentCount += *increment;
+            if (remaining > 0)
+            {
+                auto &partial = buffers.front();
+                partial.iov_base =
+                    static_cast<char *>(partial.iov_base) + remaining;
+                partial.iov_len -= remaining;
+            }
         }
     }
 
@@ -105,7 +374,7 @@ public:
     T Peek()
     {
         static_assert(
-            sizeof(T) <= BufferSize,
+            BufferSize == 0 || sizeof(T) <= BufferSize,
             "Increase the buffer size to receive larger objects.");
 
         T result;
@@ -137,21 +406,104 @@ private:
     template<size_t fillCount>
     void FillReadBuffer_()
     {
-        static_assert(fillCount <= BufferSize);
-        
+        static_assert(BufferSize == 0 || fillCount <= BufferSize);
+
+        this->FillReadBuffer_(fillCount, fillCount);
+    }
+
+    /**
+     ** Receive until at least fillCount bytes are buffered, asking for up to
+     ** requestCount (or for all of the free space, when opportunistic).
+     **/
+    void FillReadBuffer_(size_t fillCount, size_t requestCount)
+    {
+        if constexpr (BufferSize == 0)
+        {
+            if (fillCount > this->readBuffer_.GetCapacity())
+            {
+                throw SocketError(
+                    std::make_error_code(std::errc::no_buffer_space),
+                    "Increase the buffer size to receive larger objects.");
+            }
+        }
+
         while (this->readBuffer_.GetSize() < fillCount)
         {
-            this->DrainSocket_(fillCount - this->readBuffer_.GetSize());
+            if (this->isOpportunistic_)
+            {
+                this->DrainSocket_(this->readBuffer_.GetAvailable());
+            }
+            else
+            {
+                this->DrainSocket_(
+                    std::max(requestCount, fillCount)
+                        - this->readBuffer_.GetSize());
+            }
+        }
+    }
+
+    /**
+     ** Send the buffered bytes, then extra, gathering them into each sendmsg.
+     ** Bytes leave the buffer as they are sent, so a time out leaves the
+     ** rest buffered for the next Flush.
+     **/
+    void SendBuffered_(std::span<const uint8_t> extra, int flags)
+    {
+        while (!this->writeBuffer_.IsEmpty() || !extra.empty())
+        {
+            std::array<iovec, 3> buffers{};
+            size_t bufferCount = 0;
+
+            for (auto region: this->writeBuffer_.GetReadableRegions())
+            {
+                if (!region.empty())
+                {
+                    buffers[bufferCount++] = iovec{
+                        const_cast<uint8_t *>(region.data()),
+                        region.size()};
+                }
+            }
+
+            if (!extra.empty())
+            {
+                buffers[bufferCount++] = iovec{
+                    const_cast<uint8_t *>(extra.data()),
+                    extra.size()};
+            }
+
+            auto sentCount = this->SendVector(
+                std::span(buffers.data(), bufferCount),
+                flags);
+
+            if (sentCount < 0)
+            {
+                if (WouldBlock(errno))
+                {
+                    throw SocketError(
+                        std::make_error_code(std::errc::timed_out),
+                        "Socket timed out");
+                }
+
+                throw SocketError(
+                    SystemError(errno),
+                    "Failed to send data to socket");
+            }
+
+            auto sent = static_cast<size_t>(sentCount);
+            auto fromBuffer = std::min(sent, this->writeBuffer_.GetSize());
+            this->writeBuffer_.Remove(fromBuffer);
+            extra = extra.subspan(sent - fromBuffer);
         }
     }
 
     void DrainSocket_(size_t byteCount)
     {
-        AsPointer buffer(this->readBuffer_);
-        
-        auto bufferSize = buffer.GetWritableSize();
+        // The peer may be waiting for buffered writes before it replies.
+        this->Flush();
+
+        auto regions = this->readBuffer_.GetWritableRegions();
 
-        if (bufferSize == 0)
+        if (regions[0].empty())
         {
             // There is no more room in the read buffer.
             throw SocketError(
@@ -159,29 +511,46 @@ private:
                 "Cannot drain socket when read buffer is full.");
         }
 
-        size_t count = std::min(bufferSize, byteCount);
+        // When the free space wraps, fill both parts with one call.
+        auto firstCount = std::min(regions[0].size(), byteCount);
+        auto secondCount = std::min(regions[1].size(), byteCount - firstCount);
+
+        std::array<iovec, 2> buffers{
+            iovec{regions[0].data(), firstCount},
+            iovec{regions[1].data(), secondCount}};
 
-        std::optional<size_t> receivedCount =
-            this->ReceiveWait(buffer.Get(), count);
+        std::ptrdiff_t receivedCount = this->ReceiveVector(
+            std::span(buffers.data(), (secondCount > 0) ? 2 : 1),
+            0);
 
-        if (!receivedCount)
+        if (receivedCount < 0)
         {
+            if (WouldBlock(errno))
+            {
+                throw SocketError(
+                    std::make_error_code(std::errc::timed_out),
+                    "Socket timed out");
+            }
+
             throw SocketError(
-                std::make_error_code(std::errc::timed_out),
-                "Socket timed out");
+                SystemError(errno),
+                "Failed to receive data from socket");
         }
 
-        if (0 == *receivedCount)
+        if (0 == receivedCount)
         {
             // Remote disconnected
             throw SocketDisconnected();
         }
 
-        buffer.SetWriteCount(*receivedCount);
+        this->readBuffer_.CommitWrite(static_cast<size_t>(receivedCount));
     }
 
 private:
     CircularBuffer<uint8_t, BufferSize> readBuffer_;
+    CircularBuffer<uint8_t, BufferSize> writeBuffer_;
+    bool isOpportunistic_;
+    size_t writeHighWater_;
 };
 
 
@@ -0,0 +1,275 @@
+/**
+  * @file datagram_batch.h
+  *
+  * @brief Send or receive many datagrams per system call.
+  *
+  * ReceiveBatch owns a buffer for each datagram, and fills as many as have
+  * arrived with one recvmmsg. SendBatch queues datagrams that the caller
+  * owns, and sends them with as few sendmmsg calls as the kernel allows.
+  *
+  * Linux only (sendmmsg and recvmmsg).
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include <sys/socket.h>
+
+#include "jive/socket/address.h"
+#include "jive/socket/error.h"
+#include "jive/socket/socket.h"
+
+
+namespace jive
+{
+
+
+class ReceiveBatch
+{
+public:
+    ReceiveBatch(size_t datagramCount, size_t maximumByteCount)
+        :
+        buffer_(datagramCount * maximumByteCount),
+        senders_(datagramCount),
+        buffers_(datagramCount),
+        messages_(datagramCount),
+        maximumByteCount_(maximumByteCount),
+        count_(0)
+    {
+        for (size_t i = 0; i < datagramCount; ++i)
+        {
+            this->buffers_[i] = iovec{
+                this->buffer_.data() + i * maximumByteCount,
+                maximumByteCount};
+
+            auto &header = this->messages_[i].msg_hdr;
+            header.msg_name = &this->senders_[i];
+            header.msg_iov = &this->buffers_[i];
+            header.msg_iovlen = 1;
+        }
+    }
+
+    ReceiveBatch(const ReceiveBatch &) = delete;
+    ReceiveBatch & operator=(const ReceiveBatch &) = delete;
+
+    /**
+     ** Receive as many datagrams as have arrived, up to the batch size. By
+     ** default, only the first is waited for.
+     **
+     ** @return The number received, which is 0 when a non-blocking socket
+     ** has none.
+     **/
+    size_t Receive(const Socket &socket, int flags = MSG_WAITFORONE)
+    {
+        for (auto &message: this->messages_)
+        {
+            // The kernel replaces these with the actual lengths.
+            message.msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+            message.msg_hdr.msg_flags = 0;
+        }
+
+        int result = socket.ReceiveMany(this->messages_, flags);
+
+        if (result < 0)
+        {
+            this->count_ = 0;
+
+            if (WouldBlock(errno))
+            {
+                return 0;
+            }
+
+            throw SocketError(
+                SystemError(errno),
+                "Failed to receive datagrams");
+        }
+
+        this->count_ = static_cast<size_t>(result);
+
+        return this->count_;
+    }
+
+    /** @return The number of datagrams from the last Receive. **/
+    size_t GetCount() const
+    {
+        return this->count_;
+    }
+
+    size_t GetMaximumByteCount() const
+    {
+        return this->maximumByteCount_;
+    }
+
+    /**
+     ** @return The received bytes. A truncated datagram returns only what
+     ** fit, even when MSG_TRUNC asked Receive for its full length.
+     **/
+    std::span<const std::byte> GetData(size_t index) const
+    {
+        auto &message = this->GetMessage_(index);
+
+        return std::span<const std::byte>(
+            this->buffer_.data() + index * this->maximumByteCount_,
+            std::min(
+                static_cast<size_t>(message.msg_len),
+                this->maximumByteCount_));
+    }
+
+    Endpoint GetSender(size_t index) const
+    {
+        auto &message = this->GetMessage_(index);
+
+        return Endpoint(
+            reinterpret_cast<const struct sockaddr *>(&this->senders_[index]),
+            message.msg_hdr.msg_namelen);
+    }
+
+    /** @return true when the datagram was longer than its buffer. **/
+    bool IsTruncated(size_t index) const
+    {
+        return this->GetMessage_(index).msg_hdr.msg_flags & MSG_TRUNC;
+    }
+
+private:
+    /** Only the datagrams from the last Receive may be read. **/
+    const struct mmsghdr & GetMessage_(size_t index) const
+    {
+        if (index >= this->count_)
+        {
+            throw std::out_of_range("Datagram index out of range");
+        }
+
+        return this->messages_[index];
+    }
+
+    std::vector<std::byte> buffer_;
+    std::vector<struct sockaddr_storage> senders_;
+    std::vector<iovec> buffers_;
+    std::vector<struct mmsghdr> messages_;
+    size_t maximumByteCount_;
+    size_t count_;
+};
+
+
+class SendBatch
+{
+public:
+    SendBatch()
+        :
+        datagrams_()
+    {
+
+    }
+
+    /**
+     ** Queue a datagram. Its data must remain valid until it is sent. The
+     ** destination may be left out on a connected socket.
+     **/
+    void Add(
+        std::span<const std::byte> data,
+        std::optional<Endpoint> destination = {})
+    {
+        this->datagrams_.push_back({data, std::move(destination)});
+    }
+
+    size_t GetCount() const
+    {
+        return this->datagrams_.size();
+    }
+
+    void Clear()
+    {
+        this->datagrams_.clear();
+    }
+
+    /**
+     ** Send the queued datagrams, in order.
+     **
+     ** @return The number sent. When a non-blocking socket would block, the
+     ** rest remain queued.
+     **/
+    size_t Send(const Socket &socket, int flags = 0)
+    {
+        std::vector<iovec> buffers(this->datagrams_.size());
+        std::vector<struct mmsghdr> messages(this->datagrams_.size());
+
+        for (size_t i = 0; i < this->datagrams_.size(); ++i)
+        {
+            auto &datagram = this->datagrams_[i];
+
+            buffers[i] = iovec{
+                const_cast<std::byte *>(datagram.data.data()),
+                datagram.data.size()};
+
+            auto &header = messages[i].msg_hdr;
+            header.msg_iov = &buffers[i];
+            header.msg_iovlen = 1;
+
+            if (datagram.destination)
+            {
+                header.msg_name = const_cast<struct sockaddr *>(
+                    datagram.destination->GetNative());
+
+                header.msg_namelen = datagram.destination->GetLength();
+            }
+        }
+
+        size_t sentCount = 0;
+
+        while (sentCount < messages.size())
+        {
+            int result = socket.SendMany(
+                std::span(messages).subspan(sentCount),
+                flags);
+
+            if (result < 0)
+            {
+                if (WouldBlock(errno))
+                {
+                    break;
+                }
+
+                this->Erase_(sentCount);
+
+                throw SocketError(
+                    SystemError(errno),
+                    "Failed to send datagrams");
+            }
+
+            sentCount += static_cast<size_t>(result);
+        }
+
+        this->Erase_(sentCount);
+
+        return sentCount;
+    }
+
+private:
+    struct Datagram_
+    {
+        std::span<const std::byte> data;
+        std::optional<Endpoint> destination;
+    };
+
+    void Erase_(size_t count)
+    {
+        this->datagrams_.erase(
+            this->datagrams_.begin(),
+            this->datagrams_.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+
+private:
+    std::vector<Datagram_> datagrams_;
+};
+
+
+} // end namespace jive
@@ -0,0 +1,373 @@
+/**
+  * @file epoll_engine.h
+  *
+  * @brief An IoEngine built on edge-triggered epoll and non-blocking calls.
+  *
+  * Requests are queued, and performed by the next RunOnce with
+  * MSG_DONTWAIT, so the sockets may be left in blocking mode. Received data
+  * is copied through one internal buffer.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "jive/socket/error.h"
+#include "jive/socket/io_engine.h"
+
+
+namespace jive
+{
+
+
+class EpollEngine: public IoEngine
+{
+public:
+    static constexpr size_t defaultReceiveByteCount = 64 * 1024;
+    static constexpr int defaultEventCount = 256;
+
+    explicit EpollEngine(
+        size_t receiveByteCount = defaultReceiveByteCount,
+        int eventCount = defaultEventCount)
+        :
+        epollHandle_(epoll_create1(EPOLL_CLOEXEC)),
+        events_(static_cast<size_t>(eventCount)),
+        receiveBuffer_(receiveByteCount),
+        connections_(),
+        removed_(),
+        ready_()
+    {
+        if (this->epollHandle_ == -1)
+        {
+            throw SocketError(SystemError(errno), "Failed to create epoll");
+        }
+    }
+
+    ~EpollEngine() override
+    {
+        close(this->epollHandle_);
+    }
+
+    EpollEngine(const EpollEngine &) = delete;
+    EpollEngine & operator=(const EpollEngine &) = delete;
+
+    const char * GetName() const override
+    {
+        return "epoll";
+    }
+
+    void Receive(const Socket &socket, ReceiveCallback onReceive) override
+    {
+        auto &connection = this->GetConnection_(socket.GetHandle());
+        connection.onReceive = std::move(onReceive);
+
+        // Data may have arrived before there was a callback to take it.
+        this->MarkReady_(connection);
+    }
+
+    void Send(
+        const Socket &socket,
+        std::span<const std::byte> data,
+        SendCallback onSent) override
+    {
+        auto &connection = this->GetConnection_(socket.GetHandle());
+        connection.sends.push_back({data, std::move(onSent)});
+        this->MarkReady_(connection);
+    }
+
+    void Remove(const Socket &socket) override
+    {
+        auto found = this->connections_.find(socket.GetHandle());
+
+        if (found == this->connections_.end())
+        {
+            return;
+        }
+
+        epoll_ctl(
+            this->epollHandle_,
+            EPOLL_CTL_DEL,
+            found->first,
+            nullptr);
+
+        // Callbacks may be running, and unsent data is reported by the next
+        // RunOnce.
+        found->second->isRemoved = true;
+        this->removed_.push_back(std::move(found->second));
+        this->connections_.erase(found);
+    }
+
+    size_t RunOnce(std::optional<TimeValue> timeOut = {}) override
+    {
+        int waitMilliseconds = -1;
+
+        if (!this->ready_.empty() || !this->removed_.empty())
+        {
+            waitMilliseconds = 0;
+        }
+        else if (timeOut)
+        {
+            waitMilliseconds = static_cast<int>(
+                (timeOut->GetAsMicroseconds<int64_t>() + 999) / 1000);
+        }
+
+        int eventCount = epoll_wait(
+            this->epollHandle_,
+            this->events_.data(),
+            static_cast<int>(this->events_.size()),
+            waitMilliseconds);
+
+        if (eventCount == -1)
+        {
+            if (errno != EINTR)
+            {
+                throw SocketError(
+                    SystemError(errno),
+                    "Failed to wait for events");
+            }
+
+            eventCount = 0;
+        }
+
+        for (int i = 0; i < eventCount; ++i)
+        {
+            const auto &event = this->events_[static_cast<size_t>(i)];
+            auto found = this->connections_.find(event.data.fd);
+
+            if (found == this->connections_.end())
+            {
+                continue;
+            }
+
+            auto &connection = *found->second;
+
+            if (event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            {
+                connection.isReadable = true;
+            }
+
+            if (event.events & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+            {
+                connection.isWritable = true;
+            }
+
+            this->MarkReady_(connection);
+        }
+
+        size_t callbackCount = 0;
+        std::vector<int> ready;
+        std::swap(ready, this->ready_);
+
+        for (auto handle: ready)
+        {
+            auto found = this->connections_.find(handle);
+
+            if (found == this->connections_.end())
+            {
+                continue;
+            }
+
+            // Removal moves the connection to removed_, so it remains valid
+            // while its callbacks run.
+            auto &connection = *found->second;
+            connection.isQueued = false;
+
+            callbackCount += this->Write_(connection);
+            callbackCount += this->Read_(connection);
+        }
+
+        std::vector<std::unique_ptr<Connection_>> removed;
+        std::swap(removed, this->removed_);
+
+        for (auto &connection: removed)
+        {
+            callbackCount += this->CancelSends_(*connection);
+        }
+
+        return callbackCount;
+    }
+
+private:
+    struct PendingSend_
+    {
+        std::span<const std::byte> data;
+        SendCallback onSent;
+    };
+
+    struct Connection_
+    {
+        int handle = -1;
+        ReceiveCallback onReceive;
+        std::deque<PendingSend_> sends;
+        bool isReadable = false;
+        bool isWritable = true;
+        bool isQueued = false;
+        bool isRemoved = false;
+    };
+
+    Connection_ & GetConnection_(int handle)
+    {
+        auto found = this->connections_.find(handle);
+
+        if (found != this->connections_.end())
+        {
+            return *found->second;
+        }
+
+        auto connection = std::make_unique<Connection_>();
+        connection->handle = handle;
+
+        // Readiness is unknown, so the first pass tries both directions.
+        connection->isReadable = true;
+
+        struct epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.fd = handle;
+
+        if (-1 == epoll_ctl(this->epollHandle_, EPOLL_CTL_ADD, handle, &event))
+        {
+            throw SocketError(SystemError(errno), "Failed to watch socket");
+        }
+
+        return *this->connections_.emplace(handle, std::move(connection))
+            .first->second;
+    }
+
+    void MarkReady_(Connection_ &connection)
+    {
+        if (!connection.isQueued)
+        {
+            connection.isQueued = true;
+            this->ready_.push_back(connection.handle);
+        }
+    }
+
+    size_t Write_(Connection_ &connection)
+    {
+        size_t callbackCount = 0;
+
+        while (connection.isWritable
+            && !connection.isRemoved
+            && !connection.sends.empty())
+        {
+            auto &pending = connection.sends.front();
+
+            auto sentCount = send(
+                connection.handle,
+                pending.data.data(),
+                pending.data.size(),
+                MSG_DONTWAIT | MSG_NOSIGNAL);
+
+            std::error_code error;
+
+            if (sentCount < 0)
+            {
+                if (WouldBlock(errno))
+                {
+                    connection.isWritable = false;
+
+                    break;
+                }
+
+                error = SystemError(errno);
+            }
+            else
+            {
+                pending.data = pending.data.subspan(
+                    static_cast<size_t>(sentCount));
+
+                if (!pending.data.empty())
+                {
+                    continue;
+                }
+            }
+
+            auto onSent = std::move(pending.onSent);
+            connection.sends.pop_front();
+            onSent(error);
+            ++callbackCount;
+        }
+
+        return callbackCount;
+    }
+
+    size_t Read_(Connection_ &connection)
+    {
+        size_t callbackCount = 0;
+
+        while (connection.isReadable
+            && !connection.isRemoved
+            && connection.onReceive)
+        {
+            auto receivedCount = recv(
+                connection.handle,
+                this->receiveBuffer_.data(),
+                this->receiveBuffer_.size(),
+                MSG_DONTWAIT);
+
+            if (receivedCount < 0 && WouldBlock(errno))
+            {
+                connection.isReadable = false;
+
+                break;
+            }
+
+            ++callbackCount;
+
+            if (receivedCount <= 0)
+            {
+                // Closed, or failed. Keep the callback alive while it runs.
+                auto onReceive = std::move(connection.onReceive);
+                connection.onReceive = {};
+                onReceive({});
+
+                break;
+            }
+
+            connection.onReceive(
+                std::span<const std::byte>(
+                    this->receiveBuffer_.data(),
+                    static_cast<size_t>(receivedCount)));
+        }
+
+        return callbackCount;
+    }
+
+    size_t CancelSends_(Connection_ &connection)
+    {
+        size_t callbackCount = 0;
+
+        while (!connection.sends.empty())
+        {
+            auto onSent = std::move(connection.sends.front().onSent);
+            connection.sends.pop_front();
+            onSent(std::make_error_code(std::errc::operation_canceled));
+            ++callbackCount;
+        }
+
+        return callbackCount;
+    }
+
+private:
+    int epollHandle_;
+    std::vector<struct epoll_event> events_;
+    std::vector<std::byte> receiveBuffer_;
+    std::unordered_map<int, std::unique_ptr<Connection_>> connections_;
+    std::vector<std::unique_ptr<Connection_>> removed_;
+    std::vector<int> ready_;
+};
+
+
+} // end namespace jive
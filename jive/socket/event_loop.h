@@ -0,0 +1,792 @@
+/**
+  * @file event_loop.h
+  *
+  * @brief An edge-triggered epoll reactor for non-blocking sockets.
+  *
+  * EventLoop owns the sockets added to it, and calls their handlers from
+  * RunOnce or Run when they become readable or writable. Readiness is
+  * edge-triggered: a handler is called once per change, so it must read (or
+  * write) until the socket would block, or it will not be called again.
+  *
+  * Timers, posted callbacks, and the completion of work offloaded to the
+  * ThreadPool all run on the thread that calls Run, so handlers never need
+  * locks. Post, Stop, and Offload's work are the only parts used from other
+  * threads.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "jive/scope_flag.h"
+#include "jive/thread_pool.h"
+#include "jive/time_value.h"
+#include "jive/socket/error.h"
+#include "jive/socket/socket.h"
+
+
+namespace jive
+{
+
+
+class EventLoop
+{
+public:
+    using Callback = std::function<void()>;
+    using SocketCallback = std::function<void(Socket &)>;
+    using AcceptCallback = std::function<void(Socket &&)>;
+    using TimerId = uint64_t;
+
+    struct Handlers
+    {
+        // Called when data, a disconnection, or an error is pending.
+        SocketCallback onReadable;
+
+        // When set, called when the send buffer has room again.
+        SocketCallback onWritable;
+    };
+
+    static constexpr int defaultEventCount = 256;
+
+    // How long a listener waits to accept again after running out of
+    // descriptors or memory.
+    static constexpr auto acceptRetryDelay = std::chrono::milliseconds(100);
+
+    explicit EventLoop(int eventCount = defaultEventCount)
+        :
+        epollHandle_(epoll_create1(EPOLL_CLOEXEC)),
+        wakeHandle_(-1),
+        events_(static_cast<size_t>(eventCount)),
+        entries_(),
+        removed_(),
+        isDispatching_(false),
+        timers_(),
+        timerQueue_(),
+        nextTimerId_(1),
+        postMutex_(),
+        posted_(),
+        offloads_(),
+        nextOffloadId_(0),
+        stopRequested_(false)
+    {
+        if (this->epollHandle_ == -1)
+        {
+            throw SocketError(SystemError(errno), "Failed to create epoll");
+        }
+
+        this->wakeHandle_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (this->wakeHandle_ == -1)
+        {
+            auto error = errno;
+            close(this->epollHandle_);
+
+            throw SocketError(SystemError(error), "Failed to create eventfd");
+        }
+
+        // The wake handle is the only registration without an entry.
+        struct epoll_event event{};
+        event.events = EPOLLIN | EPOLLET;
+        event.data.ptr = nullptr;
+
+        if (-1 == epoll_ctl(
+                this->epollHandle_,
+                EPOLL_CTL_ADD,
+                this->wakeHandle_,
+                &event))
+        {
+            auto error = errno;
+            close(this->wakeHandle_);
+            close(this->epollHandle_);
+
+            throw SocketError(SystemError(error), "Failed to watch eventfd");
+        }
+    }
+
+    ~EventLoop()
+    {
+        // Offloaded jobs post back to this loop, so they must finish first.
+        for (auto &offload: this->offloads_)
+        {
+            try
+            {
+                offload.second.Wait();
+            }
+            catch (...)
+            {
+
+            }
+        }
+
+        close(this->wakeHandle_);
+        close(this->epollHandle_);
+    }
+
+    EventLoop(const EventLoop &) = delete;
+    EventLoop & operator=(const EventLoop &) = delete;
+
+    /**
+     ** Take ownership of socket, make it non-blocking, and call handlers
+     ** when it is ready.
+     **/
+    void Add(Socket &&socket, Handlers handlers)
+    {
+        uint32_t events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+
+        if (handlers.onWritable)
+        {
+            events |= EPOLLOUT;
+        }
+
+        socket.SetNonBlocking(true);
+
+        this->Register_(
+            std::make_unique<Entry_>(
+                std::move(socket),
+                std::move(handlers)),
+            events);
+    }
+
+    /**
+     ** Take ownership of a bound socket, start listening, and pass each new
+     ** connection to onAccept. Use Add to watch the connection.
+     **
+     ** Connections that fail before they are accepted are skipped. When the
+     ** process is out of descriptors or memory, accepting resumes after
+     ** acceptRetryDelay.
+     **/
+    void Listen(Socket &&listener, AcceptCallback onAccept)
+    {
+        listener.Listen();
+        listener.SetNonBlocking(true);
+
+        Handlers handlers{
+            [this, onAccept = std::move(onAccept)](Socket &socket)
+            {
+                this->AcceptAll_(socket, onAccept);
+            },
+            {}};
+
+        this->Register_(
+            std::make_unique<Entry_>(std::move(listener), std::move(handlers)),
+            EPOLLIN | EPOLLET);
+    }
+
+    /**
+     ** Stop watching the socket and close it. It is safe to remove a socket
+     ** from its own handler.
+     **
+     ** @return false when handle is not watched by this loop.
+     **/
+    bool Remove(int handle)
+    {
+        auto found = this->entries_.find(handle);
+
+        if (found == this->entries_.end())
+        {
+            return false;
+        }
+
+        epoll_ctl(this->epollHandle_, EPOLL_CTL_DEL, handle, nullptr);
+
+        if (this->isDispatching_)
+        {
+            // Events for this entry may still be pending in this batch, and
+            // its handler may be running. Keep the socket open (so its handle
+            // is not reused) until the batch is finished.
+            found->second->isRemoved = true;
+            this->removed_.push_back(std::move(found->second));
+        }
+
+        this->entries_.erase(found);
+
+        return true;
+    }
+
+    bool Contains(int handle) const
+    {
+        return this->entries_.count(handle) != 0;
+    }
+
+    /** @return The number of sockets, including listeners. **/
+    size_t GetCount() const
+    {
+        return this->entries_.size();
+    }
+
+    /** Call callback once, delay from now. **/
+    TimerId AddTimer(const TimeValue &delay, Callback callback)
+    {
+        return this->AddTimer_(
+            TimeValue::GetNow() + delay,
+            TimeValue{},
+            std::move(callback));
+    }
+
+    /** Call callback every interval until the timer is cancelled. **/
+    TimerId AddRepeatingTimer(const TimeValue &interval, Callback callback)
+    {
+        if (interval <= TimeValue{})
+        {
+            throw std::invalid_argument("Timer interval must be positive");
+        }
+
+        return this->AddTimer_(
+            TimeValue::GetNow() + interval,
+            interval,
+            std::move(callback));
+    }
+
+    /** @return false when the timer has already fired or was cancelled. **/
+    bool CancelTimer(TimerId timerId)
+    {
+        // The queue entry is discarded when it reaches the front.
+        return this->timers_.erase(timerId) != 0;
+    }
+
+    /** Call callback on the loop's thread. May be called from any thread. **/
+    void Post(Callback callback)
+    {
+        {
+            std::lock_guard lock(this->postMutex_);
+            this->posted_.push_back(std::move(callback));
+        }
+
+        this->Wake_();
+    }
+
+    /**
+     ** Run work on the ThreadPool, then pass its result to done on the
+     ** loop's thread. An exception thrown by work is rethrown from RunOnce.
+     **
+     ** Call from the loop's thread.
+     **/
+    template<typename Work, typename Done>
+    void Offload(Work work, Done done)
+    {
+        using Result = std::invoke_result_t<Work &>;
+
+        auto offloadId = this->nextOffloadId_++;
+
+        auto job =
+            [this, offloadId, work = std::move(work), done = std::move(done)]
+            () mutable
+            {
+                try
+                {
+                    if constexpr (std::is_void_v<Result>)
+                    {
+                        work();
+
+                        this->Post(
+                            [this, offloadId, done]() mutable
+                            {
+                                this->FinishOffload_(offloadId);
+                                done();
+                            });
+                    }
+                    else
+                    {
+                        this->Post(
+                            [this, offloadId, done, result = work()]
+                            () mutable
+                            {
+                                this->FinishOffload_(offloadId);
+                                done(std::move(result));
+                            });
+                    }
+                }
+                catch (...)
+                {
+                    this->Post(
+                        [this, offloadId, error = std::current_exception()]()
+                        {
+                            this->FinishOffload_(offloadId);
+                            std::rethrow_exception(error);
+                        });
+                }
+            };
+
+        // The completion cannot run before the sentry is stored, because
+        // both happen on this thread.
+        this->offloads_.emplace(
+            offloadId,
+            GetThreadPool()->AddJob(std::move(job)));
+    }
+
+    /**
+     ** Wait for events, timers, or posted callbacks, and dispatch them.
+     **
+     ** @param timeOut The longest time to wait. Wait indefinitely when empty.
+     ** @return The number of socket events dispatched.
+     **/
+    size_t RunOnce(std::optional<TimeValue> timeOut = {})
+    {
+        int eventCount = epoll_wait(
+            this->epollHandle_,
+            this->events_.data(),
+            static_cast<int>(this->events_.size()),
+            this->GetWaitMilliseconds_(timeOut));
+
+        if (eventCount == -1)
+        {
+            if (errno != EINTR)
+            {
+                throw SocketError(
+                    SystemError(errno),
+                    "Failed to wait for events");
+            }
+
+            eventCount = 0;
+        }
+
+        size_t dispatchedCount = 0;
+
+        // Readiness is edge-triggered, so every event in the batch must be
+        // dispatched, even after a handler throws. The first exception
+        // leaves RunOnce once the batch is finished.
+        std::exception_ptr error;
+
+        {
+            ScopeFlag dispatching(this->isDispatching_);
+
+            for (int i = 0; i < eventCount; ++i)
+            {
+                const auto &event = this->events_[static_cast<size_t>(i)];
+                auto entry = static_cast<Entry_ *>(event.data.ptr);
+
+                if (!entry)
+                {
+                    this->ClearWake_();
+                    continue;
+                }
+
+                dispatchedCount +=
+                    this->Dispatch_(*entry, event.events, error);
+            }
+
+            KeepFirstError_(error, [this]() { this->RunPosted_(); });
+            KeepFirstError_(error, [this]() { this->RunTimers_(); });
+        }
+
+        this->removed_.clear();
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+
+        return dispatchedCount;
+    }
+
+    /** Dispatch events until Stop is called. **/
+    void Run()
+    {
+        while (!this->stopRequested_.exchange(false))
+        {
+            this->RunOnce();
+        }
+    }
+
+    /** Return from Run. May be called from any thread. **/
+    void Stop()
+    {
+        this->stopRequested_ = true;
+        this->Wake_();
+    }
+
+private:
+    struct Entry_
+    {
+        Entry_(Socket &&socket_, Handlers &&handlers_)
+            :
+            socket(std::move(socket_)),
+            handlers(std::move(handlers_)),
+            isRemoved(false)
+        {
+
+        }
+
+        Socket socket;
+        Handlers handlers;
+        bool isRemoved;
+    };
+
+    struct Timer_
+    {
+        Callback callback;
+        TimeValue interval;
+    };
+
+    using Deadline_ = std::pair<TimeValue, TimerId>;
+
+    void Register_(std::unique_ptr<Entry_> entry, uint32_t events)
+    {
+        auto handle = entry->socket.GetHandle();
+
+        struct epoll_event event{};
+        event.events = events;
+        event.data.ptr = entry.get();
+
+        if (-1 == epoll_ctl(this->epollHandle_, EPOLL_CTL_ADD, handle, &event))
+        {
+            throw SocketError(SystemError(errno), "Failed to watch socket");
+        }
+
+        this->entries_.emplace(handle, std::move(entry));
+    }
+
+    /** Call function, keeping its exception in error unless one is there. **/
+    template<typename Function>
+    static void KeepFirstError_(std::exception_ptr &error, Function &&function)
+    {
+        try
+        {
+            function();
+        }
+        catch (...)
+        {
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    size_t Dispatch_(Entry_ &entry, uint32_t events, std::exception_ptr &error)
+    {
+        size_t dispatchedCount = 0;
+
+        // Errors and hang-ups are reported to the read handler, where recv
+        // returns them.
+        if (!entry.isRemoved
+            && (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            && entry.handlers.onReadable)
+        {
+            ++dispatchedCount;
+
+            KeepFirstError_(
+                error,
+                [&entry]() { entry.handlers.onReadable(entry.socket); });
+        }
+
+        if (!entry.isRemoved
+            && (events & EPOLLOUT)
+            && entry.handlers.onWritable)
+        {
+            ++dispatchedCount;
+
+            KeepFirstError_(
+                error,
+                [&entry]() { entry.handlers.onWritable(entry.socket); });
+        }
+
+        return dispatchedCount;
+    }
+
+    static bool IsOutOfResources_(int errorNumber)
+    {
+        return errorNumber == EMFILE
+            || errorNumber == ENFILE
+            || errorNumber == ENOBUFS
+            || errorNumber == ENOMEM;
+    }
+
+    /**
+     ** Accept until the backlog is empty, since the listener is only
+     ** reported again when another connection arrives.
+     **/
+    void AcceptAll_(Socket &listener, const AcceptCallback &onAccept)
+    {
+        std::exception_ptr error;
+
+        while (true)
+        {
+            std::optional<Socket> connection;
+
+            try
+            {
+                connection = listener.AcceptNoWait();
+            }
+            catch (const SocketError &acceptError)
+            {
+                auto errorNumber = acceptError.code().value();
+
+                if (errorNumber == ECONNABORTED
+                    || errorNumber == EPROTO
+                    || errorNumber == EINTR)
+                {
+                    // Only this connection failed.
+                    continue;
+                }
+
+                if (!IsOutOfResources_(errorNumber))
+                {
+                    throw;
+                }
+
+                // The backlog is still waiting, so try again later.
+                auto handle = listener.GetHandle();
+
+                this->AddTimer(
+                    TimeValue(acceptRetryDelay),
+                    [this, handle]()
+                    {
+                        auto found = this->entries_.find(handle);
+
+                        if (found != this->entries_.end())
+                        {
+                            auto &entry = *found->second;
+                            entry.handlers.onReadable(entry.socket);
+                        }
+                    });
+
+                break;
+            }
+
+            if (!connection)
+            {
+                break;
+            }
+
+            // One failed connection does not strand the rest of the backlog.
+            KeepFirstError_(
+                error,
+                [&]() { onAccept(std::move(*connection)); });
+        }
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    TimerId AddTimer_(
+        const TimeValue &deadline,
+        const TimeValue &interval,
+        Callback callback)
+    {
+        auto timerId = this->nextTimerId_++;
+        this->timers_.emplace(timerId, Timer_{std::move(callback), interval});
+        this->timerQueue_.emplace(deadline, timerId);
+
+        return timerId;
+    }
+
+    void RunTimers_()
+    {
+        auto now = TimeValue::GetNow();
+
+        while (!this->timerQueue_.empty()
+            && this->timerQueue_.top().first <= now)
+        {
+            auto [deadline, timerId] = this->timerQueue_.top();
+            this->timerQueue_.pop();
+
+            auto found = this->timers_.find(timerId);
+
+            if (found == this->timers_.end())
+            {
+                // Cancelled
+                continue;
+            }
+
+            // The callback may cancel its own timer, so it is moved out of
+            // the map while it runs.
+            auto callback = std::move(found->second.callback);
+            auto interval = found->second.interval;
+
+            if (interval == TimeValue{})
+            {
+                this->timers_.erase(found);
+                callback();
+
+                continue;
+            }
+
+            // A repeating timer that throws keeps its callback and its
+            // schedule, and the exception leaves RunOnce after both.
+            std::exception_ptr error;
+
+            try
+            {
+                callback();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            found = this->timers_.find(timerId);
+
+            if (found != this->timers_.end())
+            {
+                found->second.callback = std::move(callback);
+
+                auto next = deadline + interval;
+
+                if (next <= now)
+                {
+                    // Fell behind. Skip the missed intervals.
+                    next = now + interval;
+                }
+
+                this->timerQueue_.emplace(next, timerId);
+            }
+
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    void RunPosted_()
+    {
+        std::vector<Callback> posted;
+
+        {
+            std::lock_guard lock(this->postMutex_);
+            std::swap(posted, this->posted_);
+        }
+
+        auto callback = posted.begin();
+
+        for (; callback != posted.end(); ++callback)
+        {
+            try
+            {
+                (*callback)();
+            }
+            catch (...)
+            {
+                // Requeue the callbacks that have not run ahead of any posted
+                // since, so that the next RunOnce resumes with them.
+                std::lock_guard lock(this->postMutex_);
+
+                this->posted_.insert(
+                    this->posted_.begin(),
+                    std::make_move_iterator(std::next(callback)),
+                    std::make_move_iterator(posted.end()));
+
+                throw;
+            }
+        }
+    }
+
+    void FinishOffload_(size_t offloadId)
+    {
+        auto node = this->offloads_.extract(offloadId);
+        assert(!node.empty());
+
+        // The job has posted its result, and is only signalling completion.
+        node.mapped().Wait();
+    }
+
+    int GetWaitMilliseconds_(const std::optional<TimeValue> &timeOut)
+    {
+        {
+            std::lock_guard lock(this->postMutex_);
+
+            if (!this->posted_.empty())
+            {
+                return 0;
+            }
+        }
+
+        std::optional<TimeValue> wait = timeOut;
+
+        if (!this->timerQueue_.empty())
+        {
+            auto untilTimer =
+                this->timerQueue_.top().first - TimeValue::GetNow();
+
+            if (!wait || untilTimer < *wait)
+            {
+                wait = untilTimer;
+            }
+        }
+
+        if (!wait)
+        {
+            return -1;
+        }
+
+        auto microseconds = wait->GetAsMicroseconds<int64_t>();
+
+        if (microseconds <= 0)
+        {
+            return 0;
+        }
+
+        // Round up, so timers are not polled early in a busy loop.
+        auto milliseconds = (microseconds + 999) / 1000;
+
+        return static_cast<int>(
+            std::min<int64_t>(milliseconds, std::numeric_limits<int>::max()));
+    }
+
+    void Wake_()
+    {
+        uint64_t one = 1;
+        [[maybe_unused]] auto written = write(this->wakeHandle_, &one, 8);
+    }
+
+    void ClearWake_()
+    {
+        uint64_t count;
+        [[maybe_unused]] auto readCount = read(this->wakeHandle_, &count, 8);
+    }
+
+private:
+    int epollHandle_;
+    int wakeHandle_;
+    std::vector<struct epoll_event> events_;
+    std::unordered_map<int, std::unique_ptr<Entry_>> entries_;
+    std::vector<std::unique_ptr<Entry_>> removed_;
+    bool isDispatching_;
+
+    std::unordered_map<TimerId, Timer_> timers_;
+
+    std::priority_queue<
+        Deadline_,
+        std::vector<Deadline_>,
+        std::greater<Deadline_>> timerQueue_;
+
+    TimerId nextTimerId_;
+
+    std::mutex postMutex_;
+    std::vector<Callback> posted_;
+
+    std::unordered_map<size_t, Sentry> offloads_;
+    size_t nextOffloadId_;
+
+    std::atomic_bool stopRequested_;
+};
+
+
+} // end namespace jive
@@ -0,0 +1,333 @@
+/**
+  * @file framed_channel.h
+  *
+  * @brief Variable-size messages over a stream socket.
+  *
+  * Each frame is a big-endian uint32_t payload length, then the payload.
+  * Received data goes into a MirroredBuffer, so every complete frame is one
+  * contiguous span inside it, even when it wraps around the end, and is
+  * delivered without copying.
+  *
+  * ReadFrame waits for the next frame on a blocking socket. Dispatch suits
+  * a non-blocking socket in an EventLoop handler: it receives until the
+  * socket would block, and delivers every frame that completes.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <sys/uio.h>
+
+#include "jive/create_exception.h"
+#include "jive/endian_tools.h"
+#include "jive/mirrored_buffer.h"
+#include "jive/socket/error.h"
+#include "jive/socket/socket.h"
+
+
+namespace jive
+{
+
+
+CREATE_EXCEPTION(FrameError, std::runtime_error);
+
+
+class FramedChannel
+{
+public:
+    using Header = uint32_t;
+
+    static constexpr size_t headerByteCount = sizeof(Header);
+    static constexpr size_t defaultMaximumFrameSize = 64 * 1024;
+
+    /**
+     ** @param socket Must outlive the channel.
+     ** @param maximumFrameSize The largest payload sent or accepted. The
+     ** receive buffer holds at least one frame of this size.
+     **/
+    explicit FramedChannel(
+        Socket &socket,
+        size_t maximumFrameSize = defaultMaximumFrameSize)
+        :
+        socket_(socket),
+        readBuffer_(CheckFrameSize_(maximumFrameSize) + headerByteCount),
+        maximumFrameSize_(maximumFrameSize),
+        consumedCount_(0),
+        isClosed_(false)
+    {
+
+    }
+
+    FramedChannel(const FramedChannel &) = delete;
+    FramedChannel & operator=(const FramedChannel &) = delete;
+
+    size_t GetMaximumFrameSize() const
+    {
+        return this->maximumFrameSize_;
+    }
+
+    /** @return true once the peer has closed the connection. **/
+    bool IsClosed() const
+    {
+        return this->isClosed_;
+    }
+
+    /**
+     ** Take the next frame that has already been received, without
+     ** waiting. It remains valid until the next read from this channel.
+     **/
+    std::optional<std::span<const std::byte>> NextFrame()
+    {
+        this->Release_();
+
+        auto readable = this->readBuffer_.GetReadable();
+
+        if (readable.size() < headerByteCount)
+        {
+            return {};
+        }
+
+        Header header;
+        std::memcpy(&header, readable.data(), headerByteCount);
+        size_t frameSize = BigEndianToHost(header);
+
+        if (frameSize > this->maximumFrameSize_)
+        {
+            throw FrameError(
+                "Frame of " + std::to_string(frameSize)
+                + " bytes exceeds the maximum of "
+                + std::to_string(this->maximumFrameSize_));
+        }
+
+        if (readable.size() - headerByteCount < frameSize)
+        {
+            return {};
+        }
+
+        this->consumedCount_ = headerByteCount + frameSize;
+
+        return readable.subspan(headerByteCount, frameSize);
+    }
+
+    /**
+     ** Wait for the next frame, on a blocking socket. It remains valid until
+     ** the next read from this channel.
+     **/
+    std::span<const std::byte> ReadFrame()
+    {
+        while (true)
+        {
+            if (auto frame = this->NextFrame())
+            {
+                return *frame;
+            }
+
+            if (this->isClosed_)
+            {
+                throw SocketDisconnected("Peer closed between frames");
+            }
+
+            if (!this->Receive_() && !this->isClosed_)
+            {
+                throw SocketError(
+                    std::make_error_code(std::errc::timed_out),
+                    "Socket timed out");
+            }
+        }
+    }
+
+    /**
+     ** Receive until the socket would block, and pass each complete frame
+     ** to onFrame. Each frame is valid only during its call. Use with
+     ** non-blocking sockets, then check IsClosed.
+     **
+     ** @return The number of frames dispatched.
+     **/
+    template<typename OnFrame>
+    size_t Dispatch(OnFrame &&onFrame)
+    {
+        size_t frameCount = 0;
+
+        do
+        {
+            while (auto frame = this->NextFrame())
+            {
+                onFrame(*frame);
+                ++frameCount;
+            }
+        }
+        while (this->Receive_());
+
+        return frameCount;
+    }
+
+    /**
+     ** Send payload as one frame. On a non-blocking socket, this waits for
+     ** room to send all of it.
+     **/
+    void WriteFrame(std::span<const std::byte> payload)
+    {
+        this->WriteFrames(std::span(&payload, 1));
+    }
+
+    /** Send several frames, gathering them into as few sends as possible. **/
+    void WriteFrames(std::span<const std::span<const std::byte>> payloads)
+    {
+        std::vector<Header> headers(payloads.size());
+        std::vector<iovec> buffers;
+        buffers.reserve(2 * payloads.size());
+
+        for (size_t i = 0; i < payloads.size(); ++i)
+        {
+            auto payload = payloads[i];
+
+            if (payload.size() > this->maximumFrameSize_)
+            {
+                throw FrameError(
+                    "Frame of " + std::to_string(payload.size())
+                    + " bytes exceeds the maximum of "
+                    + std::to_string(this->maximumFrameSize_));
+            }
+
+            headers[i] = HostToBigEndian(static_cast<Header>(payload.size()));
+            buffers.push_back(iovec{&headers[i], headerByteCount});
+
+            if (!payload.empty())
+            {
+                buffers.push_back(
+                    iovec{
+                        const_cast<std::byte *>(payload.data()),
+                        payload.size()});
+            }
+        }
+
+        this->SendAll_(buffers);
+    }
+
+private:
+    static size_t CheckFrameSize_(size_t maximumFrameSize)
+    {
+        if (maximumFrameSize > std::numeric_limits<Header>::max())
+        {
+            throw std::invalid_argument(
+                "The maximum frame size must fit in the header");
+        }
+
+        return maximumFrameSize;
+    }
+
+    void Release_()
+    {
+        this->readBuffer_.Remove(this->consumedCount_);
+        this->consumedCount_ = 0;
+    }
+
+    /** @return false when nothing was received. **/
+    bool Receive_()
+    {
+        if (this->isClosed_)
+        {
+            return false;
+        }
+
+        // A partial frame always leaves room, because the buffer holds the
+        // largest one.
+        auto writable = this->readBuffer_.GetWritable();
+        assert(!writable.empty());
+
+        auto receivedCount =
+            this->socket_.Receive(writable.data(), writable.size(), 0);
+
+        if (receivedCount < 0)
+        {
+            if (WouldBlock(errno))
+            {
+                return false;
+            }
+
+            throw SocketError(
+                SystemError(errno),
+                "Failed to receive frames");
+        }
+
+        if (receivedCount == 0)
+        {
+            this->isClosed_ = true;
+
+            return false;
+        }
+
+        this->readBuffer_.CommitWrite(static_cast<size_t>(receivedCount));
+
+        return true;
+    }
+
+    void SendAll_(std::span<iovec> buffers)
+    {
+        while (!buffers.empty())
+        {
+            auto sentCount = this->socket_.SendVector(
+                buffers.first(std::min<size_t>(buffers.size(), IOV_MAX)),
+                MSG_NOSIGNAL);
+
+            if (sentCount < 0)
+            {
+                if (!WouldBlock(errno))
+                {
+                    throw SocketError(
+                        SystemError(errno),
+                        "Failed to send frames");
+                }
+
+                // Wait until the socket has room.
+                struct pollfd events{};
+                events.fd = this->socket_.GetHandle();
+                events.events = POLLOUT;
+                poll(&events, 1, -1);
+
+                continue;
+            }
+
+            auto remaining = static_cast<size_t>(sentCount);
+
+            while (!buffers.empty() && remaining >= buffers.front().iov_len)
+            {
+                remaining -= buffers.front().iov_len;
+                buffers = buffers.subspan(1);
+            }
+
+            if (remaining > 0)
+            {
+                auto &partial = buffers.front();
+                partial.iov_base =
+                    static_cast<char *>(partial.iov_base) + remaining;
+                partial.iov_len -= remaining;
+            }
+        }
+    }
+
+private:
+    Socket &socket_;
+    MirroredBuffer<std::byte> readBuffer_;
+    size_t maximumFrameSize_;
+    size_t consumedCount_;
+    bool isClosed_;
+};
+
+
+} // end namespace jive
@@ -0,0 +1,81 @@
+/**
+  * @file io_engine.h
+  *
+  * @brief Completion-based socket I/O, with batched submission.
+  *
+  * An IoEngine sends and receives on sockets that it does not own. Receive
+  * keeps receiving until the connection closes or the socket is removed,
+  * passing each chunk to a callback. Send transmits the whole span, then
+  * reports completion. Requests are queued, and submitted together by the
+  * next RunOnce, which also dispatches the completions.
+  *
+  * MakeIoEngine returns an io_uring engine when the kernel supports one, and
+  * an epoll engine otherwise.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <system_error>
+
+#include "jive/time_value.h"
+#include "jive/socket/socket.h"
+
+
+namespace jive
+{
+
+
+class IoEngine
+{
+public:
+    /**
+     ** Called with each chunk of received data, which is only valid during
+     ** the call. An empty span means the connection has closed, or failed,
+     ** and no more data will be received.
+     **/
+    using ReceiveCallback = std::function<void(std::span<const std::byte>)>;
+
+    /** Called once the data may be reused, with the error, if any. **/
+    using SendCallback = std::function<void(std::error_code)>;
+
+    virtual ~IoEngine() = default;
+
+    virtual const char * GetName() const = 0;
+
+    /** Start receiving on socket until it closes or is removed. **/
+    virtual void Receive(const Socket &socket, ReceiveCallback onReceive) = 0;
+
+    /**
+     ** Send all of data. It must remain valid, and unchanged, until onSent
+     ** is called. Sends on the same socket complete in order.
+     **/
+    virtual void Send(
+        const Socket &socket,
+        std::span<const std::byte> data,
+        SendCallback onSent) = 0;
+
+    /**
+     ** Stop receiving on socket. Its receive callback is not called again.
+     ** Call before closing the socket.
+     **/
+    virtual void Remove(const Socket &socket) = 0;
+
+    /**
+     ** Submit queued requests, wait for at least one completion (or until
+     ** timeOut expires), and dispatch every completion that is ready.
+     **
+     ** @return The number of callbacks made.
+     **/
+    virtual size_t RunOnce(std::optional<TimeValue> timeOut = {}) = 0;
+};
+
+
+} // end namespace jive
@@ -0,0 +1,42 @@
+/**
+  * @file make_io_engine.h
+  *
+  * @brief Choose the fastest IoEngine that the system supports.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <memory>
+
+#include "jive/socket/epoll_engine.h"
+#include "jive/socket/io_engine.h"
+#include "jive/socket/uring_engine.h"
+
+
+namespace jive
+{
+
+
+/** @return A UringEngine when io_uring is available, or an EpollEngine. **/
+inline std::unique_ptr<IoEngine> MakeIoEngine()
+{
+#ifdef JIVE_HAS_IO_URING
+    try
+    {
+        return std::make_unique<UringEngine>();
+    }
+    catch (const SocketError &)
+    {
+        // Not supported by this kernel, or not permitted.
+    }
+#endif
+
+    return std::make_unique<EpollEngine>();
+}
+
+
+} // end namespace jive
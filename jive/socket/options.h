@@ -0,0 +1,97 @@
+/**
+  * @file options.h
+  *
+  * @brief Typed socket options, for Socket::SetOption and GetOption.
+  *
+  * Each option names its level, its option name, the type callers use, and
+  * the type the kernel expects, so that a bool or a byte count reaches
+  * setsockopt as the int it requires.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+
+namespace jive
+{
+
+
+template<int level_, int name_, typename T, typename Native = int>
+struct SocketOption
+{
+    static constexpr int level = level_;
+    static constexpr int name = name_;
+
+    using Type = T;
+    using NativeType = Native;
+};
+
+
+namespace options
+{
+
+
+using ReuseAddress = SocketOption<SOL_SOCKET, SO_REUSEADDR, bool>;
+using ReusePort = SocketOption<SOL_SOCKET, SO_REUSEPORT, bool>;
+using KeepAlive = SocketOption<SOL_SOCKET, SO_KEEPALIVE, bool>;
+
+/** The kernel doubles the requested size, and reports the doubled value. **/
+using ReceiveBufferSize = SocketOption<SOL_SOCKET, SO_RCVBUF, int>;
+using SendBufferSize = SocketOption<SOL_SOCKET, SO_SNDBUF, int>;
+
+#ifdef SO_BUSY_POLL
+/**
+ ** Microseconds to busy-poll the device for data before sleeping in a
+ ** blocking receive. Raising it above net.core.busy_read needs
+ ** CAP_NET_ADMIN.
+ **/
+using BusyPoll = SocketOption<SOL_SOCKET, SO_BUSY_POLL, int>;
+#endif
+
+/** Send small segments at once, instead of waiting to coalesce them. **/
+using NoDelay = SocketOption<IPPROTO_TCP, TCP_NODELAY, bool>;
+
+#ifdef TCP_QUICKACK
+/**
+ ** Acknowledge at once, instead of delaying. The kernel may clear it again,
+ ** so it is set after receiving when it must persist.
+ **/
+using QuickAck = SocketOption<IPPROTO_TCP, TCP_QUICKACK, bool>;
+#endif
+
+#ifdef TCP_CORK
+/** Send only full segments until uncorked. **/
+using Cork = SocketOption<IPPROTO_TCP, TCP_CORK, bool>;
+#endif
+
+#ifdef TCP_USER_TIMEOUT
+/**
+ ** Milliseconds that sent data may remain unacknowledged before the
+ ** connection is dropped. Zero uses the system default.
+ **/
+using UserTimeout =
+    SocketOption<IPPROTO_TCP, TCP_USER_TIMEOUT, unsigned, unsigned>;
+#endif
+
+
+/** Accept only IPv6 connections, instead of IPv4-mapped ones as well. **/
+using V6Only = SocketOption<IPPROTO_IPV6, IPV6_V6ONLY, bool>;
+
+/** Deliver multicast datagrams to this host's own members. **/
+using MulticastLoop = SocketOption<IPPROTO_IP, IP_MULTICAST_LOOP, bool>;
+
+/** The number of router hops a multicast datagram may take. **/
+using MulticastTtl = SocketOption<IPPROTO_IP, IP_MULTICAST_TTL, int>;
+
+
+} // end namespace options
+
+
+} // end namespace jive
@@ -0,0 +1,598 @@
+/**
+  * @file rpc_client.h
+  *
+  * @brief Pipelined requests over a pool of connections.
+  *
+  * RpcClient keeps several connections to one server, and sends each
+  * request on the next connected one without waiting for earlier replies.
+  * Each request is a FramedChannel frame whose payload starts with a
+  * big-endian uint64_t request ID. The server replies to each frame with a
+  * frame carrying the same ID, in any order, and the reply completes the
+  * request's future.
+  *
+  * ID 0 is a keep-alive ping with an empty body, sent when a connection has
+  * been idle, and the server echoes it like any other frame. A connection
+  * that stays silent after a ping, or fails, is closed, its outstanding
+  * requests fail, and it reconnects after a delay that doubles with each
+  * failed attempt. Requests made while no connection is up wait for one.
+  *
+  * All socket work happens on the client's own EventLoop thread. Call may
+  * be used from any thread.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "jive/endian_tools.h"
+#include "jive/time_value.h"
+#include "jive/socket/error.h"
+#include "jive/socket/event_loop.h"
+#include "jive/socket/framed_channel.h"
+#include "jive/socket/socket.h"
+
+
+namespace jive
+{
+
+
+struct RpcOptions
+{
+    size_t connectionCount = 4;
+
+    /** The largest frame, including the request ID. **/
+    size_t maximumFrameSize = FramedChannel::defaultMaximumFrameSize;
+
+    /** Ping a connection that has been idle this long. Zero disables. **/
+    TimeValue keepAliveInterval = TimeValue(std::chrono::seconds(5));
+
+    /** The first reconnection delay, doubled after each failure. **/
+    TimeValue minimumBackoff = TimeValue(std::chrono::milliseconds(10));
+    TimeValue maximumBackoff = TimeValue(std::chrono::seconds(2));
+};
+
+
+class RpcClient
+{
+public:
+    using RequestId = uint64_t;
+    using Response = std::vector<std::byte>;
+
+    static constexpr size_t idByteCount = sizeof(RequestId);
+    static constexpr RequestId pingId = 0;
+
+    /** Start connecting in the background. Nothing here waits. **/
+    explicit RpcClient(const Endpoint &endpoint, RpcOptions options = {})
+        :
+        endpoint_(endpoint),
+        options_(options),
+        loop_(),
+        connections_(),
+        queued_(),
+        nextId_(pingId + 1),
+        nextConnection_(0),
+        connectedCount_(0),
+        submitMutex_(),
+        submitted_(),
+        thread_()
+    {
+        for (size_t i = 0; i < options.connectionCount; ++i)
+        {
+            this->connections_.push_back(std::make_unique<Connection_>());
+            this->connections_.back()->backoff = options.minimumBackoff;
+        }
+
+        for (auto &connection: this->connections_)
+        {
+            this->Connect_(*connection);
+        }
+
+        if (options.keepAliveInterval > TimeValue{})
+        {
+            this->loop_.AddRepeatingTimer(
+                options.keepAliveInterval,
+                [this]()
+                {
+                    this->KeepAlive_();
+                });
+        }
+
+        this->thread_ = std::thread(
+            [this]()
+            {
+                this->loop_.Run();
+            });
+    }
+
+    /** Stop, failing every request that has not been answered. **/
+    ~RpcClient()
+    {
+        this->loop_.Stop();
+        this->thread_.join();
+
+        auto canceled = std::make_exception_ptr(
+            SocketError(
+                std::make_error_code(std::errc::operation_canceled),
+                "RpcClient stopped"));
+
+        for (auto &connection: this->connections_)
+        {
+            this->FailOutstanding_(*connection, canceled);
+        }
+
+        for (auto &request: this->queued_)
+        {
+            request.promise.set_exception(canceled);
+        }
+
+        for (auto &request: this->submitted_)
+        {
+            request.promise.set_exception(canceled);
+        }
+    }
+
+    RpcClient(const RpcClient &) = delete;
+    RpcClient & operator=(const RpcClient &) = delete;
+
+    /**
+     ** Send body as a request. The body is copied, so it may be reused at
+     ** once. The future fails if the connection is lost first.
+     **/
+    std::future<Response> Call(std::span<const std::byte> body)
+    {
+        Request_ request{
+            Response(body.begin(), body.end()),
+            std::promise<Response>()};
+
+        auto result = request.promise.get_future();
+        bool isFirst = false;
+
+        {
+            std::lock_guard lock(this->submitMutex_);
+            isFirst = this->submitted_.empty();
+            this->submitted_.push_back(std::move(request));
+        }
+
+        // One wake-up carries every request submitted before it runs.
+        if (isFirst)
+        {
+            this->loop_.Post(
+                [this]()
+                {
+                    this->Submit_();
+                });
+        }
+
+        return result;
+    }
+
+    /** @return The number of connections that are up. **/
+    size_t GetConnectedCount() const
+    {
+        return this->connectedCount_;
+    }
+
+    const Endpoint & GetEndpoint() const
+    {
+        return this->endpoint_;
+    }
+
+private:
+    struct Request_
+    {
+        Response body;
+        std::promise<Response> promise;
+    };
+
+    struct Connection_
+    {
+        int handle = -1;
+
+        // Owned by the loop, and set once connected.
+        Socket *socket = nullptr;
+        std::unique_ptr<FramedChannel> channel;
+
+        std::vector<std::byte> outgoing;
+        size_t sentCount = 0;
+
+        std::unordered_map<RequestId, std::promise<Response>> outstanding;
+
+        TimeValue backoff;
+        TimeValue lastReceived;
+        bool isPingOutstanding = false;
+    };
+
+    void Connect_(Connection_ &connection)
+    {
+        try
+        {
+            Socket socket(this->endpoint_.GetFamily(), SOCK_STREAM);
+            socket.SetNonBlocking(true);
+
+            if (this->endpoint_.GetFamily() != AF_UNIX)
+            {
+                socket.SetOption<options::NoDelay>(true);
+                socket.SetOption<options::KeepAlive>(true);
+            }
+
+            socket.ConnectNoWait(this->endpoint_);
+            connection.handle = socket.GetHandle();
+
+            // The socket becomes writable when the connection completes,
+            // even when it completed at once.
+            this->loop_.Add(
+                std::move(socket),
+                {
+                    [this, &connection](Socket &connected)
+                    {
+                        this->OnReadable_(connection, connected);
+                    },
+                    [this, &connection](Socket &connected)
+                    {
+                        this->OnWritable_(connection, connected);
+                    }});
+        }
+        catch (const SocketError &)
+        {
+            connection.handle = -1;
+            this->Reconnect_(connection);
+        }
+    }
+
+    /** @return true when connected, after finishing a connection. **/
+    bool CheckConnected_(Connection_ &connection, Socket &socket)
+    {
+        if (connection.socket)
+        {
+            return true;
+        }
+
+        auto error = socket.GetSocketOption<int>(SO_ERROR);
+
+        if (error != 0)
+        {
+            this->Disconnect_(
+                connection,
+                std::make_exception_ptr(
+                    SocketError(SystemError(error), "Failed to connect")));
+
+            return false;
+        }
+
+        connection.socket = &socket;
+
+        connection.channel = std::make_unique<FramedChannel>(
+            socket,
+            this->options_.maximumFrameSize);
+
+        connection.backoff = this->options_.minimumBackoff;
+        connection.lastReceived = TimeValue::GetNow();
+        connection.isPingOutstanding = false;
+        ++this->connectedCount_;
+
+        this->Assign_();
+
+        // Sending the queued requests may have failed.
+        return connection.socket != nullptr;
+    }
+
+    void OnReadable_(Connection_ &connection, Socket &socket)
+    {
+        if (!this->CheckConnected_(connection, socket))
+        {
+            return;
+        }
+
+        try
+        {
+            connection.channel->Dispatch(
+                [this, &connection](std::span<const std::byte> frame)
+                {
+                    this->Complete_(connection, frame);
+                });
+        }
+        catch (const std::exception &)
+        {
+            this->Disconnect_(connection, std::current_exception());
+
+            return;
+        }
+
+        if (connection.channel->IsClosed())
+        {
+            this->Disconnect_(
+                connection,
+                std::make_exception_ptr(
+                    SocketDisconnected("Server closed the connection")));
+        }
+    }
+
+    void OnWritable_(Connection_ &connection, Socket &socket)
+    {
+        if (this->CheckConnected_(connection, socket))
+        {
+            this->Flush_(connection);
+        }
+    }
+
+    void Complete_(Connection_ &connection, std::span<const std::byte> frame)
+    {
+        if (frame.size() < idByteCount)
+        {
+            throw FrameError("Reply is too short for a request ID");
+        }
+
+        connection.lastReceived = TimeValue::GetNow();
+
+        RequestId requestId;
+        std::memcpy(&requestId, frame.data(), idByteCount);
+        requestId = BigEndianToHost(requestId);
+
+        if (requestId == pingId)
+        {
+            connection.isPingOutstanding = false;
+
+            return;
+        }
+
+        auto found = connection.outstanding.find(requestId);
+
+        if (found == connection.outstanding.end())
+        {
+            throw FrameError("Reply to an unknown request");
+        }
+
+        auto body = frame.subspan(idByteCount);
+        found->second.set_value(Response(body.begin(), body.end()));
+        connection.outstanding.erase(found);
+    }
+
+    void Disconnect_(Connection_ &connection, std::exception_ptr error)
+    {
+        if (connection.socket)
+        {
+            --this->connectedCount_;
+        }
+
+        // Removal is deferred while the loop dispatches, so the socket stays
+        // valid until this handler returns.
+        this->loop_.Remove(connection.handle);
+        connection.handle = -1;
+        connection.socket = nullptr;
+        connection.channel.reset();
+        connection.outgoing.clear();
+        connection.sentCount = 0;
+
+        this->FailOutstanding_(connection, error);
+        this->Reconnect_(connection);
+    }
+
+    void Reconnect_(Connection_ &connection)
+    {
+        this->loop_.AddTimer(
+            connection.backoff,
+            [this, &connection]()
+            {
+                this->Connect_(connection);
+            });
+
+        connection.backoff = std::min(
+            connection.backoff + connection.backoff,
+            this->options_.maximumBackoff);
+    }
+
+    void FailOutstanding_(Connection_ &connection, std::exception_ptr error)
+    {
+        for (auto &entry: connection.outstanding)
+        {
+            entry.second.set_exception(error);
+        }
+
+        connection.outstanding.clear();
+    }
+
+    void Submit_()
+    {
+        {
+            std::lock_guard lock(this->submitMutex_);
+
+            for (auto &request: this->submitted_)
+            {
+                this->queued_.push_back(std::move(request));
+            }
+
+            this->submitted_.clear();
+        }
+
+        this->Assign_();
+    }
+
+    /** Give queued requests to connected connections, in turn. **/
+    void Assign_()
+    {
+        if (this->connectedCount_ == 0)
+        {
+            return;
+        }
+
+        while (!this->queued_.empty())
+        {
+            auto &connection = this->NextConnected_();
+            auto &request = this->queued_.front();
+
+            if (idByteCount + request.body.size()
+                > this->options_.maximumFrameSize)
+            {
+                request.promise.set_exception(
+                    std::make_exception_ptr(
+                        FrameError("Request exceeds the maximum frame size")));
+            }
+            else
+            {
+                auto requestId = this->nextId_++;
+                this->Encode_(connection, requestId, request.body);
+
+                connection.outstanding.emplace(
+                    requestId,
+                    std::move(request.promise));
+            }
+
+            this->queued_.pop_front();
+        }
+
+        for (auto &connection: this->connections_)
+        {
+            if (connection->socket && !connection->outgoing.empty())
+            {
+                this->Flush_(*connection);
+            }
+        }
+    }
+
+    Connection_ & NextConnected_()
+    {
+        while (true)
+        {
+            auto &connection = *this->connections_[this->nextConnection_];
+
+            this->nextConnection_ =
+                (this->nextConnection_ + 1) % this->connections_.size();
+
+            if (connection.socket)
+            {
+                return connection;
+            }
+        }
+    }
+
+    void Encode_(
+        Connection_ &connection,
+        RequestId requestId,
+        std::span<const std::byte> body)
+    {
+        auto header = HostToBigEndian(
+            static_cast<FramedChannel::Header>(idByteCount + body.size()));
+
+        auto id = HostToBigEndian(requestId);
+
+        auto &outgoing = connection.outgoing;
+        auto offset = outgoing.size();
+
+        outgoing.resize(
+            offset + FramedChannel::headerByteCount + idByteCount
+            + body.size());
+
+        auto target = outgoing.data() + offset;
+        std::memcpy(target, &header, FramedChannel::headerByteCount);
+        target += FramedChannel::headerByteCount;
+        std::memcpy(target, &id, idByteCount);
+
+        if (!body.empty())
+        {
+            std::memcpy(target + idByteCount, body.data(), body.size());
+        }
+    }
+
+    /** Send until done, or until the socket is full. **/
+    void Flush_(Connection_ &connection)
+    {
+        auto &outgoing = connection.outgoing;
+
+        while (connection.sentCount < outgoing.size())
+        {
+            auto sentCount = connection.socket->Send(
+                outgoing.data() + connection.sentCount,
+                outgoing.size() - connection.sentCount,
+                MSG_NOSIGNAL);
+
+            if (sentCount < 0)
+            {
+                if (WouldBlock(errno))
+                {
+                    // Resumed by the next writable event.
+                    return;
+                }
+
+                this->Disconnect_(
+                    connection,
+                    std::make_exception_ptr(
+                        SocketError(SystemError(errno), "Failed to send")));
+
+                return;
+            }
+
+            connection.sentCount += static_cast<size_t>(sentCount);
+        }
+
+        outgoing.clear();
+        connection.sentCount = 0;
+    }
+
+    void KeepAlive_()
+    {
+        auto now = TimeValue::GetNow();
+        auto interval = this->options_.keepAliveInterval;
+
+        for (auto &connection: this->connections_)
+        {
+            if (!connection->socket
+                || now - connection->lastReceived < interval)
+            {
+                continue;
+            }
+
+            if (connection->isPingOutstanding)
+            {
+                // A full interval has passed without a reply to the ping.
+                this->Disconnect_(
+                    *connection,
+                    std::make_exception_ptr(
+                        SocketError(
+                            std::make_error_code(std::errc::timed_out),
+                            "Keep-alive timed out")));
+
+                continue;
+            }
+
+            connection->isPingOutstanding = true;
+            connection->lastReceived = now;
+            this->Encode_(*connection, pingId, {});
+            this->Flush_(*connection);
+        }
+    }
+
+private:
+    Endpoint endpoint_;
+    RpcOptions options_;
+    EventLoop loop_;
+    std::vector<std::unique_ptr<Connection_>> connections_;
+    std::deque<Request_> queued_;
+    RequestId nextId_;
+    size_t nextConnection_;
+    std::atomic<size_t> connectedCount_;
+    std::mutex submitMutex_;
+    std::vector<Request_> submitted_;
+    std::thread thread_;
+};
+
+
+} // end namespace jive
@@ -0,0 +1,209 @@
+/**
+  * @file server.h
+  *
+  * @brief Accept connections on several threads, each with its own EventLoop.
+  *
+  * Every worker binds its own listener to the same address with
+  * SO_REUSEPORT, so the kernel spreads new connections across the workers,
+  * and no thread accepts for the others. Each connection stays on the
+  * worker that accepted it, and its callback runs on that worker's thread,
+  * with that worker's loop.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "jive/socket/event_loop.h"
+#include "jive/socket/socket.h"
+
+
+namespace jive
+{
+
+
+class Server
+{
+public:
+    /** Called on the accepting worker's thread, with its loop. **/
+    using ConnectionCallback = std::function<void(EventLoop &, Socket &&)>;
+
+    /**
+     ** Bind workerCount listeners to address, and start their threads.
+     **
+     ** @param address When its port is 0, the first listener picks one, and
+     ** the others share it. See GetAddress.
+     ** @param workerCount When 0, one worker per hardware thread.
+     **/
+    Server(
+        const ServiceAddress &address,
+        ConnectionCallback onConnection,
+        size_t workerCount = 0)
+        :
+        address_(address),
+        onConnection_(std::move(onConnection)),
+        workers_()
+    {
+        if (workerCount == 0)
+        {
+            workerCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        for (size_t i = 0; i < workerCount; ++i)
+        {
+            Socket listener;
+            listener.SetOption<options::ReusePort>(true);
+            listener.Bind(this->address_);
+
+            if (i == 0)
+            {
+                this->address_ = listener.GetLocalAddress();
+            }
+
+            auto worker = std::make_unique<Worker_>();
+            auto &loop = worker->loop;
+
+            loop.Listen(
+                std::move(listener),
+                [this, &loop](Socket &&connection)
+                {
+                    this->onConnection_(loop, std::move(connection));
+                });
+
+            this->workers_.push_back(std::move(worker));
+        }
+
+        // Start only when every listener is bound, so that a failure above
+        // leaves no threads to stop.
+        try
+        {
+            for (auto &worker: this->workers_)
+            {
+                worker->thread = std::thread(&Worker_::Run, worker.get());
+            }
+        }
+        catch (...)
+        {
+            this->Stop_();
+
+            throw;
+        }
+    }
+
+    ~Server()
+    {
+        this->Stop_();
+    }
+
+    Server(const Server &) = delete;
+    Server & operator=(const Server &) = delete;
+
+    /** @return The address the listeners are bound to, with its port. **/
+    const ServiceAddress & GetAddress() const
+    {
+        return this->address_;
+    }
+
+    size_t GetWorkerCount() const
+    {
+        return this->workers_.size();
+    }
+
+    /**
+     ** Run callback on the thread of worker index, with its loop. May be
+     ** called from any thread.
+     **/
+    void Post(size_t index, std::function<void(EventLoop &)> callback)
+    {
+        auto &loop = this->workers_.at(index)->loop;
+
+        loop.Post(
+            [&loop, callback = std::move(callback)]()
+            {
+                callback(loop);
+            });
+    }
+
+    /**
+     ** Stop the workers, and wait for them to return. Connections stay open
+     ** until the Server is destroyed. A worker keeps running after a
+     ** callback throws, and the first exception from each worker is
+     ** rethrown here.
+     **/
+    void Stop()
+    {
+        this->Stop_();
+
+        for (auto &worker: this->workers_)
+        {
+            if (worker->error)
+            {
+                std::rethrow_exception(std::exchange(worker->error, {}));
+            }
+        }
+    }
+
+private:
+    struct Worker_
+    {
+        void Run()
+        {
+            // One failed callback must not stop the connections that share
+            // this worker, so keep running until Stop.
+            while (true)
+            {
+                try
+                {
+                    this->loop.Run();
+
+                    return;
+                }
+                catch (...)
+                {
+                    if (!this->error)
+                    {
+                        this->error = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        EventLoop loop;
+        std::thread thread;
+        std::exception_ptr error;
+    };
+
+    void Stop_()
+    {
+        for (auto &worker: this->workers_)
+        {
+            worker->loop.Stop();
+        }
+
+        for (auto &worker: this->workers_)
+        {
+            if (worker->thread.joinable())
+            {
+                worker->thread.join();
+            }
+        }
+    }
+
+private:
+    ServiceAddress address_;
+    ConnectionCallback onConnection_;
+    std::vector<std::unique_ptr<Worker_>> workers_;
+};
+
+
+} // end namespace jive
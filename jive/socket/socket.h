@@ -13,9 +13,12 @@
 
 #include <cstring>
 #include <optional>
+#include <utility>
 #include <ctime>
 #include <cstddef>
+#include <span>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <poll.h>
@@ -26,6 +29,7 @@
 #include "jive/error.h"
 #include "jive/socket/error.h"
 #include "jive/socket/address.h"
+#include "jive/socket/options.h"
 
 
 namespace jive
@@ -93,12 +97,25 @@ bool WouldBlock(int errorCode)
 class Socket
 {
 public:
+    /** A TCP socket for IPv4. **/
     Socket()
+        :
+        Socket(AF_INET, SOCK_STREAM)
+    {
+
+    }
+
+    /**
+     ** @param family AF_INET, AF_INET6, or AF_UNIX.
+     ** @param type SOCK_STREAM or SOCK_DGRAM.
+     **/
+    Socket(int family, int type, int protocol = 0)
         :
         handle_{-1},
+        connectedEndpoint_{},
         connectedAddress_{}
     {
-        this->handle_ = socket(AF_INET, SOCK_STREAM, 0);
+        this->handle_ = socket(family, type, protocol);
 
         if (this->handle_ == -1)
         {
@@ -109,6 +126,7 @@ public:
     Socket(Socket &&other) noexcept
         :
         handle_{other.handle_},
+        connectedEndpoint_{other.connectedEndpoint_},
         connectedAddress_{other.connectedAddress_}
     {
         other.handle_ = -1;
@@ -118,6 +136,7 @@ public:
     {
         this->Close(); 
         this->handle_ = other.handle_;
+        this->connectedEndpoint_ = other.connectedEndpoint_;
         this->connectedAddress_ = other.connectedAddress_;
         other.handle_ = -1;
         return *this;
@@ -128,6 +147,25 @@ public:
         this->Close();
     }
 
+    int GetHandle() const
+    {
+        return this->handle_;
+    }
+
+    void SetNonBlocking(bool isNonBlocking)
+    {
+        bool success = isNonBlocking
+            ? AddFlag(this->handle_, O_NONBLOCK)
+            : RemoveFlag(this->handle_, O_NONBLOCK);
+
+        if (!success)
+        {
+            throw SocketError(
+                SystemError(errno),
+                "Failed to change blocking mode");
+        }
+    }
+
     void Close() noexcept
     {
         if (this->handle_ > -1)
@@ -150,23 +188,21 @@ public:
         }
     }
 
-    void Bind(const ServiceAddress &serviceAddress)
+    void Bind(const Endpoint &endpoint)
     {
-        SocketAddress socketAddress = serviceAddress.GetSocketAddress();
-
         int result = bind(
             this->handle_,
-            reinterpret_cast<struct sockaddr *>(&socketAddress),
-            sizeof(SocketAddress));
+            endpoint.GetNative(),
+            endpoint.GetLength());
 
         if (result == -1)
         {
             throw SocketError(
                 SystemError(errno),
-                "Failed to bind to " + serviceAddress.ToString());
+                "Failed to bind to " + endpoint.ToString());
         }
 
-        this->connectedAddress_ = serviceAddress;
+        this->SetConnected_(endpoint);
     }
 
     /**
@@ -176,34 +212,41 @@ public:
      **/
     Socket Accept() const
     {
-        SocketAddress connectedAddress;
-        socklen_t length = sizeof(SocketAddress);
+        auto result = this->Accept_();
 
-        int connectedHandle = accept(
-            this->handle_,
-            reinterpret_cast<struct sockaddr *>(&connectedAddress),
-            &length);
-
-        if (connectedHandle == -1)
+        if (!result)
         {
             throw SocketError(
                 SystemError(errno),
                 "Failed to accept connection");
         }
 
-        Socket result{};
-        result.handle_ = connectedHandle;
-        result.connectedAddress_ = ServiceAddress(connectedAddress);
+        return std::move(*result);
+    }
+
+    /**
+     ** Accept a pending connection on a non-blocking socket.
+     **
+     ** @return the new socket, or nothing when no connection is waiting.
+     **/
+    std::optional<Socket> AcceptNoWait() const
+    {
+        auto result = this->Accept_();
+
+        if (!result && !WouldBlock(errno))
+        {
+            throw SocketError(
+                SystemError(errno),
+                "Failed to accept connection");
+        }
 
         return result;
     }
 
     void Connect(
-        const ServiceAddress &serviceAddress,
+        const Endpoint &endpoint,
         int timeOutMilliseconds = 2000)
     {
-        SocketAddress socketAddress = serviceAddress.GetSocketAddress();
-
         if (timeOutMilliseconds >= 0)
         {
             if (!AddFlag(this->handle_, O_NONBLOCK))
@@ -216,8 +259,8 @@ public:
 
         int result = connect(
             this->handle_,
-            reinterpret_cast<struct sockaddr *>(&socketAddress),
-            sizeof(SocketAddress));
+            endpoint.GetNative(),
+            endpoint.GetLength());
 
         if (result == -1)
         {
@@ -225,7 +268,7 @@ public:
             {
                 throw SocketError(
                     SystemError(errno),
-                    "Failed to connect to " + serviceAddress.ToString());
+                    "Failed to connect to " + endpoint.ToString());
             }
 
             // The socket is non-blocking.
@@ -247,7 +290,7 @@ public:
             {
                 throw SocketError(
                     SystemError(errno),
-                    "Failed to connect to " + serviceAddress.ToString());
+                    "Failed to connect to " + endpoint.ToString());
             }
             else
             {
@@ -259,7 +302,7 @@ public:
                     // An error occurred
                     throw SocketError(
                         SystemError(errno),
-                        "Failed to connect to " + serviceAddress.ToString());
+                        "Failed to connect to " + endpoint.ToString());
                 }
                 // else
                 // Success!
@@ -276,14 +319,89 @@ public:
             }
         }
 
-        this->connectedAddress_ = serviceAddress;
+        this->SetConnected_(endpoint);
+    }
+
+    /**
+     ** Start connecting a non-blocking socket. When the connection is in
+     ** progress, the socket becomes writable once it completes, and SO_ERROR
+     ** reports whether it succeeded.
+     **
+     ** @return true when connected at once.
+     **/
+    bool ConnectNoWait(const Endpoint &endpoint)
+    {
+        int result = connect(
+            this->handle_,
+            endpoint.GetNative(),
+            endpoint.GetLength());
+
+        if (result == -1 && errno != EINPROGRESS)
+        {
+            throw SocketError(
+                SystemError(errno),
+                "Failed to connect to " + endpoint.ToString());
+        }
+
+        this->SetConnected_(endpoint);
+
+        return result == 0;
     }
 
+    /**
+     ** @return The IPv4 address this socket connected or was bound to. Use
+     ** GetConnectedEndpoint for other families.
+     **/
     const ServiceAddress & GetConnectedAddress() const
     {
+        auto family = this->connectedEndpoint_.GetFamily();
+
+        if (family != AF_INET && family != AF_UNSPEC)
+        {
+            throw SocketError(
+                std::make_error_code(std::errc::address_family_not_supported),
+                "Expected an IPv4 address");
+        }
+
         return this->connectedAddress_;
     }
 
+    const Endpoint & GetConnectedEndpoint() const
+    {
+        return this->connectedEndpoint_;
+    }
+
+    /**
+     ** @return The IPv4 address assigned by the system, including its port.
+     ** Use GetLocalEndpoint for other families.
+     **/
+    ServiceAddress GetLocalAddress() const
+    {
+        return this->GetLocalEndpoint().GetServiceAddress();
+    }
+
+    Endpoint GetLocalEndpoint() const
+    {
+        struct sockaddr_storage socketAddress{};
+        socklen_t length = sizeof(socketAddress);
+
+        int result = getsockname(
+            this->handle_,
+            reinterpret_cast<struct sockaddr *>(&socketAddress),
+            &length);
+
+        if (result == -1)
+        {
+            throw SocketError(
+                SystemError(errno),
+                "Failed to get local address");
+        }
+
+        return Endpoint(
+            reinterpret_cast<struct sockaddr *>(&socketAddress),
+            length);
+    }
+
     std::ptrdiff_t Receive(void *buffer, size_t count, int flags) const
     {
         return recv(this->handle_, buffer, count, flags);
@@ -350,6 +468,105 @@ public:
         return send(this->handle_, buffer, byteCount, flags);
     }
 
+    /** Gather buffers into one sendmsg. **/
+    std::ptrdiff_t SendVector(std::span<const iovec> buffers, int flags) const
+    {
+        struct msghdr message{};
+        message.msg_iov = const_cast<iovec *>(buffers.data());
+        message.msg_iovlen = buffers.size();
+
+        return sendmsg(this->handle_, &message, flags);
+    }
+
+    /** Scatter one recvmsg into buffers, in order. **/
+    std::ptrdiff_t ReceiveVector(
+        std::span<const iovec> buffers,
+        int flags) const
+    {
+        struct msghdr message{};
+        message.msg_iov = const_cast<iovec *>(buffers.data());
+        message.msg_iovlen = buffers.size();
+
+        return recvmsg(this->handle_, &message, flags);
+    }
+
+    /** Send one datagram to destination. **/
+    std::ptrdiff_t SendTo(
+        const void *buffer,
+        size_t byteCount,
+        const Endpoint &destination,
+        int flags) const
+    {
+        return sendto(
+            this->handle_,
+            buffer,
+            byteCount,
+            flags,
+            destination.GetNative(),
+            destination.GetLength());
+    }
+
+    /** Receive one datagram, and the address that sent it. **/
+    std::ptrdiff_t ReceiveFrom(
+        void *buffer,
+        size_t byteCount,
+        Endpoint &sender,
+        int flags) const
+    {
+        struct sockaddr_storage socketAddress{};
+        socklen_t length = sizeof(socketAddress);
+
+        auto receivedCount = recvfrom(
+            this->handle_,
+            buffer,
+            byteCount,
+            flags,
+            reinterpret_cast<struct sockaddr *>(&socketAddress),
+            &length);
+
+        if (receivedCount >= 0)
+        {
+            sender = Endpoint(
+                reinterpret_cast<struct sockaddr *>(&socketAddress),
+                length);
+        }
+
+        return receivedCount;
+    }
+
+#ifdef __linux__
+    /**
+     ** Send several datagrams with one sendmmsg.
+     **
+     ** @return The number of messages sent, which may be fewer than all, or
+     ** -1 with errno set.
+     **/
+    int SendMany(std::span<struct mmsghdr> messages, int flags) const
+    {
+        return sendmmsg(
+            this->handle_,
+            messages.data(),
+            static_cast<unsigned>(messages.size()),
+            flags);
+    }
+
+    /**
+     ** Receive several datagrams with one recvmmsg. With MSG_WAITFORONE,
+     ** only the first is waited for.
+     **
+     ** @return The number of messages received, or -1 with errno set.
+     **/
+    int ReceiveMany(std::span<struct mmsghdr> messages, int flags) const
+    {
+        return recvmmsg(
+            this->handle_,
+            messages.data(),
+            static_cast<unsigned>(messages.size()),
+            flags,
+            nullptr);
+    }
+#endif // __linux__
+
     std::optional<size_t> SendWait(const void *buffer, size_t count) const
     {
         std::ptrdiff_t sentCount = this->Send(buffer, count, 0);
@@ -371,10 +588,16 @@ public:
 
     template<typename T>
     void SetSocketOption(int optionName, const T &value)
+    {
+        this->SetSocketOption(SOL_SOCKET, optionName, value);
+    }
+
+    template<typename T>
+    void SetSocketOption(int level, int optionName, const T &value)
     {
         int result = setsockopt(
             this->handle_,
-            SOL_SOCKET,
+            level,
             optionName,
             &value,
             sizeof(T));
@@ -388,14 +611,20 @@ public:
     }
 
     template<typename T>
-    T GetSocketOption(int optionName)
+    T GetSocketOption(int optionName) const
+    {
+        return this->GetSocketOption<T>(SOL_SOCKET, optionName);
+    }
+
+    template<typename T>
+    T GetSocketOption(int level, int optionName) const
     {
         T result;
         socklen_t optionSize = sizeof(T);
 
         int socketResult = getsockopt(
             this->handle_,
-            SOL_SOCKET,
+            level,
             optionName,
             &result,
             &optionSize);
@@ -415,6 +644,54 @@ public:
         return result;
     }
 
+    /** Set a typed option from options.h, like options::NoDelay. **/
+    template<typename Option>
+    void SetOption(typename Option::Type value)
+    {
+        this->SetSocketOption(
+            Option::level,
+            Option::name,
+            static_cast<typename Option::NativeType>(value));
+    }
+
+    template<typename Option>
+    typename Option::Type GetOption() const
+    {
+        return static_cast<typename Option::Type>(
+            this->GetSocketOption<typename Option::NativeType>(
+                Option::level,
+                Option::name));
+    }
+
+    /** Receive the IPv4 multicast group on the interface with address. **/
+    void JoinMulticastGroup(
+        const Address &group,
+        const Address &interface = Address())
+    {
+        struct ip_mreq request{};
+        request.imr_multiaddr = group.Get();
+        request.imr_interface = interface.Get();
+
+        this->SetSocketOption(IPPROTO_IP, IP_ADD_MEMBERSHIP, request);
+    }
+
+    void LeaveMulticastGroup(
+        const Address &group,
+        const Address &interface = Address())
+    {
+        struct ip_mreq request{};
+        request.imr_multiaddr = group.Get();
+        request.imr_interface = interface.Get();
+
+        this->SetSocketOption(IPPROTO_IP, IP_DROP_MEMBERSHIP, request);
+    }
+
+    /** Send multicast datagrams from the interface with address. **/
+    void SetMulticastInterface(const Address &interface)
+    {
+        this->SetSocketOption(IPPROTO_IP, IP_MULTICAST_IF, interface.Get());
+    }
+
     void SetReceiveTimeOut(long seconds, suseconds_t microseconds)
     {
         timeval timeValue;
@@ -463,8 +740,53 @@ public:
     }
 
 
+private:
+    // Take ownership of a handle returned by accept.
+    Socket(int handle, const Endpoint &connectedEndpoint)
+        :
+        handle_{handle},
+        connectedEndpoint_{},
+        connectedAddress_{}
+    {
+        this->SetConnected_(connectedEndpoint);
+    }
+
+    void SetConnected_(const Endpoint &endpoint)
+    {
+        this->connectedEndpoint_ = endpoint;
+
+        this->connectedAddress_ = (endpoint.GetFamily() == AF_INET)
+            ? endpoint.GetServiceAddress()
+            : ServiceAddress{};
+    }
+
+    std::optional<Socket> Accept_() const
+    {
+        struct sockaddr_storage connectedAddress{};
+        socklen_t length = sizeof(connectedAddress);
+
+        int connectedHandle = accept(
+            this->handle_,
+            reinterpret_cast<struct sockaddr *>(&connectedAddress),
+            &length);
+
+        if (connectedHandle == -1)
+        {
+            return {};
+        }
+
+        return Socket(
+            connectedHandle,
+            Endpoint(
+                reinterpret_cast<struct sockaddr *>(&connectedAddress),
+                length));
+    }
+
 private:
     int handle_;
+    Endpoint connectedEndpoint_;
+
+    // The IPv4 form of connectedEndpoint_, for GetConnectedAddress.
     ServiceAddress connectedAddress_;
 };
 
@@ -0,0 +1,127 @@
+/**
+  * @file tuning.h
+  *
+  * @brief Bundles of socket options for latency or throughput.
+  *
+  * Only the options that are set are applied, so a preset may be adjusted
+  * before use:
+  *
+  *     auto tuning = SocketTuning::LowLatency();
+  *     tuning.userTimeoutMilliseconds = 5000;
+  *     tuning.Apply(socket);
+  *
+  * Options that the platform lacks, such as TCP_QUICKACK outside Linux, are
+  * left out of SocketTuning and its presets.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <optional>
+
+#include "jive/socket/socket.h"
+
+
+namespace jive
+{
+
+
+struct SocketTuning
+{
+    std::optional<bool> noDelay;
+#ifdef TCP_QUICKACK
+    std::optional<bool> quickAck;
+#endif
+#ifdef SO_BUSY_POLL
+    std::optional<int> busyPollMicroseconds;
+#endif
+    std::optional<int> receiveBufferSize;
+    std::optional<int> sendBufferSize;
+#ifdef TCP_USER_TIMEOUT
+    std::optional<unsigned> userTimeoutMilliseconds;
+#endif
+
+    /** Small request and response exchanges, sent without waiting. **/
+    static SocketTuning LowLatency()
+    {
+        SocketTuning result;
+        result.noDelay = true;
+#ifdef TCP_QUICKACK
+        result.quickAck = true;
+#endif
+
+        return result;
+    }
+
+#ifdef SO_BUSY_POLL
+    /**
+     ** LowLatency, and busy-polling in blocking receives, which trades CPU
+     ** for wake-up time.
+     **/
+    static SocketTuning BusyPolling(int microseconds = 50)
+    {
+        auto result = LowLatency();
+        result.busyPollMicroseconds = microseconds;
+
+        return result;
+    }
+#endif
+
+    /** Bulk transfers, with full segments and large kernel buffers. **/
+    static SocketTuning Throughput(int bufferSize = 4 * 1024 * 1024)
+    {
+        SocketTuning result;
+        result.noDelay = false;
+        result.receiveBufferSize = bufferSize;
+        result.sendBufferSize = bufferSize;
+
+        return result;
+    }
+
+    void Apply(Socket &socket) const
+    {
+        if (this->noDelay)
+        {
+            socket.SetOption<options::NoDelay>(*this->noDelay);
+        }
+
+#ifdef TCP_QUICKACK
+        if (this->quickAck)
+        {
+            socket.SetOption<options::QuickAck>(*this->quickAck);
+        }
+#endif
+
+#ifdef SO_BUSY_POLL
+        if (this->busyPollMicroseconds)
+        {
+            socket.SetOption<options::BusyPoll>(*this->busyPollMicroseconds);
+        }
+#endif
+
+        if (this->receiveBufferSize)
+        {
+            socket.SetOption<options::ReceiveBufferSize>(
+                *this->receiveBufferSize);
+        }
+
+        if (this->sendBufferSize)
+        {
+            socket.SetOption<options::SendBufferSize>(*this->sendBufferSize);
+        }
+
+#ifdef TCP_USER_TIMEOUT
+        if (this->userTimeoutMilliseconds)
+        {
+            socket.SetOption<options::UserTimeout>(
+                *this->userTimeoutMilliseconds);
+        }
+#endif
+    }
+};
+
+
+} // end namespace jive
@@ -0,0 +1,914 @@
+/**
+  * @file uring_engine.h
+  *
+  * @brief An IoEngine built on io_uring, using the raw system calls.
+  *
+  * Every request made between calls to RunOnce is submitted with a single
+  * io_uring_enter, which also waits for completions. Each socket has one
+  * multishot receive, which keeps delivering data into buffers that the
+  * engine has provided to the kernel, until the connection closes. Sends at
+  * least zeroCopyByteCount long use IORING_OP_SEND_ZC, and complete once the
+  * kernel has released the data.
+  *
+  * Requires Linux 6.0, for multishot receive and zero-copy send. The
+  * constructor throws SocketError when they are not available, and
+  * MakeIoEngine falls back to EpollEngine.
+  *
+  * JIVE_HAS_IO_URING is defined when the kernel headers support it.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#ifdef IORING_RECV_MULTISHOT
+#define JIVE_HAS_IO_URING
+#endif
+#endif
+
+#ifdef JIVE_HAS_IO_URING
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "jive/socket/error.h"
+#include "jive/socket/io_engine.h"
+
+
+namespace jive
+{
+
+
+namespace detail
+{
+
+
+/** The submission and completion queues shared with the kernel. **/
+class UringQueues
+{
+public:
+    explicit UringQueues(unsigned entryCount)
+        :
+        handle_(-1),
+        ringSize_(0),
+        ring_(nullptr),
+        submissionsSize_(0),
+        submissions_(nullptr),
+        sqHead_(nullptr),
+        sqTail_(nullptr),
+        sqMask_(0),
+        sqEntryCount_(0),
+        sqArray_(nullptr),
+        sqLocalTail_(0),
+        cqHead_(nullptr),
+        cqTail_(nullptr),
+        cqMask_(0),
+        completions_(nullptr)
+    {
+        struct io_uring_params parameters{};
+
+        // Run completion work when the application enters the kernel,
+        // instead of interrupting it. Older kernels reject the flag.
+        parameters.flags = IORING_SETUP_COOP_TASKRUN;
+        this->handle_ = Setup_(entryCount, parameters);
+
+        if (this->handle_ < 0 && errno == EINVAL)
+        {
+            parameters = {};
+            this->handle_ = Setup_(entryCount, parameters);
+        }
+
+        if (this->handle_ < 0)
+        {
+            throw SocketError(SystemError(errno), "Failed to create io_uring");
+        }
+
+        constexpr unsigned requiredFeatures =
+            IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+
+        if ((parameters.features & requiredFeatures) != requiredFeatures)
+        {
+            close(this->handle_);
+
+            throw SocketError(
+                std::make_error_code(std::errc::operation_not_supported),
+                "io_uring is missing required features");
+        }
+
+        this->ringSize_ = std::max(
+            parameters.sq_off.array
+                + parameters.sq_entries * sizeof(unsigned),
+            parameters.cq_off.cqes
+                + parameters.cq_entries * sizeof(struct io_uring_cqe));
+
+        this->ring_ = mmap(
+            nullptr,
+            this->ringSize_,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            this->handle_,
+            IORING_OFF_SQ_RING);
+
+        if (this->ring_ == MAP_FAILED)
+        {
+            auto error = errno;
+            close(this->handle_);
+
+            throw SocketError(SystemError(error), "Failed to map io_uring");
+        }
+
+        this->submissionsSize_ =
+            parameters.sq_entries * sizeof(struct io_uring_sqe);
+
+        auto submissions = mmap(
+            nullptr,
+            this->submissionsSize_,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            this->handle_,
+            IORING_OFF_SQES);
+
+        if (submissions == MAP_FAILED)
+        {
+            auto error = errno;
+            munmap(this->ring_, this->ringSize_);
+            close(this->handle_);
+
+            throw SocketError(SystemError(error), "Failed to map io_uring");
+        }
+
+        this->submissions_ = static_cast<struct io_uring_sqe *>(submissions);
+
+        auto ring = static_cast<char *>(this->ring_);
+        const auto &sq = parameters.sq_off;
+        const auto &cq = parameters.cq_off;
+
+        this->sqHead_ = reinterpret_cast<unsigned *>(ring + sq.head);
+        this->sqTail_ = reinterpret_cast<unsigned *>(ring + sq.tail);
+        this->sqMask_ = *reinterpret_cast<unsigned *>(ring + sq.ring_mask);
+        this->sqEntryCount_ = parameters.sq_entries;
+        this->sqArray_ = reinterpret_cast<unsigned *>(ring + sq.array);
+        this->sqLocalTail_ = *this->sqTail_;
+
+        this->cqHead_ = reinterpret_cast<unsigned *>(ring + cq.head);
+        this->cqTail_ = reinterpret_cast<unsigned *>(ring + cq.tail);
+        this->cqMask_ = *reinterpret_cast<unsigned *>(ring + cq.ring_mask);
+
+        this->completions_ =
+            reinterpret_cast<struct io_uring_cqe *>(ring + cq.cqes);
+    }
+
+    ~UringQueues()
+    {
+        munmap(this->submissions_, this->submissionsSize_);
+        munmap(this->ring_, this->ringSize_);
+        close(this->handle_);
+    }
+
+    UringQueues(const UringQueues &) = delete;
+    UringQueues & operator=(const UringQueues &) = delete;
+
+    int GetHandle() const { return this->handle_; }
+
+    /**
+     ** @return A cleared submission entry, or nullptr when the queue is full
+     ** until the next Enter.
+     **/
+    struct io_uring_sqe * GetSubmission()
+    {
+        auto head = std::atomic_ref(*this->sqHead_).load(
+            std::memory_order_acquire);
+
+        if (this->sqLocalTail_ - head == this->sqEntryCount_)
+        {
+            return nullptr;
+        }
+
+        auto index = this->sqLocalTail_ & this->sqMask_;
+        this->sqArray_[index] = index;
+        ++this->sqLocalTail_;
+
+        auto submission = &this->submissions_[index];
+        std::memset(submission, 0, sizeof(*submission));
+
+        return submission;
+    }
+
+    /**
+     ** Submit every new entry, and wait for waitCount completions, or until
+     ** timeOut expires.
+     **/
+    void Enter(unsigned waitCount, const struct timespec *timeOut = nullptr)
+    {
+        std::atomic_ref(*this->sqTail_).store(
+            this->sqLocalTail_,
+            std::memory_order_release);
+
+        auto submitCount = this->sqLocalTail_
+            - std::atomic_ref(*this->sqHead_).load(std::memory_order_acquire);
+
+        unsigned flags = IORING_ENTER_GETEVENTS;
+        struct __kernel_timespec kernelTimeOut{};
+        struct io_uring_getevents_arg argument{};
+
+        if (timeOut)
+        {
+            kernelTimeOut.tv_sec = timeOut->tv_sec;
+            kernelTimeOut.tv_nsec = timeOut->tv_nsec;
+            argument.sigmask_sz = _NSIG / 8;
+            argument.ts = reinterpret_cast<uint64_t>(&kernelTimeOut);
+            flags |= IORING_ENTER_EXT_ARG;
+        }
+
+        auto result = syscall(
+            __NR_io_uring_enter,
+            this->handle_,
+            submitCount,
+            waitCount,
+            flags,
+            timeOut ? &argument : nullptr,
+            timeOut ? sizeof(argument) : 0);
+
+        // ETIME: the wait timed out. EINTR: a signal arrived. EBUSY: the
+        // completion queue is full, and must be drained first.
+        if (result < 0
+            && errno != ETIME
+            && errno != EINTR
+            && errno != EBUSY)
+        {
+            throw SocketError(SystemError(errno), "Failed to enter io_uring");
+        }
+    }
+
+    bool HasCompletions() const
+    {
+        return std::atomic_ref(*this->cqTail_).load(std::memory_order_acquire)
+            != *this->cqHead_;
+    }
+
+    /** Call handle with a copy of each completion, releasing it first. **/
+    template<typename Handle>
+    void ForEachCompletion(Handle &&handle)
+    {
+        auto head = *this->cqHead_;
+
+        auto tail = std::atomic_ref(*this->cqTail_).load(
+            std::memory_order_acquire);
+
+        while (head != tail)
+        {
+            auto completion = this->completions_[head & this->cqMask_];
+            ++head;
+
+            std::atomic_ref(*this->cqHead_).store(
+                head,
+                std::memory_order_release);
+
+            handle(completion);
+        }
+    }
+
+    int Register(unsigned opcode, void *argument, unsigned argumentCount)
+    {
+        return static_cast<int>(
+            syscall(
+                __NR_io_uring_register,
+                this->handle_,
+                opcode,
+                argument,
+                argumentCount));
+    }
+
+    bool IsSupported(unsigned operation)
+    {
+        static constexpr unsigned probeCount = 256;
+
+        std::vector<std::byte> storage(
+            sizeof(struct io_uring_probe)
+                + probeCount * sizeof(struct io_uring_probe_op));
+
+        auto probe = reinterpret_cast<struct io_uring_probe *>(storage.data());
+
+        if (this->Register(IORING_REGISTER_PROBE, probe, probeCount) < 0)
+        {
+            return false;
+        }
+
+        return operation <= probe->last_op
+            && (probe->ops[operation].flags & IO_URING_OP_SUPPORTED);
+    }
+
+private:
+    static int Setup_(unsigned entryCount, struct io_uring_params &parameters)
+    {
+        return static_cast<int>(
+            syscall(__NR_io_uring_setup, entryCount, &parameters));
+    }
+
+private:
+    int handle_;
+    size_t ringSize_;
+    void *ring_;
+    size_t submissionsSize_;
+    struct io_uring_sqe *submissions_;
+
+    unsigned *sqHead_;
+    unsigned *sqTail_;
+    unsigned sqMask_;
+    unsigned sqEntryCount_;
+    unsigned *sqArray_;
+    unsigned sqLocalTail_;
+
+    unsigned *cqHead_;
+    unsigned *cqTail_;
+    unsigned cqMask_;
+    struct io_uring_cqe *completions_;
+};
+
+
+/**
+ ** Receive buffers that the kernel selects from as data arrives. Used
+ ** buffers are collected, and given back to the kernel in batches, with one
+ ** IORING_OP_PROVIDE_BUFFERS request for each run of adjacent buffers.
+ **/
+class UringBufferGroup
+{
+public:
+    UringBufferGroup(
+        uint16_t groupId,
+        unsigned bufferCount,
+        size_t bufferByteCount)
+        :
+        groupId_(groupId),
+        bufferByteCount_(bufferByteCount),
+        storage_(bufferCount * bufferByteCount),
+        returned_()
+    {
+        if (bufferCount == 0 || bufferCount > 65536)
+        {
+            throw std::invalid_argument(
+                "bufferCount must be between 1 and 65536");
+        }
+
+        if (bufferByteCount > UINT32_MAX)
+        {
+            throw std::invalid_argument("bufferByteCount is too large");
+        }
+
+        this->returned_.reserve(bufferCount);
+
+        for (unsigned i = 0; i < bufferCount; ++i)
+        {
+            this->returned_.push_back(static_cast<uint16_t>(i));
+        }
+    }
+
+    uint16_t GetGroupId() const { return this->groupId_; }
+
+    std::span<const std::byte> Get(uint16_t bufferId, size_t byteCount) const
+    {
+        return {
+            this->storage_.data() + bufferId * this->bufferByteCount_,
+            byteCount};
+    }
+
+    void Return(uint16_t bufferId)
+    {
+        this->returned_.push_back(bufferId);
+    }
+
+    /** Queue requests that give the returned buffers back to the kernel. **/
+    template<typename GetSubmission>
+    void Provide(GetSubmission &&getSubmission, uint64_t userData)
+    {
+        std::sort(this->returned_.begin(), this->returned_.end());
+
+        size_t first = 0;
+
+        while (first < this->returned_.size())
+        {
+            size_t end = first + 1;
+
+            while (end < this->returned_.size()
+                && this->returned_[end] == this->returned_[end - 1] + 1)
+            {
+                ++end;
+            }
+
+            auto bufferId = this->returned_[first];
+
+            struct io_uring_sqe *submission = getSubmission();
+            submission->opcode = IORING_OP_PROVIDE_BUFFERS;
+            submission->fd = static_cast<int>(end - first);
+
+            submission->addr = reinterpret_cast<uint64_t>(
+                this->storage_.data() + bufferId * this->bufferByteCount_);
+
+            submission->len = static_cast<uint32_t>(this->bufferByteCount_);
+            submission->off = bufferId;
+            submission->buf_group = this->groupId_;
+            submission->user_data = userData;
+
+            first = end;
+        }
+
+        this->returned_.clear();
+    }
+
+private:
+    uint16_t groupId_;
+    size_t bufferByteCount_;
+    std::vector<std::byte> storage_;
+    std::vector<uint16_t> returned_;
+};
+
+
+} // end namespace detail
+
+
+class UringEngine: public IoEngine
+{
+public:
+    static constexpr unsigned defaultQueueDepth = 256;
+    static constexpr unsigned defaultBufferCount = 256;
+    static constexpr size_t defaultBufferByteCount = 16 * 1024;
+
+    // Below this, copying is cheaper than pinning pages for zero-copy.
+    static constexpr size_t defaultZeroCopyByteCount = 16 * 1024;
+
+    explicit UringEngine(
+        unsigned queueDepth = defaultQueueDepth,
+        unsigned bufferCount = defaultBufferCount,
+        size_t bufferByteCount = defaultBufferByteCount,
+        size_t zeroCopyByteCount = defaultZeroCopyByteCount)
+        :
+        buffers_(0, bufferCount, bufferByteCount),
+        queues_(queueDepth),
+        zeroCopyByteCount_(zeroCopyByteCount),
+        connections_(),
+        removed_(),
+        callbackCount_(0)
+    {
+        // Zero-copy send arrived in the same release as multishot receive,
+        // which cannot be probed directly.
+        if (!this->queues_.IsSupported(IORING_OP_SEND_ZC))
+        {
+            throw SocketError(
+                std::make_error_code(std::errc::operation_not_supported),
+                "io_uring does not support multishot receive");
+        }
+
+    }
+
+    /**
+     ** Cancels every request. Outstanding sends complete with
+     ** operation_canceled, and receive callbacks are not called.
+     **/
+    ~UringEngine() override
+    {
+        for (auto &connection: this->connections_)
+        {
+            connection.second->isRemoved = true;
+        }
+
+        auto submission = this->GetSubmission_();
+        submission->opcode = IORING_OP_ASYNC_CANCEL;
+        submission->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+        submission->user_data = Operation_::control;
+
+        // Wait a little for the cancellations, so that sends report them.
+        // Receives that remain end when the ring closes, before the
+        // buffers are freed.
+        try
+        {
+            auto timeSpec = TimeValue(std::chrono::milliseconds(100))
+                .GetAsTimespec();
+
+            for (int attempt = 0; attempt < 10 && this->IsBusy_(); ++attempt)
+            {
+                this->queues_.Enter(1, &timeSpec);
+
+                this->queues_.ForEachCompletion(
+                    [this](const struct io_uring_cqe &completion)
+                    {
+                        this->Complete_(completion);
+                    });
+            }
+        }
+        catch (...)
+        {
+
+        }
+    }
+
+    UringEngine(const UringEngine &) = delete;
+    UringEngine & operator=(const UringEngine &) = delete;
+
+    const char * GetName() const override
+    {
+        return "io_uring";
+    }
+
+    void Receive(const Socket &socket, ReceiveCallback onReceive) override
+    {
+        auto &connection = this->GetConnection_(socket.GetHandle());
+        connection.onReceive = std::move(onReceive);
+
+        if (!connection.isReceiving)
+        {
+            this->StartReceive_(connection);
+        }
+    }
+
+    void Send(
+        const Socket &socket,
+        std::span<const std::byte> data,
+        SendCallback onSent) override
+    {
+        auto &connection = this->GetConnection_(socket.GetHandle());
+        connection.sends.push_back({data, std::move(onSent)});
+
+        // One send is in flight per socket, so they cannot be reordered.
+        if (!connection.isSending)
+        {
+            this->StartSend_(connection);
+        }
+    }
+
+    void Remove(const Socket &socket) override
+    {
+        auto found = this->connections_.find(socket.GetHandle());
+
+        if (found == this->connections_.end())
+        {
+            return;
+        }
+
+        auto &connection = *found->second;
+        connection.isRemoved = true;
+
+        if (connection.isReceiving)
+        {
+            auto submission = this->GetSubmission_();
+            submission->opcode = IORING_OP_ASYNC_CANCEL;
+            submission->addr = MakeUserData_(connection, Operation_::receive);
+            submission->user_data = Operation_::control;
+        }
+
+        // Kept until the kernel has finished with it.
+        this->removed_.push_back(std::move(found->second));
+        this->connections_.erase(found);
+    }
+
+    size_t RunOnce(std::optional<TimeValue> timeOut = {}) override
+    {
+        this->callbackCount_ = 0;
+
+        this->buffers_.Provide(
+            [this]() { return this->GetSubmission_(); },
+            Operation_::control);
+
+        if (this->queues_.HasCompletions())
+        {
+            this->queues_.Enter(0);
+        }
+        else if (timeOut)
+        {
+            auto timeSpec = timeOut->GetAsTimespec();
+            this->queues_.Enter(1, &timeSpec);
+        }
+        else
+        {
+            this->queues_.Enter(1);
+        }
+
+        this->queues_.ForEachCompletion(
+            [this](const struct io_uring_cqe &completion)
+            {
+                this->Complete_(completion);
+            });
+
+        std::erase_if(
+            this->removed_,
+            [](const auto &connection)
+            {
+                return !connection->isReceiving && !connection->isSending;
+            });
+
+        return this->callbackCount_;
+    }
+
+private:
+    bool IsBusy_() const
+    {
+        auto isBusy = [](const Connection_ &connection)
+        {
+            return connection.isReceiving || connection.isSending;
+        };
+
+        for (auto &connection: this->connections_)
+        {
+            if (isBusy(*connection.second))
+            {
+                return true;
+            }
+        }
+
+        for (auto &connection: this->removed_)
+        {
+            if (isBusy(*connection))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    enum Operation_: uint64_t
+    {
+        receive = 0,
+        send = 1,
+        // Completions that need no handling.
+        control = 2,
+        operationMask = 3
+    };
+
+    struct PendingSend_
+    {
+        std::span<const std::byte> data;
+        SendCallback onSent;
+    };
+
+    struct alignas(8) Connection_
+    {
+        int handle = -1;
+        ReceiveCallback onReceive;
+        std::deque<PendingSend_> sends;
+        bool isReceiving = false;
+        bool isSending = false;
+        bool hasSendResult = false;
+        bool awaitsNotification = false;
+        int sendResult = 0;
+        bool isRemoved = false;
+    };
+
+    static uint64_t MakeUserData_(Connection_ &connection, Operation_ operation)
+    {
+        return reinterpret_cast<uint64_t>(&connection) | operation;
+    }
+
+    Connection_ & GetConnection_(int handle)
+    {
+        auto &connection = this->connections_[handle];
+
+        if (!connection)
+        {
+            connection = std::make_unique<Connection_>();
+            connection->handle = handle;
+        }
+
+        return *connection;
+    }
+
+    struct io_uring_sqe * GetSubmission_()
+    {
+        auto submission = this->queues_.GetSubmission();
+
+        while (!submission)
+        {
+            // Make room by submitting what is queued.
+            this->queues_.Enter(0);
+            submission = this->queues_.GetSubmission();
+        }
+
+        return submission;
+    }
+
+    void StartReceive_(Connection_ &connection)
+    {
+        auto submission = this->GetSubmission_();
+        submission->opcode = IORING_OP_RECV;
+        submission->fd = connection.handle;
+        submission->ioprio = IORING_RECV_MULTISHOT;
+        submission->flags = IOSQE_BUFFER_SELECT;
+        submission->buf_group = this->buffers_.GetGroupId();
+        submission->user_data =
+            MakeUserData_(connection, Operation_::receive);
+
+        connection.isReceiving = true;
+    }
+
+    void StartSend_(Connection_ &connection)
+    {
+        const auto &data = connection.sends.front().data;
+
+        auto submission = this->GetSubmission_();
+
+        submission->opcode = (data.size() >= this->zeroCopyByteCount_)
+            ? IORING_OP_SEND_ZC
+            : IORING_OP_SEND;
+
+        submission->fd = connection.handle;
+        submission->addr = reinterpret_cast<uint64_t>(data.data());
+        // Longer sends complete partially, and continue.
+        submission->len = static_cast<uint32_t>(
+            std::min<size_t>(data.size(), UINT32_MAX));
+        submission->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        submission->user_data = MakeUserData_(connection, Operation_::send);
+
+        connection.isSending = true;
+        connection.hasSendResult = false;
+        connection.awaitsNotification = false;
+    }
+
+    void Complete_(const struct io_uring_cqe &completion)
+    {
+        auto operation = completion.user_data & Operation_::operationMask;
+
+        if (operation == Operation_::control)
+        {
+            return;
+        }
+
+        auto &connection = *reinterpret_cast<Connection_ *>(
+            completion.user_data & ~uint64_t{Operation_::operationMask});
+
+        if (operation == Operation_::receive)
+        {
+            this->CompleteReceive_(connection, completion);
+        }
+        else
+        {
+            this->CompleteSend_(connection, completion);
+        }
+    }
+
+    void CompleteReceive_(
+        Connection_ &connection,
+        const struct io_uring_cqe &completion)
+    {
+        if (completion.flags & IORING_CQE_F_BUFFER)
+        {
+            auto bufferId = static_cast<uint16_t>(
+                completion.flags >> IORING_CQE_BUFFER_SHIFT);
+
+            if (completion.res > 0 && !connection.isRemoved)
+            {
+                ++this->callbackCount_;
+
+                connection.onReceive(
+                    this->buffers_.Get(
+                        bufferId,
+                        static_cast<size_t>(completion.res)));
+            }
+
+            this->buffers_.Return(bufferId);
+        }
+
+        if (completion.flags & IORING_CQE_F_MORE)
+        {
+            return;
+        }
+
+        // The multishot receive has ended.
+        connection.isReceiving = false;
+
+        if (connection.isRemoved)
+        {
+            return;
+        }
+
+        if (completion.res > 0 || completion.res == -ENOBUFS)
+        {
+            // Data arrived faster than buffers were returned.
+            this->StartReceive_(connection);
+
+            return;
+        }
+
+        // Closed, or failed. Keep the callback alive while it runs.
+        ++this->callbackCount_;
+        auto onReceive = std::move(connection.onReceive);
+        connection.onReceive = {};
+        onReceive({});
+    }
+
+    void CompleteSend_(
+        Connection_ &connection,
+        const struct io_uring_cqe &completion)
+    {
+        if (completion.flags & IORING_CQE_F_NOTIF)
+        {
+            // The kernel no longer needs the data of a zero-copy send.
+            connection.awaitsNotification = false;
+        }
+        else
+        {
+            connection.hasSendResult = true;
+            connection.sendResult = completion.res;
+
+            connection.awaitsNotification =
+                (completion.flags & IORING_CQE_F_MORE) != 0;
+        }
+
+        if (!connection.hasSendResult || connection.awaitsNotification)
+        {
+            return;
+        }
+
+        connection.isSending = false;
+
+        auto &pending = connection.sends.front();
+        std::error_code error;
+
+        if (connection.sendResult < 0)
+        {
+            error = SystemError(-connection.sendResult);
+        }
+        else
+        {
+            pending.data = pending.data.subspan(
+                static_cast<size_t>(connection.sendResult));
+
+            if (!pending.data.empty())
+            {
+                if (!connection.isRemoved)
+                {
+                    this->StartSend_(connection);
+
+                    return;
+                }
+
+                error = std::make_error_code(std::errc::operation_canceled);
+            }
+        }
+
+        auto onSent = std::move(pending.onSent);
+        connection.sends.pop_front();
+        ++this->callbackCount_;
+
+        if (connection.isRemoved)
+        {
+            onSent(error);
+            this->CancelSends_(connection);
+
+            return;
+        }
+
+        if (!connection.sends.empty())
+        {
+            this->StartSend_(connection);
+        }
+
+        onSent(error);
+    }
+
+    void CancelSends_(Connection_ &connection)
+    {
+        while (!connection.sends.empty())
+        {
+            auto onSent = std::move(connection.sends.front().onSent);
+            connection.sends.pop_front();
+            ++this->callbackCount_;
+            onSent(std::make_error_code(std::errc::operation_canceled));
+        }
+    }
+
+private:
+    // Declared first, so that it is destroyed last: closing the ring ends
+    // every receive that the kernel could still write into a buffer with.
+    detail::UringBufferGroup buffers_;
+    detail::UringQueues queues_;
+    size_t zeroCopyByteCount_;
+    std::unordered_map<int, std::unique_ptr<Connection_>> connections_;
+    std::vector<std::unique_ptr<Connection_>> removed_;
+    size_t callbackCount_;
+};
+
+
+} // end namespace jive
+
+
+#endif // JIVE_HAS_IO_URING
@@ -0,0 +1,328 @@
+/**
+  * @file string_table.h
+  *
+  * @brief Bulk serialization of many strings.
+  *
+  * WriteStringTable stores the string count, the total character count, an
+  * array of lengths, and then every string's characters back to back.
+  * ReadStringTable makes one allocation for the whole table, holding both the
+  * offsets and the characters, and StringTable returns each string as a
+  * std::string_view into it.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <ranges>
+#include <string>
+#include <string_view>
+
+#include "jive/binary_io.h"
+#include "jive/buffer.h"
+
+
+namespace jive
+{
+
+namespace io
+{
+
+
+class StringTable;
+
+
+namespace detail
+{
+
+
+template<typename CountType, typename ReadBytes>
+StringTable ReadStringTable(
+    ReadBytes &&readBytes,
+    size_t maximumByteCount,
+    std::istream *inputStream);
+
+
+} // end namespace detail
+
+
+class StringTable
+{
+public:
+    StringTable()
+        :
+        count_(0),
+        storage_(1)
+    {
+        this->storage_.Get()[0] = 0;
+    }
+
+    size_t GetCount() const { return this->count_; }
+
+    std::string_view operator[](size_t index) const
+    {
+        assert(index < this->count_);
+
+        auto offsets = this->storage_.Get();
+
+        return {
+            this->GetCharacters_() + offsets[index],
+            offsets[index + 1] - offsets[index]};
+    }
+
+    /** @return Every string, back to back. **/
+    std::string_view GetCharacters() const
+    {
+        return {
+            this->GetCharacters_(),
+            this->storage_.Get()[this->count_]};
+    }
+
+private:
+    template<typename CountType, typename ReadBytes>
+    friend StringTable detail::ReadStringTable(
+        ReadBytes &&readBytes,
+        size_t maximumByteCount,
+        std::istream *inputStream);
+
+    // Offsets (count + 1 of them) followed by the characters.
+    StringTable(size_t count, size_t characterCount)
+        :
+        count_(count),
+        storage_(
+            count + 1
+            + (characterCount + sizeof(size_t) - 1) / sizeof(size_t))
+    {
+
+    }
+
+    const char * GetCharacters_() const
+    {
+        return reinterpret_cast<const char *>(
+            this->storage_.Get() + this->count_ + 1);
+    }
+
+    char * GetCharacters_()
+    {
+        return reinterpret_cast<char *>(
+            this->storage_.Get() + this->count_ + 1);
+    }
+
+private:
+    size_t count_;
+    Buffer<size_t> storage_;
+};
+
+
+namespace detail
+{
+
+
+// Lengths are converted through a fixed block, so neither direction
+// allocates per string.
+inline constexpr size_t lengthBlockCount = 256;
+
+
+template<typename CountType, typename Strings, typename WriteBytes>
+void WriteStringTable(const Strings &strings, WriteBytes &&writeBytes)
+{
+    auto count = static_cast<size_t>(std::ranges::size(strings));
+    CheckArrayCount<CountType>(count);
+
+    uint64_t characterCount = 0;
+
+    for (std::string_view value: strings)
+    {
+        CheckStringLength<CountType>(value.size());
+        characterCount += value.size();
+    }
+
+    auto countValue = static_cast<CountType>(count);
+    writeBytes(&countValue, sizeof(countValue));
+    writeBytes(&characterCount, sizeof(characterCount));
+
+    CountType lengths[lengthBlockCount];
+    size_t blockSize = 0;
+
+    for (std::string_view value: strings)
+    {
+        lengths[blockSize++] = static_cast<CountType>(value.size());
+
+        if (blockSize == lengthBlockCount)
+        {
+            writeBytes(&lengths[0], sizeof(lengths));
+            blockSize = 0;
+        }
+    }
+
+    writeBytes(&lengths[0], blockSize * sizeof(CountType));
+
+    for (std::string_view value: strings)
+    {
+        writeBytes(value.data(), value.size());
+    }
+}
+
+
+/**
+ ** @param inputStream When given, the table must also fit in what is left
+ ** of it.
+ **/
+template<typename CountType, typename ReadBytes>
+StringTable ReadStringTable(
+    ReadBytes &&readBytes,
+    size_t maximumByteCount,
+    std::istream *inputStream)
+{
+    CountType countValue;
+    readBytes(&countValue, sizeof(countValue));
+
+    uint64_t characterCount;
+    readBytes(&characterCount, sizeof(characterCount));
+
+    // Check the untrusted header before allocating from it.
+    auto count = static_cast<size_t>(countValue);
+    auto lengthsByteCount = GetByteCount(count, sizeof(CountType));
+
+    if (lengthsByteCount > maximumByteCount
+        || characterCount > maximumByteCount - lengthsByteCount)
+    {
+        throw BinaryIoError(
+            "String table exceeds the maximum of "
+            + std::to_string(maximumByteCount) + " bytes");
+    }
+
+    if (inputStream)
+    {
+        CheckStreamHolds(
+            *inputStream,
+            lengthsByteCount + static_cast<size_t>(characterCount));
+    }
+
+    StringTable table(count, static_cast<size_t>(characterCount));
+
+    auto offsets = table.storage_.Get();
+    offsets[0] = 0;
+
+    CountType lengths[lengthBlockCount];
+    size_t index = 0;
+
+    while (index < count)
+    {
+        auto blockSize = std::min(count - index, lengthBlockCount);
+        readBytes(&lengths[0], blockSize * sizeof(CountType));
+
+        for (size_t i = 0; i < blockSize; ++i, ++index)
+        {
+            // Checked one at a time, so that a huge length cannot wrap the
+            // offsets back into range.
+            if (static_cast<uint64_t>(lengths[i])
+                > characterCount - offsets[index])
+            {
+                throw BinaryIoError(
+                    "String table lengths do not match its size");
+            }
+
+            offsets[index + 1] =
+                offsets[index] + static_cast<size_t>(lengths[i]);
+        }
+    }
+
+    if (offsets[count] != characterCount)
+    {
+        throw BinaryIoError("String table lengths do not match its size");
+    }
+
+    readBytes(table.GetCharacters_(), offsets[count]);
+
+    return table;
+}
+
+
+} // end namespace detail
+
+
+/**
+ ** @param strings A sized range of anything convertible to std::string_view.
+ ** @tparam CountType Type of the string count and of each length.
+ **/
+template<typename CountType = uint32_t, std::ranges::sized_range Strings>
+void WriteStringTable(std::ostream &outputStream, const Strings &strings)
+{
+    detail::WriteStringTable<CountType>(
+        strings,
+        [&outputStream](const void *data, size_t byteCount)
+        {
+            outputStream.write(
+                static_cast<const char *>(data),
+                static_cast<std::streamsize>(byteCount));
+        });
+}
+
+
+template<typename CountType = uint32_t, std::ranges::sized_range Strings>
+void WriteStringTable(
+    const WriteFunction &writeFunction,
+    const Strings &strings)
+{
+    detail::WriteStringTable<CountType>(
+        strings,
+        [&writeFunction](const void *data, size_t byteCount)
+        {
+            writeFunction(data, 1, byteCount);
+        });
+}
+
+
+/**
+ ** The header is untrusted, so its sizes are checked before allocating:
+ ** against maximumByteCount, which limits the lengths and characters
+ ** together, and against the size of a seekable stream.
+ **/
+template<typename CountType = uint32_t>
+StringTable ReadStringTable(
+    std::istream &inputStream,
+    size_t maximumByteCount = std::numeric_limits<size_t>::max())
+{
+    return detail::ReadStringTable<CountType>(
+        [&inputStream](void *data, size_t byteCount)
+        {
+            auto count = static_cast<std::streamsize>(byteCount);
+            inputStream.read(static_cast<char *>(data), count);
+
+            if (inputStream.gcount() != count)
+            {
+                throw BinaryIoError("Failed to extract string table");
+            }
+        },
+        maximumByteCount,
+        &inputStream);
+}
+
+
+template<typename CountType = uint32_t>
+StringTable ReadStringTable(
+    const ReadFunction &readFunction,
+    size_t maximumByteCount = std::numeric_limits<size_t>::max())
+{
+    return detail::ReadStringTable<CountType>(
+        [&readFunction](void *data, size_t byteCount)
+        {
+            readFunction(data, 1, byteCount);
+        },
+        maximumByteCount,
+        nullptr);
+}
+
+
+} // end namespace io
+
+} // end namespace jive
@@ -0,0 +1,629 @@
+/**
+  * @file varint.h
+  *
+  * @brief Variable length integer encodings for binary_io.
+  *
+  * WriteVarint and ReadVarint use LEB128: seven bits per byte, least
+  * significant group first, with the high bit set on every byte but the last.
+  * Values below 128 take one byte, and a uint64_t takes at most ten. Signed
+  * types are zigzag encoded first, so small negative values stay short.
+  *
+  * For arrays of 32-bit values, the Stream VByte format stores the byte
+  * length of each value in a separate block of 2-bit codes, so a decoder can
+  * expand four values at a time with a single byte shuffle. On x86, the
+  * shuffle is used when the processor supports SSSE3, checked at run time.
+  * Otherwise, decoding is scalar.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#include "jive/binary_io.h"
+#include "jive/detail/cpu_features.h"
+
+
+namespace jive
+{
+
+namespace io
+{
+
+
+inline constexpr size_t maximumVarintByteCount = 10;
+
+
+template<std::signed_integral T>
+constexpr std::make_unsigned_t<T> ZigZagEncode(T value)
+{
+    using U = std::make_unsigned_t<T>;
+    constexpr auto signShift = std::numeric_limits<U>::digits - 1;
+
+    return static_cast<U>(
+        (static_cast<U>(value) << 1) ^ static_cast<U>(value >> signShift));
+}
+
+
+template<std::unsigned_integral U>
+constexpr std::make_signed_t<U> ZigZagDecode(U value)
+{
+    return static_cast<std::make_signed_t<U>>(
+        (value >> 1) ^ static_cast<U>(U{0} - (value & 1u)));
+}
+
+
+namespace detail
+{
+
+
+template<std::integral T>
+constexpr auto ToVarintBits(T value)
+{
+    if constexpr (std::is_signed_v<T>)
+    {
+        return ZigZagEncode(value);
+    }
+    else
+    {
+        return value;
+    }
+}
+
+
+template<std::integral T>
+constexpr T FromVarintBits(std::make_unsigned_t<T> bits)
+{
+    if constexpr (std::is_signed_v<T>)
+    {
+        return ZigZagDecode(bits);
+    }
+    else
+    {
+        return bits;
+    }
+}
+
+
+} // end namespace detail
+
+
+template<std::integral T>
+constexpr size_t GetVarintByteCount(T value)
+{
+    auto bitCount = std::bit_width(detail::ToVarintBits(value));
+
+    return (bitCount <= 7)
+        ? 1
+        : (static_cast<size_t>(bitCount) + 6) / 7;
+}
+
+
+/**
+ ** Encode value as LEB128.
+ **
+ ** @param output Room for at least maximumVarintByteCount bytes.
+ ** @return The count of bytes written.
+ **/
+template<std::integral T>
+size_t EncodeVarint(T value, uint8_t *output)
+{
+    auto bits = detail::ToVarintBits(value);
+    size_t count = 0;
+
+    while (bits >= 0x80)
+    {
+        output[count++] = static_cast<uint8_t>(bits | 0x80);
+        bits = static_cast<decltype(bits)>(bits >> 7);
+    }
+
+    output[count++] = static_cast<uint8_t>(bits);
+
+    return count;
+}
+
+
+/**
+ ** Decode one LEB128 value from at most byteCount bytes.
+ **
+ ** @return The count of bytes consumed, or 0 if the input is truncated or
+ ** the value does not fit in T.
+ **/
+template<std::integral T>
+size_t DecodeVarint(const uint8_t *input, size_t byteCount, T &value)
+{
+    using U = std::make_unsigned_t<T>;
+    constexpr auto bitCount = std::numeric_limits<U>::digits;
+
+    if (byteCount >= maximumVarintByteCount)
+    {
+        // Enough input for the longest encoding, so accumulate without
+        // bounds checks, and validate once at the end.
+        uint64_t wide = 0;
+        size_t i = 0;
+        uint8_t byte;
+
+        do
+        {
+            byte = input[i];
+            wide |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+            ++i;
+        }
+        while ((byte & 0x80) != 0 && i < maximumVarintByteCount);
+
+        if ((byte & 0x80) != 0 || (i == maximumVarintByteCount && byte > 1))
+        {
+            return 0;
+        }
+
+        if (wide > std::numeric_limits<U>::max())
+        {
+            return 0;
+        }
+
+        value = detail::FromVarintBits<T>(static_cast<U>(wide));
+
+        return i;
+    }
+
+    U bits = 0;
+    int shift = 0;
+
+    for (size_t i = 0; i < byteCount; ++i)
+    {
+        auto byte = input[i];
+        auto group = static_cast<U>(byte & 0x7F);
+
+        if (shift >= bitCount)
+        {
+            if (group != 0)
+            {
+                // Overflow.
+                return 0;
+            }
+        }
+        else
+        {
+            if (bitCount - shift < 7 && (group >> (bitCount - shift)) != 0)
+            {
+                return 0;
+            }
+
+            bits = static_cast<U>(bits | (group << shift));
+        }
+
+        if ((byte & 0x80) == 0)
+        {
+            value = detail::FromVarintBits<T>(bits);
+
+            return i + 1;
+        }
+
+        shift += 7;
+
+        if (static_cast<size_t>(shift) >= 7 * maximumVarintByteCount)
+        {
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+
+template<std::integral T>
+void WriteVarint(std::ostream &outputStream, T value)
+{
+    uint8_t bytes[maximumVarintByteCount];
+    auto count = EncodeVarint(value, &bytes[0]);
+
+    outputStream.write(
+        reinterpret_cast<const char *>(&bytes[0]),
+        static_cast<std::streamsize>(count));
+}
+
+
+template<std::integral T>
+void WriteVarint(const WriteFunction &writeFunction, T value)
+{
+    uint8_t bytes[maximumVarintByteCount];
+    auto count = EncodeVarint(value, &bytes[0]);
+    writeFunction(&bytes[0], 1, count);
+}
+
+
+/** Write to any class with WriteBytes, like BufferedWriter. **/
+template<std::integral T, typename Writer>
+requires requires (Writer &writer, const void *data, size_t byteCount)
+{
+    writer.WriteBytes(data, byteCount);
+}
+void WriteVarint(Writer &writer, T value)
+{
+    uint8_t bytes[maximumVarintByteCount];
+    writer.WriteBytes(&bytes[0], EncodeVarint(value, &bytes[0]));
+}
+
+
+namespace detail
+{
+
+
+template<std::integral T, typename ReadByte>
+T ReadVarint(ReadByte &&readByte)
+{
+    uint8_t bytes[maximumVarintByteCount];
+
+    for (size_t i = 0; i < maximumVarintByteCount; ++i)
+    {
+        bytes[i] = readByte();
+
+        if ((bytes[i] & 0x80) == 0)
+        {
+            T value;
+
+            if (DecodeVarint(&bytes[0], i + 1, value) == 0)
+            {
+                throw BinaryIoError("Varint exceeds its type");
+            }
+
+            return value;
+        }
+    }
+
+    throw BinaryIoError("Varint is too long");
+}
+
+
+} // end namespace detail
+
+
+template<std::integral T>
+T ReadVarint(std::istream &inputStream)
+{
+    return detail::ReadVarint<T>(
+        [&inputStream]()
+        {
+            auto byte = inputStream.get();
+
+            if (byte < 0)
+            {
+                throw BinaryIoError("Failed to extract varint");
+            }
+
+            return static_cast<uint8_t>(byte);
+        });
+}
+
+
+template<std::integral T>
+T ReadVarint(const ReadFunction &readFunction)
+{
+    return detail::ReadVarint<T>(
+        [&readFunction]()
+        {
+            uint8_t byte;
+            readFunction(&byte, 1, 1);
+
+            return byte;
+        });
+}
+
+
+/** Read from any class with Read<uint8_t>, like BufferedReader. **/
+template<std::integral T, typename Reader>
+requires requires (Reader &reader)
+{
+    { reader.template Read<uint8_t>() } -> std::same_as<uint8_t>;
+}
+T ReadVarint(Reader &reader)
+{
+    return detail::ReadVarint<T>(
+        [&reader]()
+        {
+            return reader.template Read<uint8_t>();
+        });
+}
+
+
+/**
+ ** Encode every value as LEB128.
+ **
+ ** @param output Room for values.size() * maximumVarintByteCount bytes.
+ ** @return The count of bytes written.
+ **/
+template<std::integral T>
+size_t EncodeVarints(std::span<const T> values, uint8_t *output)
+{
+    size_t offset = 0;
+
+    for (auto value: values)
+    {
+        offset += EncodeVarint(value, output + offset);
+    }
+
+    return offset;
+}
+
+
+/**
+ ** Decode values.size() LEB128 values.
+ **
+ ** Runs of eight single-byte values are decoded together.
+ **
+ ** @return The count of bytes consumed, or 0 if the input is invalid.
+ **/
+template<std::integral T>
+size_t DecodeVarints(
+    const uint8_t *input,
+    size_t byteCount,
+    std::span<T> values)
+{
+    static constexpr uint64_t continuationBits = 0x8080808080808080u;
+
+    size_t offset = 0;
+    size_t index = 0;
+
+    while (index < values.size())
+    {
+        if (values.size() - index >= 8 && byteCount - offset >= 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, input + offset, sizeof(word));
+
+            if ((word & continuationBits) == 0)
+            {
+                for (size_t i = 0; i < 8; ++i)
+                {
+                    values[index + i] = detail::FromVarintBits<T>(
+                        static_cast<std::make_unsigned_t<T>>(
+                            input[offset + i]));
+                }
+
+                index += 8;
+                offset += 8;
+
+                continue;
+            }
+        }
+
+        auto consumed =
+            DecodeVarint(input + offset, byteCount - offset, values[index]);
+
+        if (consumed == 0)
+        {
+            return 0;
+        }
+
+        offset += consumed;
+        ++index;
+    }
+
+    return offset;
+}
+
+
+/** @return The largest encoding of count values as Stream VByte. **/
+constexpr size_t GetStreamVByteMaximumByteCount(size_t count)
+{
+    return (count + 3) / 4 + count * sizeof(uint32_t);
+}
+
+
+namespace detail
+{
+
+
+struct StreamVByteTable
+{
+    // Expands the data bytes of four values into four uint32_t.
+    std::array<std::array<uint8_t, 16>, 256> shuffle;
+
+    // Total data bytes of the four values.
+    std::array<uint8_t, 256> length;
+};
+
+
+constexpr StreamVByteTable MakeStreamVByteTable()
+{
+    StreamVByteTable table{};
+
+    for (size_t control = 0; control < 256; ++control)
+    {
+        size_t source = 0;
+
+        for (size_t value = 0; value < 4; ++value)
+        {
+            auto length = ((control >> (2 * value)) & 3) + 1;
+
+            for (size_t byte = 0; byte < 4; ++byte)
+            {
+                table.shuffle[control][value * 4 + byte] = (byte < length)
+                    ? static_cast<uint8_t>(source + byte)
+                    : uint8_t{0x80};
+            }
+
+            source += length;
+        }
+
+        table.length[control] = static_cast<uint8_t>(source);
+    }
+
+    return table;
+}
+
+
+alignas(16) inline constexpr StreamVByteTable streamVByteTable =
+    MakeStreamVByteTable();
+
+
+inline uint32_t GetStreamVByteLengthCode(uint32_t value)
+{
+    return (value < (1u << 8))
+        ? 0
+        : (value < (1u << 16))
+            ? 1
+            : (value < (1u << 24)) ? 2 : 3;
+}
+
+
+#if defined(JIVE_X86_DISPATCH) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+
+/**
+ ** Decode groups of four values while a whole 16 byte load stays inside
+ ** the input, advancing data past them.
+ **
+ ** @return The count of values decoded.
+ **/
+JIVE_TARGET("ssse3")
+inline size_t DecodeStreamVByteSsse3(
+    const uint8_t *controls,
+    const uint8_t *&data,
+    const uint8_t *end,
+    std::span<uint32_t> values)
+{
+    auto count = values.size();
+    size_t index = 0;
+
+    while (count - index >= 4 && end - data >= 16)
+    {
+        auto code = controls[index / 4];
+
+        auto shuffle = _mm_load_si128(
+            reinterpret_cast<const __m128i *>(
+                streamVByteTable.shuffle[code].data()));
+
+        auto bytes =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i *>(values.data() + index),
+            _mm_shuffle_epi8(bytes, shuffle));
+
+        data += streamVByteTable.length[code];
+        index += 4;
+    }
+
+    return index;
+}
+
+#endif
+
+
+} // end namespace detail
+
+
+/**
+ ** Encode values as Stream VByte: (count + 3) / 4 control bytes, then the
+ ** significant bytes of each value, least significant first.
+ **
+ ** @param output Room for GetStreamVByteMaximumByteCount(values.size()).
+ ** @return The count of bytes written.
+ **/
+inline size_t EncodeStreamVByte(
+    std::span<const uint32_t> values,
+    uint8_t *output)
+{
+    auto controlCount = (values.size() + 3) / 4;
+    std::memset(output, 0, controlCount);
+
+    auto data = output + controlCount;
+
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        auto value = values[i];
+        auto code = detail::GetStreamVByteLengthCode(value);
+
+        output[i / 4] = static_cast<uint8_t>(
+            output[i / 4] | (code << (2 * (i % 4))));
+
+        for (uint32_t byte = 0; byte <= code; ++byte)
+        {
+            *data++ = static_cast<uint8_t>(value >> (8 * byte));
+        }
+    }
+
+    return static_cast<size_t>(data - output);
+}
+
+
+/**
+ ** Decode values.size() values encoded by EncodeStreamVByte.
+ **
+ ** @return The count of bytes consumed, or 0 if the input is truncated.
+ **/
+inline size_t DecodeStreamVByte(
+    const uint8_t *input,
+    size_t byteCount,
+    std::span<uint32_t> values)
+{
+    auto count = values.size();
+    auto controlCount = (count + 3) / 4;
+
+    if (byteCount < controlCount)
+    {
+        return 0;
+    }
+
+    const uint8_t *data = input + controlCount;
+    const uint8_t *end = input + byteCount;
+    size_t index = 0;
+
+#if defined(JIVE_X86_DISPATCH) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (jive::detail::HasSsse3())
+    {
+        index = detail::DecodeStreamVByteSsse3(input, data, end, values);
+    }
+#endif
+
+    for (; index < count; ++index)
+    {
+        auto code = (input[index / 4] >> (2 * (index % 4))) & 3u;
+
+        if (static_cast<size_t>(end - data) <= code)
+        {
+            return 0;
+        }
+
+        uint32_t value = 0;
+
+        if constexpr (std::endian::native == std::endian::little)
+        {
+            if (end - data >= 4)
+            {
+                // Load four bytes and mask, avoiding a branch per byte.
+                std::memcpy(&value, data, sizeof(value));
+                value &= 0xFFFFFFFFu >> (8 * (3 - code));
+                values[index] = value;
+                data += code + 1;
+
+                continue;
+            }
+        }
+
+        for (uint32_t byte = 0; byte <= code; ++byte)
+        {
+            value |= static_cast<uint32_t>(*data++) << (8 * byte);
+        }
+
+        values[index] = value;
+    }
+
+    return static_cast<size_t>(data - input);
+}
+
+
+} // end namespace io
+
+} // end namespace jive
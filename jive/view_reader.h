@@ -0,0 +1,190 @@
+/**
+  * @file view_reader.h
+  *
+  * @brief Allocation-free deserialization from bytes already in memory.
+  *
+  * ViewReader parses the format written by binary_io.h from a span of bytes,
+  * typically a MappedBuffer. Strings and arrays are returned as views that
+  * point into the source, so the source must outlive them. Scalars are loaded
+  * with memcpy, so they may sit at any alignment.
+  *
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "jive/binary_io.h"
+#include "jive/buffer.h"
+#include "jive/endian_tools.h"
+#include "jive/optional.h"
+
+
+namespace jive
+{
+
+namespace io
+{
+
+
+class ViewReader
+{
+public:
+    explicit ViewReader(std::span<const std::byte> source)
+        :
+        source_(source),
+        position_(0)
+    {
+
+    }
+
+    template<ReadableBuffer Buffer>
+    explicit ViewReader(const Buffer &buffer)
+        :
+        ViewReader(std::as_bytes(AsSpan(buffer)))
+    {
+
+    }
+
+    /**
+     ** Read arithmetic types, standard layout structs, and std::optional of
+     ** those, by value.
+     **
+     ** std::string_view reads a string written by io::Write<std::string>,
+     ** and refers to the characters in the source.
+     **/
+    template<typename T>
+    requires (
+        (detail::EnableBinaryIo<T>::value
+            || detail::EnableOptionalIo<T>::value
+            || std::is_same_v<T, std::string_view>)
+        && !std::is_same_v<T, std::string>)
+    T Read()
+    {
+        if constexpr (std::is_same_v<T, std::string_view>)
+        {
+            return this->ReadString<uint8_t>();
+        }
+        else if constexpr (IsOptional<T>)
+        {
+            if (this->Read<uint8_t>() == 0)
+            {
+                return {};
+            }
+
+            return this->Read<RemoveOptional<T>>();
+        }
+        else
+        {
+            T value;
+            std::memcpy(&value, this->Take_(sizeof(T)).data(), sizeof(T));
+
+            return value;
+        }
+    }
+
+    /** Read a value stored in byteOrder. **/
+    template<std::endian byteOrder, Swappable T>
+    T Read()
+    {
+        return ConvertByteOrder<byteOrder>(this->Read<T>());
+    }
+
+    /** Read a string written by io::WriteString<CountType>. **/
+    template<typename CountType = uint32_t>
+    std::string_view ReadString()
+    {
+        auto count = static_cast<size_t>(this->Read<CountType>());
+        auto bytes = this->Take_(count);
+
+        return {reinterpret_cast<const char *>(bytes.data()), count};
+    }
+
+    std::span<const std::byte> ReadBytes(size_t byteCount)
+    {
+        return this->Take_(byteCount);
+    }
+
+    /**
+     ** @return A view of the next count elements of T.
+     **
+     ** The elements are used in place, so they must be suitably aligned in
+     ** the source. Throws BinaryIoError if they are not. Use ReadBytes, or
+     ** io::ReadArray, for data without alignment guarantees.
+     **/
+    template<typename T>
+    std::span<const T> ReadSpan(size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        if (count > this->GetRemaining() / sizeof(T))
+        {
+            throw BinaryIoError("Read past end of view");
+        }
+
+        auto first = this->source_.data() + this->position_;
+
+        if (reinterpret_cast<uintptr_t>(first) % alignof(T) != 0)
+        {
+            throw BinaryIoError("Array is not aligned for its element type");
+        }
+
+        this->position_ += count * sizeof(T);
+
+        return {reinterpret_cast<const T *>(first), count};
+    }
+
+    /** Read an array written by io::WriteArray<CountType>. **/
+    template<typename T, typename CountType = uint32_t>
+    std::span<const T> ReadSpan()
+    {
+        return this->ReadSpan<T>(static_cast<size_t>(this->Read<CountType>()));
+    }
+
+    void Skip(size_t byteCount)
+    {
+        this->Take_(byteCount);
+    }
+
+    size_t GetPosition() const { return this->position_; }
+
+    size_t GetRemaining() const
+    {
+        return this->source_.size() - this->position_;
+    }
+
+    bool IsEnd() const { return this->position_ == this->source_.size(); }
+
+private:
+    std::span<const std::byte> Take_(size_t byteCount)
+    {
+        if (byteCount > this->GetRemaining())
+        {
+            throw BinaryIoError("Read past end of view");
+        }
+
+        auto result = this->source_.subspan(this->position_, byteCount);
+        this->position_ += byteCount;
+
+        return result;
+    }
+
+private:
+    std::span<const std::byte> source_;
+    size_t position_;
+};
+
+
+} // end namespace io
+
+} // end namespace jive
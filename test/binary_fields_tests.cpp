@@ -0,0 +1,214 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+#include <catch2/catch.hpp>
+
+#undef str
+#include <sstream>
+
+#include <cstring>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "jive/binary_fields.h"
+#include "jive/buffered_io.h"
+#include "jive/view_reader.h"
+
+
+struct Position
+{
+    int16_t x;
+    int16_t y;
+    int16_t z;
+
+    bool operator==(const Position &) const = default;
+
+    static constexpr auto fields = std::make_tuple(
+        &Position::x,
+        &Position::y,
+        &Position::z);
+};
+
+
+struct Reading
+{
+    uint32_t id;
+    uint32_t sequence;
+    Position position;
+    uint8_t status;
+    double value;
+    std::optional<float> temperature;
+    std::string label;
+    std::vector<uint16_t> samples;
+
+    bool operator==(const Reading &) const = default;
+
+    static constexpr auto fields = std::make_tuple(
+        &Reading::id,
+        &Reading::sequence,
+        &Reading::position,
+        &Reading::status,
+        &Reading::value,
+        &Reading::temperature,
+        &Reading::label,
+        &Reading::samples);
+};
+
+
+// Declared out of memory order, so no run is contiguous.
+struct Reversed
+{
+    uint32_t first;
+    uint32_t second;
+
+    bool operator==(const Reversed &) const = default;
+
+    static constexpr auto fields =
+        std::make_tuple(&Reversed::second, &Reversed::first);
+};
+
+
+static Reading MakeReading()
+{
+    return {
+        42,
+        7,
+        {-1, 2, -3},
+        5,
+        3.5,
+        21.5f,
+        "north sensor",
+        {1, 2, 3, 4}};
+}
+
+
+TEST_CASE("Fields match a handwritten serializer.", "[binary_fields]")
+{
+    auto reading = MakeReading();
+
+    std::stringstream expected;
+    std::stringstream generated;
+
+    {
+        jive::io::BufferedWriter writer(expected);
+        writer.Write(reading.id);
+        writer.Write(reading.sequence);
+        writer.Write(reading.position.x);
+        writer.Write(reading.position.y);
+        writer.Write(reading.position.z);
+        writer.Write(reading.status);
+        writer.Write(reading.value);
+        writer.Write(reading.temperature);
+        writer.WriteString(reading.label);
+        writer.Write(static_cast<uint32_t>(reading.samples.size()));
+
+        for (auto sample: reading.samples)
+        {
+            writer.Write(sample);
+        }
+    }
+
+    {
+        jive::io::BufferedWriter writer(generated);
+        jive::io::WriteFields(writer, reading);
+    }
+
+    REQUIRE(generated.str() == expected.str());
+
+    jive::io::BufferedReader reader(generated);
+    REQUIRE(jive::io::ReadFields<Reading>(reader) == reading);
+    REQUIRE(reader.IsEnd());
+}
+
+
+TEST_CASE("Fields are read from a view.", "[binary_fields]")
+{
+    auto reading = MakeReading();
+    reading.temperature.reset();
+
+    std::stringstream stream;
+
+    {
+        jive::io::BufferedWriter writer(stream);
+        jive::io::WriteFields(writer, reading);
+        jive::io::WriteFields(writer, Reversed{1, 2});
+    }
+
+    auto bytes = stream.str();
+
+    jive::io::ViewReader reader(
+        std::as_bytes(std::span<const char>(bytes.data(), bytes.size())));
+
+    REQUIRE(jive::io::ReadFields<Reading>(reader) == reading);
+
+    // Declaration order wins over memory order.
+    REQUIRE(reader.Read<uint32_t>() == 2);
+    REQUIRE(reader.Read<uint32_t>() == 1);
+    REQUIRE(reader.IsEnd());
+
+    std::stringstream reversed;
+
+    {
+        jive::io::BufferedWriter writer(reversed);
+        jive::io::WriteFields(writer, Reversed{1, 2});
+    }
+
+    jive::io::BufferedReader reversedReader(reversed);
+
+    REQUIRE(
+        jive::io::ReadFields<Reversed>(reversedReader) == Reversed{1, 2});
+}
+
+
+TEST_CASE("Corrupt field counts throw before allocating.", "[binary_fields]")
+{
+    auto reading = MakeReading();
+    std::stringstream stream;
+
+    {
+        jive::io::BufferedWriter writer(stream);
+        jive::io::WriteFields(writer, reading);
+    }
+
+    // The samples count is the last four bytes before the samples.
+    auto bytes = stream.str();
+    auto countOffset =
+        bytes.size() - reading.samples.size() * sizeof(uint16_t) - 4;
+
+    uint32_t corruptCount = 0xFFFFFFFF;
+    std::memcpy(&bytes[countOffset], &corruptCount, sizeof(corruptCount));
+
+    jive::io::ViewReader view(
+        std::as_bytes(std::span<const char>(bytes.data(), bytes.size())));
+
+    REQUIRE_THROWS_AS(
+        jive::io::ReadFields<Reading>(view),
+        jive::io::BinaryIoError);
+
+    std::stringstream corrupt(bytes);
+    jive::io::BufferedReader reader(corrupt);
+
+    REQUIRE_THROWS_AS(
+        jive::io::ReadFields<Reading>(reader, 1024),
+        jive::io::BinaryIoError);
+
+    // The maximum applies to strings as well.
+    std::stringstream valid(stream.str());
+    jive::io::BufferedReader validReader(valid);
+
+    REQUIRE_THROWS_AS(
+        jive::io::ReadFields<Reading>(validReader, reading.label.size() - 1),
+        jive::io::BinaryIoError);
+
+    // Counts within the maximum are read.
+    valid.clear();
+    valid.seekg(0);
+    jive::io::BufferedReader rereader(valid);
+
+    REQUIRE(
+        jive::io::ReadFields<Reading>(rereader, reading.label.size())
+        == reading);
+}
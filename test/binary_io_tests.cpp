@@ -7,9 +7,17 @@
 #include <limits>
 
 #undef str
+#include <fstream>
 #include <sstream>
 
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <span>
+#include <vector>
+#include <unistd.h>
 #include "jive/binary_io.h"
 #include "jive/power.h"
 #include "jive/testing/gettys_words.h"
@@ -97,3 +105,353 @@ TEMPLATE_TEST_CASE(
 
     REQUIRE(recovered == value);
 }
+
+
+TEMPLATE_TEST_CASE(
+    "Read and write arrays in one call.",
+    "[binary_io][arrays]",
+    uint8_t,
+    int16_t,
+    uint32_t,
+    float,
+    double)
+{
+    auto count = GENERATE(take(10, random(size_t{0}, size_t{100'000})));
+
+    std::vector<TestType> values(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        values[i] = static_cast<TestType>(i * 7);
+    }
+
+    std::stringstream stream;
+    jive::io::WriteArray<uint32_t>(stream, values);
+
+    auto asVector = jive::io::ReadArray<TestType>(stream);
+    REQUIRE(asVector == values);
+
+    jive::io::WriteArray<uint64_t>(stream, values);
+
+    auto asBuffer = jive::io::ReadArray<
+        TestType,
+        uint64_t,
+        jive::Buffer<TestType>>(stream);
+
+    REQUIRE(asBuffer.GetElementCount() == count);
+    REQUIRE(std::equal(values.begin(), values.end(), asBuffer.Get()));
+
+    // Without a count, the reader supplies the size.
+    jive::io::WriteArray(stream, asBuffer);
+    std::vector<TestType> target(count);
+    jive::io::ReadArray(stream, std::span<TestType>(target));
+    REQUIRE(target == values);
+}
+
+
+TEST_CASE("Arrays are written with one call.", "[binary_io][arrays]")
+{
+    std::array<double, 100> values{};
+    std::iota(values.begin(), values.end(), 0.0);
+
+    size_t callCount = 0;
+    std::string bytes;
+
+    jive::io::WriteFunction writeFunction =
+        [&](const void * const source, size_t itemSize, size_t itemCount)
+        {
+            ++callCount;
+
+            bytes.append(
+                static_cast<const char *>(source),
+                itemSize * itemCount);
+        };
+
+    jive::io::WriteArray<uint16_t>(writeFunction, values);
+    REQUIRE(callCount == 2);
+    REQUIRE(bytes.size() == sizeof(uint16_t) + sizeof(values));
+
+    size_t offset = 0;
+
+    jive::io::ReadFunction readFunction =
+        [&](void * const target, size_t itemSize, size_t itemCount)
+        {
+            auto byteCount = itemSize * itemCount;
+
+            if (offset + byteCount > bytes.size())
+            {
+                throw jive::io::BinaryIoError("Read past end");
+            }
+
+            std::memcpy(target, bytes.data() + offset, byteCount);
+            offset += byteCount;
+        };
+
+    auto recovered = jive::io::ReadArray<double, uint16_t>(readFunction);
+    REQUIRE(std::equal(values.begin(), values.end(), recovered.begin()));
+
+    std::stringstream truncated("abc");
+    std::vector<uint32_t> tooLarge(2);
+
+    REQUIRE_THROWS_AS(
+        jive::io::ReadArray(truncated, tooLarge),
+        jive::io::BinaryIoError);
+}
+
+
+TEST_CASE("Corrupt array counts throw.", "[binary_io][arrays]")
+{
+    std::stringstream stream;
+    jive::io::Write(stream, uint64_t{1} << 60);
+    jive::io::Write(stream, 1.5);
+
+    // Fails before allocating what the count claims.
+    REQUIRE_THROWS_AS(
+        (jive::io::ReadArray<double, uint64_t>(stream)),
+        jive::io::BinaryIoError);
+
+    stream.seekg(0);
+
+    REQUIRE_THROWS_AS(
+        (jive::io::ReadArray<std::endian::native, double, uint64_t>(stream)),
+        jive::io::BinaryIoError);
+
+    std::stringstream small;
+    jive::io::WriteArray<uint32_t>(small, std::vector<int16_t>{1, 2, 3});
+
+    REQUIRE_THROWS_AS(
+        jive::io::ReadArray<int16_t>(small, 2),
+        jive::io::BinaryIoError);
+
+    small.seekg(0);
+    REQUIRE(jive::io::ReadArray<int16_t>(small, 3).size() == 3);
+}
+
+
+TEST_CASE(
+    "Endian-tagged values are stored in the requested order.",
+    "[binary_io][endian]")
+{
+    std::stringstream stream;
+
+    jive::io::Write<std::endian::big>(stream, uint32_t{0x01020304});
+    jive::io::Write<std::endian::little>(stream, uint16_t{0x0506});
+    jive::io::Write<std::endian::big>(stream, -2.5f);
+
+    auto bytes = stream.str();
+    REQUIRE(bytes.size() == 10);
+    REQUIRE(bytes.substr(0, 6) == "\x01\x02\x03\x04\x06\x05");
+
+    REQUIRE(jive::io::Read<std::endian::big, uint32_t>(stream) == 0x01020304);
+    REQUIRE(jive::io::Read<std::endian::little, uint16_t>(stream) == 0x0506);
+    REQUIRE(jive::io::Read<std::endian::big, float>(stream) == -2.5f);
+}
+
+
+TEMPLATE_TEST_CASE(
+    "Endian-tagged arrays round trip.",
+    "[binary_io][endian]",
+    int16_t,
+    uint32_t,
+    int64_t,
+    float,
+    double)
+{
+    // Larger than one conversion block.
+    std::vector<TestType> values(3000);
+    std::iota(values.begin(), values.end(), TestType{1});
+
+    std::stringstream stream;
+    jive::io::WriteArray<std::endian::big, uint32_t>(stream, values);
+
+    auto bytes = stream.str();
+
+    REQUIRE(
+        bytes.size() == sizeof(uint32_t) + values.size() * sizeof(TestType));
+    REQUIRE(bytes.substr(0, 4) == std::string("\x00\x00\x0B\xB8", 4));
+
+    auto first = jive::ConvertByteOrder<std::endian::big>(values[0]);
+
+    REQUIRE(
+        std::memcmp(bytes.data() + sizeof(uint32_t), &first, sizeof(TestType))
+        == 0);
+
+    auto recovered =
+        jive::io::ReadArray<std::endian::big, TestType, uint32_t>(stream);
+
+    REQUIRE(recovered == values);
+
+    // Function objects, without a count.
+    std::string written;
+
+    jive::io::WriteFunction writeFunction =
+        [&](const void * const source, size_t itemSize, size_t itemCount)
+        {
+            written.append(
+                static_cast<const char *>(source),
+                itemSize * itemCount);
+        };
+
+    jive::io::WriteArray<std::endian::little>(writeFunction, values);
+    REQUIRE(written.size() == values.size() * sizeof(TestType));
+
+    size_t offset = 0;
+
+    jive::io::ReadFunction readFunction =
+        [&](void * const target, size_t itemSize, size_t itemCount)
+        {
+            std::memcpy(target, written.data() + offset, itemSize * itemCount);
+            offset += itemSize * itemCount;
+        };
+
+    std::vector<TestType> target(values.size());
+    jive::io::ReadArray<std::endian::little>(readFunction, target);
+    REQUIRE(target == values);
+}
+
+
+TEST_CASE("Strings of any length round trip.", "[binary_io][strings]")
+{
+    auto length =
+        GENERATE(size_t{0}, size_t{255}, size_t{256}, size_t{70000});
+
+    std::string value(length, 'x');
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        value[i] = static_cast<char>('a' + i % 26);
+    }
+
+    std::stringstream stream;
+    jive::io::WriteString<uint64_t>(stream, value);
+    REQUIRE(jive::io::ReadString<uint64_t>(stream) == value);
+
+    if (length > 255)
+    {
+        REQUIRE_THROWS_AS(
+            jive::io::Write(stream, value),
+            std::length_error);
+
+        REQUIRE_THROWS_AS(
+            jive::io::WriteString<uint8_t>(stream, value),
+            std::length_error);
+    }
+
+    std::string bytes;
+
+    jive::io::WriteFunction writeFunction =
+        [&](const void * const source, size_t itemSize, size_t itemCount)
+        {
+            bytes.append(
+                static_cast<const char *>(source),
+                itemSize * itemCount);
+        };
+
+    jive::io::WriteString(writeFunction, value);
+    REQUIRE(bytes.size() == sizeof(uint32_t) + length);
+
+    size_t offset = 0;
+
+    jive::io::ReadFunction readFunction =
+        [&](void * const target, size_t itemSize, size_t itemCount)
+        {
+            std::memcpy(target, bytes.data() + offset, itemSize * itemCount);
+            offset += itemSize * itemCount;
+        };
+
+    REQUIRE(jive::io::ReadString(readFunction) == value);
+}
+
+
+TEST_CASE("Truncated strings throw.", "[binary_io][strings]")
+{
+    std::stringstream stream;
+    jive::io::Write(stream, uint32_t{10});
+    stream.write("abc", 3);
+
+    REQUIRE_THROWS_AS(
+        jive::io::ReadString(stream),
+        jive::io::BinaryIoError);
+
+    std::stringstream shortString;
+    shortString.put(5);
+    shortString.write("ab", 2);
+
+    REQUIRE_THROWS_AS(
+        jive::io::Read<std::string>(shortString),
+        jive::io::BinaryIoError);
+}
+
+
+// A stream buffer without seek support, like a pipe.
+class ForwardOnlyBuffer: public std::stringbuf
+{
+public:
+    using std::stringbuf::stringbuf;
+
+protected:
+    pos_type seekoff(off_type, std::ios_base::seekdir, std::ios_base::openmode)
+        override
+    {
+        return pos_type(off_type(-1));
+    }
+};
+
+
+TEST_CASE("Skip seeks or discards.", "[binary_io][skip]")
+{
+    std::string bytes(200000, 'x');
+    bytes.back() = 'y';
+
+    std::stringstream seekable(bytes);
+    jive::io::Skip(seekable, bytes.size() - 1);
+    REQUIRE(seekable.get() == 'y');
+
+    ForwardOnlyBuffer forwardOnly(bytes);
+    std::istream forwardStream(&forwardOnly);
+    REQUIRE(forwardStream.tellg() == std::istream::pos_type(-1));
+    jive::io::Skip(forwardStream, bytes.size() - 1);
+    REQUIRE(forwardStream.get() == 'y');
+
+    ForwardOnlyBuffer tooShort(bytes);
+    std::istream tooShortStream(&tooShort);
+
+    REQUIRE_THROWS_AS(
+        jive::io::Skip(tooShortStream, bytes.size() + 1),
+        jive::io::BinaryIoError);
+
+    // A file seeks past its end without failing.
+    auto path = std::filesystem::temp_directory_path()
+        / ("jive_skip_test_" + std::to_string(getpid()));
+
+    std::ofstream(path, std::ios::binary) << bytes;
+
+    {
+        std::ifstream file(path, std::ios::binary);
+        jive::io::Skip(file, bytes.size() - 1);
+        REQUIRE(file.get() == 'y');
+
+        file.seekg(0);
+
+        REQUIRE_THROWS_AS(
+            jive::io::Skip(file, bytes.size() + 1),
+            jive::io::BinaryIoError);
+    }
+
+    std::filesystem::remove(path);
+
+    size_t callCount = 0;
+    size_t offset = 0;
+
+    jive::io::ReadFunction readFunction =
+        [&](void * const target, size_t itemSize, size_t itemCount)
+        {
+            ++callCount;
+            std::memcpy(target, bytes.data() + offset, itemSize * itemCount);
+            offset += itemSize * itemCount;
+        };
+
+    jive::io::Skip(readFunction, bytes.size() - 1);
+    REQUIRE(offset == bytes.size() - 1);
+    REQUIRE(callCount < 10);
+}
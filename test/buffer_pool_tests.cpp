@@ -0,0 +1,132 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#include <catch2/catch.hpp>
+
+#include <new>
+#include <thread>
+#include <vector>
+#include "jive/buffer_pool.h"
+
+
+TEST_CASE("BufferPool recycles released blocks", "[buffer_pool]")
+{
+    auto &pool = jive::BufferPool<float, 64>::Get();
+    auto before = pool.GetStats();
+
+    void *first = nullptr;
+
+    {
+        auto buffer = pool.Acquire(1000);
+        first = buffer.Get();
+
+        REQUIRE(buffer.GetElementCount() == 1000);
+        REQUIRE(buffer.GetByteCount() == 4000);
+        REQUIRE(buffer.GetAllocatedByteCount() == 4096);
+        REQUIRE(reinterpret_cast<uintptr_t>(buffer.Get()) % 64 == 0);
+
+        REQUIRE(
+            pool.GetStats().outstandingByteCount
+                == before.outstandingByteCount + 4096);
+    }
+
+    REQUIRE(
+        pool.GetStats().outstandingByteCount == before.outstandingByteCount);
+
+    // A request in the same size class reuses the block.
+    auto second = pool.Acquire(1024);
+    REQUIRE(second.Get() == first);
+
+    auto after = pool.GetStats();
+    REQUIRE(after.hitCount == before.hitCount + 1);
+    REQUIRE(after.missCount == before.missCount + 1);
+}
+
+
+TEST_CASE("BufferPool handles are movable", "[buffer_pool]")
+{
+    auto &pool = jive::BufferPool<uint8_t>::Get();
+    auto outstanding = pool.GetStats().outstandingByteCount;
+
+    auto buffer = pool.Acquire(100);
+    auto data = buffer.Get();
+
+    jive::PooledBuffer<uint8_t> moved(std::move(buffer));
+    REQUIRE(moved.Get() == data);
+
+    moved = pool.Acquire(5000);
+    REQUIRE(moved.GetElementCount() == 5000);
+    REQUIRE(pool.GetStats().outstandingByteCount == outstanding + 8192);
+}
+
+
+TEST_CASE("BufferPool does not pool very large buffers", "[buffer_pool]")
+{
+    using Pool = jive::BufferPool<uint8_t, 16>;
+    auto &pool = Pool::Get();
+    auto before = pool.GetStats();
+
+    {
+        auto buffer = pool.Acquire(Pool::maximumPooledByteCount + 1);
+        REQUIRE(buffer.GetElementCount() == Pool::maximumPooledByteCount + 1);
+    }
+
+    auto after = pool.GetStats();
+    REQUIRE(after.missCount == before.missCount + 1);
+    REQUIRE(after.outstandingByteCount == before.outstandingByteCount);
+}
+
+
+TEST_CASE("BufferPool counts only allocations that succeed", "[buffer_pool]")
+{
+    auto &pool = jive::BufferPool<uint8_t, 16>::Get();
+    auto before = pool.GetStats();
+
+    // More than the address space holds.
+    REQUIRE_THROWS_AS(pool.Acquire(size_t{1} << 62), std::bad_alloc);
+
+    auto after = pool.GetStats();
+    REQUIRE(after.missCount == before.missCount);
+    REQUIRE(after.outstandingByteCount == before.outstandingByteCount);
+}
+
+
+TEST_CASE("BufferPool is shared between threads", "[buffer_pool]")
+{
+    auto &pool = jive::BufferPool<double>::Get();
+    auto outstanding = pool.GetStats().outstandingByteCount;
+
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        threads.emplace_back(
+            [&pool, i]()
+            {
+                std::vector<jive::PooledBuffer<double>> held;
+
+                for (size_t j = 0; j < 1000; ++j)
+                {
+                    held.push_back(pool.Acquire(8 * (i + j % 50) + 1));
+                    held.back().Get()[0] = 1.0;
+
+                    if (held.size() > 40)
+                    {
+                        held.clear();
+                    }
+                }
+            });
+    }
+
+    for (auto &thread: threads)
+    {
+        thread.join();
+    }
+
+    auto stats = pool.GetStats();
+    REQUIRE(stats.outstandingByteCount == outstanding);
+    REQUIRE(stats.GetHitRate() > 0.5);
+}
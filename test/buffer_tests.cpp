@@ -115,3 +115,74 @@ TEMPLATE_PRODUCT_TEST_CASE(
 
     }
 }
+
+
+#ifndef _WIN32
+
+#include "jive/memory_map.h"
+
+
+template<typename Buffer>
+void RequireUsable(size_t elementCount)
+{
+    Buffer buffer(elementCount);
+
+    REQUIRE(buffer.GetElementCount() == elementCount);
+    REQUIRE(reinterpret_cast<uintptr_t>(buffer.Get()) % Buffer::align == 0);
+
+    buffer.Get()[0] = 1;
+    buffer.Get()[elementCount - 1] = 2;
+
+    Buffer moved(std::move(buffer));
+    REQUIRE(moved.Get()[0] == 1);
+    REQUIRE(moved.Get()[elementCount - 1] == 2);
+}
+
+
+TEST_CASE("Buffer can be backed by mmap.", "[buffer]")
+{
+    using jive::HugePages;
+
+    auto elementCount = GENERATE(size_t{2}, size_t{5000}, size_t{3'000'000});
+
+    RequireUsable<jive::Buffer<int32_t, 64, jive::MappedAllocation<>>>(
+        elementCount);
+
+    RequireUsable<
+        jive::Buffer<
+            int32_t,
+            64,
+            jive::MappedAllocation<HugePages::none, true>>>(elementCount);
+
+    RequireUsable<jive::HugePageBuffer<int32_t>>(elementCount);
+    RequireUsable<jive::HugePageBuffer<int32_t, HugePages::transparent, true>>(
+        elementCount);
+
+    try
+    {
+        RequireUsable<jive::HugePageBuffer<int32_t, HugePages::reserved>>(
+            elementCount);
+    }
+    catch (jive::MemoryMapError &)
+    {
+        // This system has no reserved huge pages.
+    }
+}
+
+
+TEST_CASE("Mapped buffers may be empty.", "[buffer]")
+{
+    jive::Buffer<int32_t, 64, jive::MappedAllocation<>> empty(0);
+    REQUIRE(empty.GetElementCount() == 0);
+    REQUIRE(empty.Get() == nullptr);
+
+    jive::HugePageBuffer<int32_t> emptyHuge(0);
+    REQUIRE(emptyHuge.Get() == nullptr);
+
+    jive::Buffer<int32_t, 64, jive::MappedAllocation<>> moved(
+        std::move(empty));
+
+    REQUIRE(moved.GetElementCount() == 0);
+}
+
+#endif
@@ -0,0 +1,234 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+#include <catch2/catch.hpp>
+
+#undef str
+#include <sstream>
+
+#include <cstring>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "jive/buffered_io.h"
+
+
+struct Point
+{
+    int32_t x;
+    int32_t y;
+};
+
+
+TEST_CASE("BufferedWriter matches io::Write.", "[buffered_io]")
+{
+    // Small capacities force flushes between and within values.
+    auto capacity = GENERATE(size_t{1}, size_t{7}, size_t{4096});
+
+    std::stringstream expected;
+    std::stringstream buffered;
+
+    {
+        jive::io::BufferedWriter writer(buffered, capacity);
+
+        for (int16_t i = 0; i < 100; ++i)
+        {
+            jive::io::Write(expected, i);
+            writer.Write(i);
+        }
+
+        std::string name = "buffered";
+        jive::io::Write(expected, name);
+        writer.Write(name);
+
+        std::optional<double> present = 2.5;
+        std::optional<double> absent;
+        jive::io::Write(expected, present);
+        jive::io::Write(expected, absent);
+        writer.Write(present);
+        writer.Write(absent);
+
+        jive::io::Write(expected, Point{3, 4});
+        writer.Write(Point{3, 4});
+
+        jive::io::WriteString<uint16_t>(expected, "longer string");
+        writer.WriteString<uint16_t>("longer string");
+
+        jive::io::Write<std::endian::big>(expected, uint32_t{0xABCD});
+        writer.Write<std::endian::big>(uint32_t{0xABCD});
+
+        // The destructor flushes.
+    }
+
+    REQUIRE(buffered.str() == expected.str());
+}
+
+
+TEST_CASE("BufferedReader reads what BufferedWriter wrote.", "[buffered_io]")
+{
+    auto capacity = GENERATE(size_t{1}, size_t{5}, size_t{4096});
+
+    std::vector<uint64_t> values(1000);
+    std::iota(values.begin(), values.end(), uint64_t{0});
+
+    std::stringstream stream;
+
+    {
+        jive::io::BufferedWriter writer(stream, capacity);
+        writer.Write(std::string("header"));
+        writer.WriteBytes(values.data(), values.size() * sizeof(uint64_t));
+        writer.Write(std::optional<float>(1.5f));
+        writer.Write(std::optional<float>());
+        writer.Write<std::endian::big>(int16_t{-2});
+        writer.WriteString("tail");
+        writer.Flush();
+        REQUIRE(writer.GetBufferedByteCount() == 0);
+    }
+
+    jive::io::BufferedReader reader(stream, capacity);
+    REQUIRE(reader.Read<std::string>() == "header");
+
+    reader.Skip(sizeof(uint64_t));
+    std::vector<uint64_t> recovered(values.size() - 1);
+    reader.ReadBytes(recovered.data(), recovered.size() * sizeof(uint64_t));
+    REQUIRE(std::equal(recovered.begin(), recovered.end(), values.begin() + 1));
+
+    REQUIRE(reader.Read<std::optional<float>>() == 1.5f);
+    REQUIRE(!reader.Read<std::optional<float>>());
+    REQUIRE(reader.Read<std::endian::big, int16_t>() == -2);
+    REQUIRE(reader.ReadString() == "tail");
+    REQUIRE(reader.IsEnd());
+
+    REQUIRE_THROWS_AS(reader.Read<uint8_t>(), jive::io::BinaryIoError);
+}
+
+TEST_CASE("BufferedReader checks string lengths first.", "[buffered_io]")
+{
+    std::stringstream stream;
+
+    {
+        jive::io::BufferedWriter writer(stream);
+        writer.WriteString("sixteen bytes...");
+    }
+
+    {
+        jive::io::BufferedReader reader(stream);
+
+        REQUIRE_THROWS_AS(
+            reader.ReadString(15),
+            jive::io::BinaryIoError);
+    }
+
+    stream.clear();
+    stream.seekg(0);
+    jive::io::BufferedReader reader(stream);
+    REQUIRE(reader.ReadString(16) == "sixteen bytes...");
+}
+
+
+TEST_CASE("Buffered io uses file descriptors.", "[buffered_io]")
+{
+    int pipeDescriptors[2];
+    REQUIRE(pipe(pipeDescriptors) == 0);
+
+    {
+        jive::io::BufferedWriter writer(pipeDescriptors[1], 16);
+
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            writer.Write(i);
+        }
+    }
+
+    close(pipeDescriptors[1]);
+
+    jive::io::BufferedReader reader(pipeDescriptors[0], 64);
+
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        REQUIRE(reader.Read<uint32_t>() == i);
+    }
+
+    REQUIRE(reader.IsEnd());
+    close(pipeDescriptors[0]);
+}
+
+
+TEST_CASE("Writes flush through a WriteFunction in chunks.", "[buffered_io]")
+{
+    size_t callCount = 0;
+    std::string bytes;
+
+    jive::io::WriteFunction writeFunction =
+        [&](const void * const source, size_t itemSize, size_t itemCount)
+        {
+            ++callCount;
+
+            bytes.append(
+                static_cast<const char *>(source),
+                itemSize * itemCount);
+        };
+
+    {
+        jive::io::BufferedWriter writer(writeFunction, 1024);
+
+        for (uint8_t i = 0; i < 200; ++i)
+        {
+            writer.Write(uint32_t{i});
+        }
+
+        REQUIRE(callCount == 0);
+    }
+
+    REQUIRE(callCount == 1);
+    REQUIRE(bytes.size() == 800);
+}
+
+
+TEST_CASE("Descriptors skip by seeking or reading.", "[buffered_io][skip]")
+{
+    char fileName[] = "/tmp/jive_buffered_io_XXXXXX";
+    int file = mkstemp(fileName);
+    REQUIRE(file != -1);
+    unlink(fileName);
+
+    std::vector<uint32_t> values(100000);
+    std::iota(values.begin(), values.end(), uint32_t{0});
+
+    {
+        jive::io::BufferedWriter writer(file);
+        writer.WriteBytes(values.data(), values.size() * sizeof(uint32_t));
+    }
+
+    REQUIRE(lseek(file, 0, SEEK_SET) == 0);
+
+    {
+        jive::io::BufferedReader reader(file, 256);
+        REQUIRE(reader.Read<uint32_t>() == 0);
+
+        // Past the buffered bytes, so the file seeks.
+        reader.Skip(50000 * sizeof(uint32_t));
+        REQUIRE(reader.Read<uint32_t>() == 50001);
+        REQUIRE(lseek(file, 0, SEEK_CUR) < 51000 * 4);
+    }
+
+    close(file);
+
+    int pipeDescriptors[2];
+    REQUIRE(pipe(pipeDescriptors) == 0);
+    uint8_t bytes[1000]{};
+    bytes[999] = 7;
+    REQUIRE(write(pipeDescriptors[1], bytes, sizeof(bytes)) == 1000);
+    close(pipeDescriptors[1]);
+
+    jive::io::Skip(pipeDescriptors[0], 999);
+
+    jive::io::BufferedReader pipeReader(pipeDescriptors[0]);
+    REQUIRE(pipeReader.Read<uint8_t>() == 7);
+    REQUIRE_THROWS_AS(pipeReader.Skip(1), jive::io::BinaryIoError);
+    close(pipeDescriptors[0]);
+}
@@ -0,0 +1,198 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#include <catch2/catch.hpp>
+
+#include <numeric>
+#include <vector>
+#include "jive/circular_buffer.h"
+
+
+template<typename Buffer>
+void RequireWrappedRoundTrip(Buffer &buffer)
+{
+    auto capacity = buffer.GetCapacity();
+    REQUIRE(buffer.GetAvailable() == capacity);
+
+    // Move the indices near the end so that the next write wraps.
+    std::vector<uint16_t> filler(capacity - 2);
+    REQUIRE(buffer.Write(filler.data(), filler.size()));
+    buffer.Remove(filler.size());
+    REQUIRE(buffer.IsEmpty());
+
+    std::vector<uint16_t> values(5);
+    std::iota(values.begin(), values.end(), uint16_t{100});
+
+    REQUIRE(buffer.Write(values.data(), values.size()));
+    REQUIRE(buffer.GetSize() == values.size());
+    REQUIRE(buffer.GetWriteIndex() == 3);
+    REQUIRE(buffer.FrontElement() == 100);
+    REQUIRE(buffer.BackElement() == 104);
+
+    std::vector<uint16_t> recovered(values.size());
+    REQUIRE(buffer.Read(recovered.data(), recovered.size()));
+    REQUIRE(recovered == values);
+    REQUIRE(buffer.IsEmpty());
+
+    std::vector<uint16_t> tooMany(capacity + 1);
+    REQUIRE(!buffer.Write(tooMany.data(), tooMany.size()));
+}
+
+
+TEST_CASE("Fixed CircularBuffer wraps", "[circular_buffer]")
+{
+    jive::CircularBuffer<uint16_t, 16> buffer;
+    REQUIRE(buffer.GetCapacity() == 16);
+    RequireWrappedRoundTrip(buffer);
+}
+
+
+TEST_CASE("Runtime-sized CircularBuffer wraps", "[circular_buffer]")
+{
+    auto capacity = GENERATE(size_t{8}, size_t{1000}, size_t{1} << 20);
+
+    jive::DynamicCircularBuffer<uint16_t> buffer(capacity);
+    REQUIRE(buffer.GetCapacity() == capacity);
+    RequireWrappedRoundTrip(buffer);
+}
+
+
+TEST_CASE("Assigned CircularBuffer wraps at its capacity", "[circular_buffer]")
+{
+    std::vector<int> values(10);
+    std::iota(values.begin(), values.end(), 0);
+
+    jive::DynamicCircularBuffer<int> big(16);
+    REQUIRE(big.Write(values.data(), values.size()));
+
+    jive::DynamicCircularBuffer<int> small(4);
+    small = std::move(big);
+    REQUIRE(small.GetCapacity() == 16);
+
+    std::vector<int> recovered(8);
+    REQUIRE(small.Read(recovered.data(), recovered.size()));
+
+    std::vector<int> more{100, 101, 102, 103, 104, 105};
+    REQUIRE(small.Write(more.data(), more.size()));
+
+    recovered.resize(6);
+    REQUIRE(small.Read(recovered.data(), recovered.size()));
+    REQUIRE(recovered == std::vector<int>{8, 9, 100, 101, 102, 103});
+}
+
+
+TEST_CASE("Runtime-sized CircularBuffer is aligned", "[circular_buffer]")
+{
+    jive::DynamicCircularBuffer<uint8_t, jive::hugePageSize> buffer(1000);
+
+    std::vector<uint8_t> value{42};
+    REQUIRE(buffer.Write(value.data(), 1));
+
+    jive::AsPointer asPointer(buffer);
+
+    REQUIRE(
+        (reinterpret_cast<uintptr_t>(asPointer.Get()) - 1)
+            % jive::hugePageSize == 0);
+}
+
+
+TEST_CASE("Runtime-sized CircularBuffer rejects zero", "[circular_buffer]")
+{
+    REQUIRE_THROWS_AS(
+        jive::DynamicCircularBuffer<uint8_t>(0),
+        std::invalid_argument);
+}
+
+
+TEST_CASE("CircularBuffer can be filled to capacity", "[circular_buffer]")
+{
+    jive::CircularBuffer<uint8_t, 4> buffer;
+    std::vector<uint8_t> values{1, 2, 3, 4};
+
+    REQUIRE(buffer.Write(values.data(), values.size()));
+    REQUIRE(buffer.GetSize() == 4);
+    REQUIRE(!buffer.IsEmpty());
+    REQUIRE(buffer.GetAvailable() == 0);
+    REQUIRE(buffer.FrontElement() == 1);
+    REQUIRE(buffer.BackElement() == 4);
+}
+
+
+TEST_CASE("CircularBuffer overwrites the oldest elements", "[circular_buffer]")
+{
+    jive::CircularBuffer<int, 5> buffer;
+
+    for (int i = 0; i < 12; ++i)
+    {
+        buffer.Overwrite(&i, 1);
+    }
+
+    REQUIRE(buffer.GetSize() == 5);
+    REQUIRE(buffer.FrontElement() == 7);
+    REQUIRE(buffer.BackElement() == 11);
+
+    std::vector<int> newest(3);
+    REQUIRE(buffer.Snapshot(newest) == 3);
+    REQUIRE(newest == std::vector<int>{9, 10, 11});
+
+    // Snapshot does not consume.
+    REQUIRE(buffer.GetSize() == 5);
+
+    std::vector<int> all(8);
+    REQUIRE(buffer.Snapshot(all) == 5);
+    REQUIRE(std::vector<int>(all.begin(), all.begin() + 5)
+        == std::vector<int>{7, 8, 9, 10, 11});
+
+    // Writing more than the capacity keeps the newest elements.
+    std::vector<int> many(13);
+    std::iota(many.begin(), many.end(), 100);
+    buffer.Overwrite(many.data(), many.size());
+
+    std::vector<int> recovered(5);
+    REQUIRE(buffer.Read(recovered.data(), recovered.size()));
+    REQUIRE(recovered == std::vector<int>{108, 109, 110, 111, 112});
+    REQUIRE(buffer.IsEmpty());
+}
+
+
+TEST_CASE("CircularBuffer exposes its wrapped regions", "[circular_buffer]")
+{
+    jive::CircularBuffer<int, 8> buffer;
+    std::vector<int> values{1, 2, 3, 4, 5, 6};
+    REQUIRE(buffer.Write(values.data(), values.size()));
+    buffer.Remove(4);
+
+    // Free space runs from index 6 to the end, then wraps to the read index.
+    auto writable = buffer.GetWritableRegions();
+    REQUIRE(writable[0].size() == 2);
+    REQUIRE(writable[1].size() == 4);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        writable[0][static_cast<size_t>(i)] = 7 + i;
+    }
+
+    writable[1][0] = 9;
+    buffer.CommitWrite(3);
+
+    REQUIRE(buffer.GetSize() == 5);
+    REQUIRE(buffer.BackElement() == 9);
+
+    auto readable = buffer.GetReadableRegions();
+    REQUIRE(readable[0].size() == 4);
+    REQUIRE(readable[1].size() == 1);
+    REQUIRE(readable[0][0] == 5);
+    REQUIRE(readable[1][0] == 9);
+
+    buffer.Remove(5);
+    REQUIRE(buffer.GetReadableRegions()[0].empty());
+    REQUIRE(buffer.GetReadableRegions()[1].empty());
+
+    // The free space of an empty buffer still wraps at the end of storage.
+    writable = buffer.GetWritableRegions();
+    REQUIRE(writable[0].size() == 7);
+    REQUIRE(writable[1].size() == 1);
+}
@@ -65,6 +65,16 @@ TEST_CASE("CircularIndex wraps", "[circular_index]")
 }
 
 
+TEST_CASE("Assigned CircularIndex takes its wrap count", "[circular_index]")
+{
+    auto index = jive::CircularIndex<0>::Create(4);
+    index = jive::CircularIndex<0>(16, 10);
+    ++index;
+
+    REQUIRE(11 == index);
+}
+
+
 TEST_CASE("CircularIndex subtracts", "[circular_index]")
 {
     TestBuffer<1024> testBuffer;
@@ -0,0 +1,199 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#ifndef _WIN32
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "jive/socket/datagram_batch.h"
+
+
+using namespace jive;
+using namespace std::string_literals;
+
+
+static std::string AsString(std::span<const std::byte> data)
+{
+    return std::string(
+        reinterpret_cast<const char *>(data.data()),
+        data.size());
+}
+
+
+TEST_CASE("UDP sockets exchange datagrams", "[socket]")
+{
+    Socket receiver(AF_INET, SOCK_DGRAM);
+    receiver.Bind(ServiceAddress("127.0.0.1", 0));
+
+    Socket sender(AF_INET, SOCK_DGRAM);
+    sender.Bind(ServiceAddress("127.0.0.1", 0));
+
+    std::string message = "telemetry";
+
+    REQUIRE(
+        sender.SendTo(
+            message.data(),
+            message.size(),
+            receiver.GetLocalEndpoint(),
+            0) == static_cast<std::ptrdiff_t>(message.size()));
+
+    std::array<char, 64> buffer;
+    Endpoint from;
+
+    auto receivedCount =
+        receiver.ReceiveFrom(buffer.data(), buffer.size(), from, 0);
+
+    REQUIRE(receivedCount == static_cast<std::ptrdiff_t>(message.size()));
+    REQUIRE(std::string(buffer.data(), message.size()) == message);
+    REQUIRE(from.GetPort() == sender.GetLocalEndpoint().GetPort());
+}
+
+
+TEST_CASE("Datagram batches send and receive together", "[socket]")
+{
+    auto address = GENERATE(as<std::string>{}, "udp", "unix");
+    INFO(address);
+
+    Socket receiver;
+    Socket sender;
+    Endpoint destination;
+
+    if (address == "udp")
+    {
+        receiver = Socket(AF_INET, SOCK_DGRAM);
+        receiver.Bind(ServiceAddress("127.0.0.1", 0));
+        destination = receiver.GetLocalEndpoint();
+        sender = Socket(AF_INET, SOCK_DGRAM);
+    }
+    else
+    {
+        receiver = Socket(AF_UNIX, SOCK_DGRAM);
+        destination = Endpoint::Unix("\0jive_datagram_tests"s);
+        receiver.Bind(destination);
+        sender = Socket(AF_UNIX, SOCK_DGRAM);
+    }
+
+    std::vector<std::string> messages;
+    SendBatch sendBatch;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        messages.push_back("message " + std::to_string(i));
+    }
+
+    for (const auto &message: messages)
+    {
+        sendBatch.Add(std::as_bytes(std::span(message)), destination);
+    }
+
+    REQUIRE(sendBatch.GetCount() == 10);
+    REQUIRE(sendBatch.Send(sender) == 10);
+    REQUIRE(sendBatch.GetCount() == 0);
+
+    // Fewer slots than datagrams, and one slot too small for its datagram.
+    ReceiveBatch receiveBatch(8, 9);
+    REQUIRE(receiveBatch.Receive(receiver) == 8);
+    REQUIRE(AsString(receiveBatch.GetData(0)) == "message 0");
+    REQUIRE(!receiveBatch.IsTruncated(0));
+
+    REQUIRE(receiveBatch.Receive(receiver) == 2);
+    REQUIRE(AsString(receiveBatch.GetData(1)) == "message 9");
+
+    std::string longMessage = "longer than nine bytes";
+    sendBatch.Add(std::as_bytes(std::span(longMessage)), destination);
+    sendBatch.Send(sender);
+
+    REQUIRE(receiveBatch.Receive(receiver) == 1);
+    REQUIRE(receiveBatch.IsTruncated(0));
+    REQUIRE(AsString(receiveBatch.GetData(0)) == "longer th");
+
+    // Only the datagrams from the last Receive may be read.
+    REQUIRE_THROWS_AS(receiveBatch.GetData(1), std::out_of_range);
+    REQUIRE_THROWS_AS(receiveBatch.GetSender(1), std::out_of_range);
+    REQUIRE_THROWS_AS(receiveBatch.IsTruncated(8), std::out_of_range);
+
+    // MSG_TRUNC reports the full length, but only the buffer was filled.
+    sendBatch.Add(std::as_bytes(std::span(longMessage)), destination);
+    sendBatch.Send(sender);
+
+    REQUIRE(receiveBatch.Receive(receiver, MSG_WAITFORONE | MSG_TRUNC) == 1);
+    REQUIRE(receiveBatch.IsTruncated(0));
+    REQUIRE(AsString(receiveBatch.GetData(0)) == "longer th");
+
+    // Nothing is waiting.
+    REQUIRE(receiveBatch.Receive(receiver, MSG_DONTWAIT) == 0);
+}
+
+
+TEST_CASE("Connected datagram sockets need no destination", "[socket]")
+{
+    Socket receiver(AF_INET, SOCK_DGRAM);
+    receiver.Bind(ServiceAddress("127.0.0.1", 0));
+
+    Socket sender(AF_INET, SOCK_DGRAM);
+    sender.Connect(receiver.GetLocalEndpoint());
+
+    std::array<uint32_t, 3> values{1, 2, 3};
+    SendBatch sendBatch;
+
+    for (const auto &value: values)
+    {
+        sendBatch.Add(std::as_bytes(std::span(&value, 1)));
+    }
+
+    REQUIRE(sendBatch.Send(sender) == 3);
+
+    ReceiveBatch receiveBatch(4, sizeof(uint32_t));
+    size_t receivedCount = 0;
+
+    while (receivedCount < 3)
+    {
+        receivedCount += receiveBatch.Receive(receiver);
+    }
+
+    REQUIRE(receivedCount == 3);
+    REQUIRE(receiveBatch.GetSender(0).GetPort() != 0);
+}
+
+
+TEST_CASE("UDP sockets join multicast groups", "[socket]")
+{
+    Socket receiver(AF_INET, SOCK_DGRAM);
+    receiver.SetOption<options::ReuseAddress>(true);
+    receiver.Bind(ServiceAddress("0.0.0.0", 0));
+
+    Address group("239.255.42.99");
+    receiver.JoinMulticastGroup(group, Address("127.0.0.1"));
+
+    Socket sender(AF_INET, SOCK_DGRAM);
+    sender.SetMulticastInterface(Address("127.0.0.1"));
+    sender.SetOption<options::MulticastLoop>(true);
+    sender.SetOption<options::MulticastTtl>(1);
+    REQUIRE(sender.GetOption<options::MulticastTtl>() == 1);
+
+    std::string message = "multicast";
+
+    sender.SendTo(
+        message.data(),
+        message.size(),
+        ServiceAddress(group, receiver.GetLocalEndpoint().GetPort()),
+        0);
+
+    ReceiveBatch receiveBatch(1, 64);
+    REQUIRE(receiveBatch.Receive(receiver) == 1);
+    REQUIRE(AsString(receiveBatch.GetData(0)) == message);
+
+    receiver.LeaveMulticastGroup(group, Address("127.0.0.1"));
+}
+
+
+#endif
@@ -0,0 +1,187 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <vector>
+#include "jive/endian_tools.h"
+
+
+template<typename T>
+T ReverseBytesSlowly(T value)
+{
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(&bytes[0], &value, sizeof(T));
+    std::reverse(&bytes[0], &bytes[0] + sizeof(T));
+    std::memcpy(&value, &bytes[0], sizeof(T));
+
+    return value;
+}
+
+
+TEMPLATE_TEST_CASE(
+    "SwapBytes reverses every element.",
+    "[endian_tools]",
+    int16_t,
+    uint16_t,
+    int32_t,
+    uint32_t,
+    int64_t,
+    uint64_t,
+    float,
+    double)
+{
+    // Counts that exercise the vector blocks and the scalar tail.
+    auto count = GENERATE(
+        size_t{0},
+        size_t{1},
+        size_t{7},
+        size_t{16},
+        size_t{33},
+        size_t{1000});
+
+    std::vector<TestType> values(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto bits = static_cast<uint64_t>(i + 1) * 0x0102030405060708u;
+        std::memcpy(&values[i], &bits, sizeof(TestType));
+    }
+
+    std::vector<TestType> swapped(count);
+    jive::SwapBytes(values.data(), swapped.data(), count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto expected = ReverseBytesSlowly(values[i]);
+        REQUIRE(std::memcmp(&swapped[i], &expected, sizeof(TestType)) == 0);
+    }
+
+    // In place, twice, restores the original.
+    auto inPlace = values;
+    jive::SwapBytes(inPlace.data(), count);
+    jive::SwapBytes(inPlace.data(), count);
+
+    REQUIRE(
+        std::memcmp(inPlace.data(), values.data(), count * sizeof(TestType))
+        == 0);
+}
+
+
+#ifdef JIVE_X86_DISPATCH
+
+TEMPLATE_TEST_CASE(
+    "Each shuffle kernel reverses every element.",
+    "[endian_tools]",
+    uint16_t,
+    uint32_t,
+    uint64_t)
+{
+    // SwapBytes picks one kernel, so test each that this processor runs.
+    bool isAvx2 = GENERATE(true, false);
+
+    if (isAvx2 ? !jive::detail::HasAvx2() : !jive::detail::HasSsse3())
+    {
+        return;
+    }
+
+    std::vector<TestType> values(100);
+    std::iota(values.begin(), values.end(), TestType{0x0102});
+    std::vector<TestType> swapped(values.size());
+
+    auto input = reinterpret_cast<const uint8_t *>(values.data());
+    auto output = reinterpret_cast<uint8_t *>(swapped.data());
+    auto byteCount = values.size() * sizeof(TestType);
+
+    auto offset = isAvx2
+        ? jive::detail::SwapBlocksAvx2<sizeof(TestType)>(
+            input,
+            output,
+            byteCount)
+        : jive::detail::SwapBlocksSsse3<sizeof(TestType)>(
+            input,
+            output,
+            byteCount);
+
+    REQUIRE(offset == byteCount - byteCount % (isAvx2 ? 32 : 16));
+
+    for (size_t i = 0; i < offset / sizeof(TestType); ++i)
+    {
+        REQUIRE(swapped[i] == ReverseBytesSlowly(values[i]));
+    }
+}
+
+#endif
+
+
+TEST_CASE("ByteSwap matches the scalar conversions.", "[endian_tools]")
+{
+    REQUIRE(jive::ByteSwap(uint16_t{0x0102}) == 0x0201);
+    REQUIRE(jive::ByteSwap(uint32_t{0x01020304}) == 0x04030201);
+
+    REQUIRE(
+        jive::ByteSwap(uint64_t{0x0102030405060708})
+        == uint64_t{0x0807060504030201});
+
+    REQUIRE(jive::ByteSwap(int8_t{-3}) == -3);
+
+    auto value = uint32_t{0xDEADBEEF};
+
+    REQUIRE(
+        jive::ConvertByteOrder<std::endian::big>(value)
+        == jive::HostToBigEndian(value));
+
+    REQUIRE(
+        jive::ConvertByteOrder<std::endian::little>(value)
+        == jive::HostToLittleEndian(value));
+}
+
+
+TEST_CASE("Pointer ranges are converted in bulk.", "[endian_tools]")
+{
+    std::vector<uint32_t> values(100);
+    std::iota(values.begin(), values.end(), uint32_t{1});
+
+    std::vector<uint32_t> converted(values.size());
+
+    jive::HostToBigEndian(
+        values.data(),
+        values.data() + values.size(),
+        converted.data());
+
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        REQUIRE(converted[i] == jive::HostToBigEndian(values[i]));
+    }
+}
+
+
+TEST_CASE("RangeSwap swaps only for the host's other order.", "[endian_tools]")
+{
+    std::vector<uint32_t> values(100);
+    std::iota(values.begin(), values.end(), uint32_t{1});
+
+    std::vector<uint32_t> big(values.size());
+    std::vector<uint32_t> little(values.size());
+
+    jive::RangeSwap<jive::detail::ToBigEndian>(
+        values.data(),
+        values.data() + values.size(),
+        big.data());
+
+    jive::RangeSwap<jive::detail::ToLittleEndian>(
+        values.data(),
+        values.data() + values.size(),
+        little.data());
+
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        REQUIRE(big[i] == jive::HostToBigEndian(values[i]));
+        REQUIRE(little[i] == jive::HostToLittleEndian(values[i]));
+    }
+}
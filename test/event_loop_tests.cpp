@@ -0,0 +1,428 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#ifndef _WIN32
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "jive/socket/event_loop.h"
+
+
+using namespace jive;
+using namespace std::chrono_literals;
+
+
+static Socket MakeListener()
+{
+    Socket listener;
+    listener.Bind(ServiceAddress("127.0.0.1", 0));
+
+    return listener;
+}
+
+
+static void Echo(Socket &socket, EventLoop &loop)
+{
+    std::array<char, 256> buffer;
+
+    while (true)
+    {
+        auto receivedCount = socket.ReceiveWait(buffer.data(), buffer.size());
+
+        if (!receivedCount)
+        {
+            // Drained until it would block.
+            return;
+        }
+
+        if (*receivedCount == 0)
+        {
+            loop.Remove(socket.GetHandle());
+
+            return;
+        }
+
+        socket.SendWait(buffer.data(), *receivedCount);
+    }
+}
+
+
+TEST_CASE("EventLoop accepts connections and echoes", "[socket]")
+{
+    EventLoop loop;
+    auto listener = MakeListener();
+    auto address = listener.GetLocalAddress();
+    size_t acceptedCount = 0;
+
+    loop.Listen(
+        std::move(listener),
+        [&](Socket &&connection)
+        {
+            ++acceptedCount;
+
+            loop.Add(
+                std::move(connection),
+                {
+                    [&loop](Socket &socket)
+                    {
+                        Echo(socket, loop);
+                    },
+                    {}});
+        });
+
+    std::vector<Socket> clients(3);
+
+    for (auto &client: clients)
+    {
+        client.Connect(address);
+    }
+
+    while (acceptedCount < clients.size())
+    {
+        loop.RunOnce(TimeValue(1s));
+    }
+
+    REQUIRE(loop.GetCount() == 4);
+
+    for (size_t i = 0; i < clients.size(); ++i)
+    {
+        auto message = "message " + std::to_string(i);
+        clients[i].SendWait(message.data(), message.size());
+    }
+
+    for (size_t i = 0; i < clients.size(); ++i)
+    {
+        auto expected = "message " + std::to_string(i);
+        std::string received;
+        std::array<char, 64> buffer;
+
+        while (received.size() < expected.size())
+        {
+            loop.RunOnce(TimeValue(10ms));
+
+            received += std::string(
+                buffer.data(),
+                clients[i].ReceiveNoWait(buffer.data(), buffer.size()));
+        }
+
+        REQUIRE(received == expected);
+    }
+
+    // Disconnecting removes the connection from the loop.
+    clients.pop_back();
+
+    while (loop.GetCount() > 3)
+    {
+        loop.RunOnce(TimeValue(1s));
+    }
+
+    REQUIRE(loop.GetCount() == 3);
+}
+
+
+TEST_CASE("EventLoop closes removed sockets", "[socket]")
+{
+    EventLoop loop;
+    auto listener = MakeListener();
+    auto address = listener.GetLocalAddress();
+    std::optional<int> accepted;
+
+    loop.Listen(
+        std::move(listener),
+        [&](Socket &&connection)
+        {
+            accepted = connection.GetHandle();
+            loop.Add(std::move(connection), {[](Socket &) {}, {}});
+        });
+
+    Socket client;
+    client.Connect(address);
+
+    while (!accepted)
+    {
+        loop.RunOnce(TimeValue(1s));
+    }
+
+    REQUIRE(loop.Contains(*accepted));
+    REQUIRE(loop.Remove(*accepted));
+    REQUIRE(!loop.Contains(*accepted));
+    REQUIRE(!loop.Remove(*accepted));
+
+    char byte;
+    auto receivedCount = client.ReceiveWait(&byte, 1);
+    REQUIRE(receivedCount);
+    REQUIRE(*receivedCount == 0);
+}
+
+
+TEST_CASE("EventLoop runs timers in deadline order", "[socket]")
+{
+    EventLoop loop;
+    std::vector<int> fired;
+
+    loop.AddTimer(TimeValue(30ms), [&]() { fired.push_back(3); });
+    loop.AddTimer(TimeValue(10ms), [&]() { fired.push_back(1); });
+    loop.AddTimer(TimeValue(20ms), [&]() { fired.push_back(2); });
+
+    auto cancelled =
+        loop.AddTimer(TimeValue(15ms), [&]() { fired.push_back(-1); });
+
+    REQUIRE(loop.CancelTimer(cancelled));
+    REQUIRE(!loop.CancelTimer(cancelled));
+
+    auto start = TimeValue::GetNow();
+
+    while (fired.size() < 3)
+    {
+        loop.RunOnce();
+    }
+
+    REQUIRE(TimeValue::GetInterval(start) >= TimeValue(30ms));
+    REQUIRE(fired == std::vector<int>{1, 2, 3});
+}
+
+
+TEST_CASE("EventLoop repeating timer cancels itself", "[socket]")
+{
+    EventLoop loop;
+    int count = 0;
+    EventLoop::TimerId timerId = 0;
+
+    timerId = loop.AddRepeatingTimer(
+        TimeValue(1ms),
+        [&]()
+        {
+            if (++count == 3)
+            {
+                REQUIRE(loop.CancelTimer(timerId));
+            }
+        });
+
+    while (count < 3)
+    {
+        loop.RunOnce();
+    }
+
+    loop.RunOnce(TimeValue(10ms));
+
+    REQUIRE(count == 3);
+    REQUIRE_THROWS_AS(
+        loop.AddRepeatingTimer(TimeValue{}, []() {}),
+        std::invalid_argument);
+}
+
+
+TEST_CASE("EventLoop repeating timer survives an exception", "[socket]")
+{
+    EventLoop loop;
+    int count = 0;
+
+    loop.AddRepeatingTimer(
+        TimeValue(1ms),
+        [&]()
+        {
+            if (++count == 1)
+            {
+                throw std::runtime_error("first tick");
+            }
+        });
+
+    REQUIRE_THROWS_AS(
+        [&]()
+        {
+            while (true)
+            {
+                loop.RunOnce();
+            }
+        }(),
+        std::runtime_error);
+
+    // The timer keeps its callback and its schedule.
+    while (count < 3)
+    {
+        loop.RunOnce();
+    }
+}
+
+
+TEST_CASE("EventLoop runs callbacks posted from other threads", "[socket]")
+{
+    EventLoop loop;
+    auto loopThread = std::this_thread::get_id();
+    bool isOnLoopThread = false;
+
+    std::thread other(
+        [&]()
+        {
+            loop.Post(
+                [&]()
+                {
+                    isOnLoopThread = (std::this_thread::get_id() == loopThread);
+                    loop.Stop();
+                });
+        });
+
+    loop.Run();
+    other.join();
+
+    REQUIRE(isOnLoopThread);
+}
+
+
+TEST_CASE("EventLoop offloads work to the thread pool", "[socket]")
+{
+    EventLoop loop;
+    std::optional<int> result;
+    bool isDone = false;
+
+    loop.Offload(
+        []() { return 6 * 7; },
+        [&](int value) { result = value; });
+
+    loop.Offload(
+        []() {},
+        [&]() { isDone = true; });
+
+    while (!result || !isDone)
+    {
+        loop.RunOnce();
+    }
+
+    REQUIRE(*result == 42);
+
+    loop.Offload(
+        []() -> int { throw std::runtime_error("failed"); },
+        [](int) {});
+
+    REQUIRE_THROWS_AS(
+        [&]()
+        {
+            while (true)
+            {
+                loop.RunOnce();
+            }
+        }(),
+        std::runtime_error);
+}
+
+
+TEST_CASE("EventLoop keeps completions after one throws", "[socket]")
+{
+    EventLoop loop;
+    bool isDone = false;
+
+    loop.Offload(
+        []() { throw std::runtime_error("failed"); },
+        []() {});
+
+    loop.Offload(
+        []() { std::this_thread::sleep_for(20ms); },
+        [&]() { isDone = true; });
+
+    // Both completions are posted before the loop runs them, the failure
+    // first.
+    std::this_thread::sleep_for(200ms);
+
+    REQUIRE_THROWS_AS(loop.RunOnce(TimeValue(1s)), std::runtime_error);
+
+    for (int i = 0; i < 10 && !isDone; ++i)
+    {
+        loop.RunOnce(TimeValue(100ms));
+    }
+
+    REQUIRE(isDone);
+}
+
+
+TEST_CASE("EventLoop dispatches every event when a handler throws", "[socket]")
+{
+    EventLoop loop;
+    auto listener = MakeListener();
+    auto address = listener.GetLocalAddress();
+    std::vector<int> accepted;
+    std::vector<int> called;
+
+    loop.Listen(
+        std::move(listener),
+        [&](Socket &&connection)
+        {
+            accepted.push_back(connection.GetHandle());
+
+            loop.Add(
+                std::move(connection),
+                {
+                    [&called](Socket &socket)
+                    {
+                        called.push_back(socket.GetHandle());
+                        throw std::runtime_error("failed");
+                    },
+                    {}});
+        });
+
+    std::vector<Socket> clients(2);
+
+    for (auto &client: clients)
+    {
+        client.Connect(address);
+    }
+
+    while (accepted.size() < clients.size())
+    {
+        loop.RunOnce(TimeValue(1s));
+    }
+
+    for (auto &client: clients)
+    {
+        char byte = 'x';
+        client.SendWait(&byte, 1);
+    }
+
+    // Both sockets are ready before the loop waits, so they arrive in one
+    // batch.
+    std::this_thread::sleep_for(50ms);
+
+    REQUIRE_THROWS_AS(loop.RunOnce(TimeValue(1s)), std::runtime_error);
+    REQUIRE(called.size() == 2);
+}
+
+
+TEST_CASE("EventLoop keeps accepting when onAccept throws", "[socket]")
+{
+    EventLoop loop;
+    auto listener = MakeListener();
+    auto address = listener.GetLocalAddress();
+    size_t acceptedCount = 0;
+
+    loop.Listen(
+        std::move(listener),
+        [&](Socket &&)
+        {
+            if (++acceptedCount == 1)
+            {
+                throw std::runtime_error("failed");
+            }
+        });
+
+    std::vector<Socket> clients(3);
+
+    for (auto &client: clients)
+    {
+        client.Connect(address);
+    }
+
+    // The whole backlog is waiting when the listener is reported.
+    REQUIRE_THROWS_AS(loop.RunOnce(TimeValue(1s)), std::runtime_error);
+    REQUIRE(acceptedCount == clients.size());
+}
+
+
+#endif
@@ -0,0 +1,205 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#ifndef _WIN32
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "jive/socket/event_loop.h"
+#include "jive/socket/framed_channel.h"
+
+
+using namespace jive;
+using namespace std::chrono_literals;
+
+
+namespace
+{
+
+
+struct Connection
+{
+    Connection()
+        :
+        server(),
+        client()
+    {
+        Socket listener;
+        listener.Bind(ServiceAddress("127.0.0.1", 0));
+        listener.Listen();
+
+        this->client.Connect(listener.GetLocalAddress());
+        this->server = listener.Accept();
+    }
+
+    Socket server;
+    Socket client;
+};
+
+
+} // end anonymous namespace
+
+
+static std::string AsString(std::span<const std::byte> frame)
+{
+    return std::string(
+        reinterpret_cast<const char *>(frame.data()),
+        frame.size());
+}
+
+
+static std::span<const std::byte> AsBytes(const std::string &text)
+{
+    return std::as_bytes(std::span(text));
+}
+
+
+TEST_CASE("FramedChannel delivers frames whole", "[socket]")
+{
+    Connection connection;
+    FramedChannel writer(connection.client);
+    FramedChannel reader(connection.server);
+
+    writer.WriteFrame(AsBytes("first"));
+    writer.WriteFrame({});
+    writer.WriteFrame(AsBytes("third"));
+
+    REQUIRE(AsString(reader.ReadFrame()) == "first");
+    REQUIRE(reader.ReadFrame().empty());
+    REQUIRE(AsString(reader.ReadFrame()) == "third");
+    REQUIRE(!reader.NextFrame());
+}
+
+
+TEST_CASE("FramedChannel frames stay contiguous when they wrap", "[socket]")
+{
+    Connection connection;
+
+    // The buffer rounds up to a page, so these frames soon wrap its end.
+    FramedChannel writer(connection.client, 1000);
+    FramedChannel reader(connection.server, 1000);
+
+    for (size_t i = 0; i < 50; ++i)
+    {
+        std::string message(997, static_cast<char>('a' + i % 26));
+        message += std::to_string(i % 10);
+        writer.WriteFrame(AsBytes(message));
+
+        auto frame = reader.ReadFrame();
+        REQUIRE(AsString(frame) == message);
+    }
+}
+
+
+TEST_CASE("FramedChannel rejects oversized frames", "[socket]")
+{
+    Connection connection;
+    FramedChannel writer(connection.client, 64 * 1024);
+    FramedChannel reader(connection.server, 16);
+
+    std::string message(17, 'x');
+    writer.WriteFrame(AsBytes(message));
+
+    REQUIRE_THROWS_AS(reader.ReadFrame(), FrameError);
+    REQUIRE_THROWS_AS(reader.WriteFrame(AsBytes(message)), FrameError);
+}
+
+
+TEST_CASE("FramedChannel reports disconnection", "[socket]")
+{
+    Connection connection;
+    FramedChannel reader(connection.server);
+
+    // Half of a header arrives before the peer closes.
+    uint16_t partial = 0;
+    connection.client.SendWait(&partial, sizeof(partial));
+    connection.client.Close();
+
+    REQUIRE_THROWS_AS(reader.ReadFrame(), SocketDisconnected);
+    REQUIRE(reader.IsClosed());
+}
+
+
+TEST_CASE("FramedChannel dispatches frames from an EventLoop", "[socket]")
+{
+    EventLoop loop;
+    Socket listener;
+    listener.Bind(ServiceAddress("127.0.0.1", 0));
+    auto address = listener.GetLocalAddress();
+
+    std::vector<std::string> received;
+    std::unique_ptr<FramedChannel> channel;
+    bool isClosed = false;
+
+    loop.Listen(
+        std::move(listener),
+        [&](Socket &&connection)
+        {
+            loop.Add(
+                std::move(connection),
+                {
+                    [&](Socket &socket)
+                    {
+                        if (!channel)
+                        {
+                            channel = std::make_unique<FramedChannel>(socket);
+                        }
+
+                        channel->Dispatch(
+                            [&](std::span<const std::byte> frame)
+                            {
+                                received.push_back(AsString(frame));
+                            });
+
+                        if (channel->IsClosed())
+                        {
+                            isClosed = true;
+                            channel.reset();
+                            loop.Remove(socket.GetHandle());
+                        }
+                    },
+                    {}});
+        });
+
+    Socket client;
+    client.Connect(address);
+
+    std::vector<std::string> messages;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        messages.push_back(std::string(static_cast<size_t>(i), 'm'));
+    }
+
+    std::vector<std::span<const std::byte>> payloads;
+
+    for (const auto &message: messages)
+    {
+        payloads.push_back(AsBytes(message));
+    }
+
+    FramedChannel writer(client);
+    writer.WriteFrames(payloads);
+    client.Close();
+
+    while (!isClosed)
+    {
+        loop.RunOnce(TimeValue(1s));
+    }
+
+    REQUIRE(received == messages);
+}
+
+
+#endif
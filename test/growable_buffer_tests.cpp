@@ -0,0 +1,118 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#include <catch2/catch.hpp>
+
+#include <numeric>
+#include <vector>
+#include "jive/growable_buffer.h"
+
+
+static_assert(jive::ReadableBuffer<jive::GrowableBuffer<float>>);
+
+
+TEST_CASE("GrowableBuffer appends", "[growable_buffer]")
+{
+    jive::GrowableBuffer<uint32_t> buffer;
+    REQUIRE(buffer.GetElementCount() == 0);
+    REQUIRE(buffer.GetCapacity() == 0);
+
+    std::vector<uint32_t> values(100);
+    std::iota(values.begin(), values.end(), 0u);
+
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        buffer.Append(values);
+    }
+
+    buffer.Append(uint32_t{42});
+
+    REQUIRE(buffer.GetElementCount() == 100'001);
+    REQUIRE(buffer.GetCapacity() >= buffer.GetElementCount());
+    REQUIRE(buffer.Get()[0] == 0);
+    REQUIRE(buffer.Get()[99'999] == 99);
+    REQUIRE(buffer.Get()[100'000] == 42);
+
+    buffer.Clear();
+    REQUIRE(buffer.GetElementCount() == 0);
+    REQUIRE(buffer.GetCapacity() >= 100'001);
+}
+
+
+TEST_CASE("GrowableBuffer appends its own contents", "[growable_buffer]")
+{
+    jive::GrowableBuffer<uint32_t> buffer;
+    buffer.Append(uint32_t{7});
+
+    for (uint32_t i = 0; i < 20; ++i)
+    {
+        // Each append reallocates, while reading from the old storage.
+        buffer.Append(
+            std::span<const uint32_t>(buffer.Get(), buffer.GetElementCount()));
+
+        buffer.Append(buffer.Get()[0]);
+    }
+
+    REQUIRE(buffer.GetElementCount() == (1u << 21) - 1);
+
+    for (size_t i = 0; i < buffer.GetElementCount(); i += 4099)
+    {
+        REQUIRE(buffer.Get()[i] == 7);
+    }
+}
+
+
+TEST_CASE("GrowableBuffer reserves and resizes", "[growable_buffer]")
+{
+    jive::GrowableBuffer<double, 64> buffer(10);
+    REQUIRE(buffer.GetCapacity() >= 10);
+    REQUIRE(reinterpret_cast<uintptr_t>(buffer.Get()) % 64 == 0);
+
+    buffer.ResizeUninitialized(5);
+    REQUIRE(buffer.GetElementCount() == 5);
+    buffer.Get()[4] = 3.5;
+
+    auto capacity = buffer.GetCapacity();
+    buffer.Reserve(capacity - 1);
+    REQUIRE(buffer.GetCapacity() == capacity);
+
+    buffer.ResizeUninitialized(capacity + 1);
+    REQUIRE(buffer.GetCapacity() > capacity);
+    REQUIRE(buffer.Get()[4] == 3.5);
+}
+
+
+TEST_CASE("GrowableBuffer remaps large allocations", "[growable_buffer]")
+{
+    using Buffer = jive::GrowableBuffer<uint64_t>;
+    Buffer buffer;
+
+    size_t count = 0;
+
+    while (buffer.GetByteCount() < 16 * Buffer::remapByteCount)
+    {
+        buffer.ResizeUninitialized(count + 1000);
+
+        for (size_t i = count; i < count + 1000; ++i)
+        {
+            buffer.Get()[i] = i;
+        }
+
+        count += 1000;
+    }
+
+    REQUIRE(buffer.IsMapped() == Buffer::canRemap);
+
+    for (size_t i = 0; i < count; i += 997)
+    {
+        REQUIRE(buffer.Get()[i] == i);
+    }
+
+    Buffer moved(std::move(buffer));
+    REQUIRE(moved.GetElementCount() == count);
+    REQUIRE(moved.Get()[count - 1] == count - 1);
+    REQUIRE(buffer.GetElementCount() == 0);
+}
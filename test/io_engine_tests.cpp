@@ -0,0 +1,255 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#ifndef _WIN32
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "jive/socket/make_io_engine.h"
+
+
+using namespace jive;
+using namespace std::chrono_literals;
+
+
+static std::unique_ptr<IoEngine> MakeEngine(const std::string &name)
+{
+    if (name == "epoll")
+    {
+        return std::make_unique<EpollEngine>();
+    }
+
+    // Falls back to epoll when io_uring is not available.
+    return MakeIoEngine();
+}
+
+
+struct Connection
+{
+    Connection()
+        :
+        server(),
+        client()
+    {
+        Socket listener;
+        listener.Bind(ServiceAddress("127.0.0.1", 0));
+        listener.Listen();
+
+        this->client.Connect(listener.GetLocalAddress());
+        this->server = listener.Accept();
+    }
+
+    Socket server;
+    Socket client;
+};
+
+
+static std::string ReceiveExactly(Socket &socket, size_t byteCount)
+{
+    std::string result(byteCount, '\0');
+    size_t receivedCount = 0;
+
+    while (receivedCount < byteCount)
+    {
+        auto count = socket.ReceiveWait(
+            result.data() + receivedCount,
+            byteCount - receivedCount);
+
+        REQUIRE(count);
+        REQUIRE(*count > 0);
+        receivedCount += *count;
+    }
+
+    return result;
+}
+
+
+TEST_CASE("IoEngine echoes", "[socket]")
+{
+    auto engine = MakeEngine(GENERATE(as<std::string>{}, "epoll", "io_uring"));
+    INFO(engine->GetName());
+
+    Connection connection;
+    std::string received;
+    std::vector<std::string> echoes;
+    size_t sentCount = 0;
+
+    engine->Receive(
+        connection.server,
+        [&](std::span<const std::byte> data)
+        {
+            REQUIRE(!data.empty());
+
+            echoes.emplace_back(
+                reinterpret_cast<const char *>(data.data()),
+                data.size());
+
+            received += echoes.back();
+        });
+
+    std::string message = "hello, engine";
+    connection.client.SendWait(message.data(), message.size());
+
+    while (received.size() < message.size())
+    {
+        engine->RunOnce(TimeValue(1s));
+    }
+
+    REQUIRE(received == message);
+
+    for (const auto &echo: echoes)
+    {
+        engine->Send(
+            connection.server,
+            std::as_bytes(std::span(echo)),
+            [&](std::error_code error)
+            {
+                REQUIRE(!error);
+                ++sentCount;
+            });
+    }
+
+    while (sentCount < echoes.size())
+    {
+        engine->RunOnce(TimeValue(1s));
+    }
+
+    REQUIRE(ReceiveExactly(connection.client, message.size()) == message);
+
+    engine->Remove(connection.server);
+}
+
+
+TEST_CASE("IoEngine sends large buffers in order", "[socket]")
+{
+    auto engine = MakeEngine(GENERATE(as<std::string>{}, "epoll", "io_uring"));
+    INFO(engine->GetName());
+
+    Connection connection;
+
+    // Larger than the socket buffers, and than the zero-copy threshold.
+    std::vector<uint32_t> first(256 * 1024);
+    std::vector<uint32_t> second(1000);
+    std::iota(first.begin(), first.end(), uint32_t{0});
+    std::iota(second.begin(), second.end(), uint32_t(first.size()));
+
+    auto byteCount = (first.size() + second.size()) * sizeof(uint32_t);
+    std::string received;
+
+    std::thread reader(
+        [&]()
+        {
+            received = ReceiveExactly(connection.client, byteCount);
+        });
+
+    std::vector<int> order;
+
+    engine->Send(
+        connection.server,
+        std::as_bytes(std::span(first)),
+        [&](std::error_code error)
+        {
+            REQUIRE(!error);
+            order.push_back(1);
+        });
+
+    engine->Send(
+        connection.server,
+        std::as_bytes(std::span(second)),
+        [&](std::error_code error)
+        {
+            REQUIRE(!error);
+            order.push_back(2);
+        });
+
+    while (order.size() < 2)
+    {
+        engine->RunOnce(TimeValue(1s));
+    }
+
+    reader.join();
+
+    REQUIRE(order == std::vector<int>{1, 2});
+    REQUIRE(received.size() == byteCount);
+
+    std::vector<uint32_t> values(byteCount / sizeof(uint32_t));
+    std::vector<uint32_t> expected(values.size());
+    std::memcpy(values.data(), received.data(), byteCount);
+    std::iota(expected.begin(), expected.end(), uint32_t{0});
+
+    REQUIRE(values == expected);
+
+    engine->Remove(connection.server);
+}
+
+
+TEST_CASE("IoEngine reports disconnection", "[socket]")
+{
+    auto engine = MakeEngine(GENERATE(as<std::string>{}, "epoll", "io_uring"));
+    INFO(engine->GetName());
+
+    Connection connection;
+    bool isClosed = false;
+
+    engine->Receive(
+        connection.server,
+        [&](std::span<const std::byte> data)
+        {
+            if (data.empty())
+            {
+                isClosed = true;
+            }
+        });
+
+    connection.client.Close();
+
+    while (!isClosed)
+    {
+        engine->RunOnce(TimeValue(1s));
+    }
+
+    engine->Remove(connection.server);
+}
+
+
+TEST_CASE("IoEngine stops receiving after Remove", "[socket]")
+{
+    auto engine = MakeEngine(GENERATE(as<std::string>{}, "epoll", "io_uring"));
+    INFO(engine->GetName());
+
+    Connection connection;
+    size_t callbackCount = 0;
+
+    engine->Receive(
+        connection.server,
+        [&](std::span<const std::byte>)
+        {
+            ++callbackCount;
+        });
+
+    engine->RunOnce(TimeValue(1ms));
+    engine->Remove(connection.server);
+    engine->RunOnce(TimeValue(1ms));
+
+    std::string message = "ignored";
+    connection.client.SendWait(message.data(), message.size());
+    engine->RunOnce(TimeValue(10ms));
+
+    REQUIRE(callbackCount == 0);
+
+    // The data is still waiting on the socket.
+    REQUIRE(ReceiveExactly(connection.server, message.size()) == message);
+}
+
+
+#endif
@@ -0,0 +1,139 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#ifndef _WIN32
+
+#include <catch2/catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <vector>
+#include "jive/buffer.h"
+#include "jive/buffer_pool.h"
+#include "jive/mapped_buffer.h"
+
+
+static_assert(jive::ReadableBuffer<jive::Buffer<float>>);
+static_assert(jive::ReadableBuffer<jive::PooledBuffer<float>>);
+static_assert(jive::ReadableBuffer<jive::MappedBuffer<float>>);
+
+
+template<jive::ReadableBuffer Buffer>
+double Sum(const Buffer &buffer)
+{
+    auto values = jive::AsSpan(buffer);
+    return std::accumulate(values.begin(), values.end(), 0.0);
+}
+
+
+class TemporaryFile
+{
+public:
+    TemporaryFile(const std::vector<double> &values)
+        :
+        path_(
+            std::filesystem::temp_directory_path()
+            / ("jive_mapped_buffer_test_" + std::to_string(getpid())))
+    {
+        std::ofstream output(this->path_, std::ios::binary);
+
+        output.write(
+            reinterpret_cast<const char *>(values.data()),
+            static_cast<std::streamsize>(values.size() * sizeof(double)));
+    }
+
+    ~TemporaryFile()
+    {
+        std::filesystem::remove(this->path_);
+    }
+
+    std::string GetPath() const { return this->path_.string(); }
+
+private:
+    std::filesystem::path path_;
+};
+
+
+TEST_CASE("MappedBuffer reads a file without copying", "[mapped_buffer]")
+{
+    std::vector<double> values(10000);
+    std::iota(values.begin(), values.end(), 0.0);
+    TemporaryFile file(values);
+
+    jive::MappedBuffer<double> mapped(file.GetPath());
+
+    REQUIRE(mapped.GetElementCount() == values.size());
+    REQUIRE(mapped.GetByteCount() == values.size() * sizeof(double));
+    REQUIRE(mapped.Get()[1234] == 1234.0);
+
+    // The same code runs against Buffer and MappedBuffer.
+    std::ifstream input(file.GetPath(), std::ios::binary);
+    auto buffer = jive::Buffer<double>::FromStream(values.size(), input);
+    REQUIRE(Sum(mapped) == Sum(buffer));
+
+    jive::MappedBuffer<double> moved(std::move(mapped));
+    REQUIRE(moved.Get()[9999] == 9999.0);
+}
+
+
+TEST_CASE("MappedBuffer maps part of a file", "[mapped_buffer]")
+{
+    std::vector<double> values(2000);
+    std::iota(values.begin(), values.end(), 0.0);
+    TemporaryFile file(values);
+
+    // The offset does not need to be page aligned.
+    jive::MappedBuffer<double> mapped(
+        file.GetPath(),
+        jive::MapAdvice::random,
+        700 * sizeof(double),
+        100);
+
+    REQUIRE(mapped.GetElementCount() == 100);
+    REQUIRE(mapped.Get()[0] == 700.0);
+    REQUIRE(mapped.Get()[99] == 799.0);
+
+    REQUIRE_THROWS_AS(
+        jive::MappedBuffer<double>(
+            file.GetPath(),
+            jive::MapAdvice::normal,
+            0,
+            2001),
+        jive::MemoryMapError);
+}
+
+
+TEST_CASE("MappedBuffer rejects misaligned offsets", "[mapped_buffer]")
+{
+    std::vector<double> values(100);
+    TemporaryFile file(values);
+
+    REQUIRE_THROWS_AS(
+        jive::MappedBuffer<double>(
+            file.GetPath(),
+            jive::MapAdvice::normal,
+            sizeof(double) + 4),
+        jive::MemoryMapError);
+
+    // Bytes may start anywhere.
+    jive::MappedBuffer<uint8_t> bytes(
+        file.GetPath(),
+        jive::MapAdvice::normal,
+        3);
+
+    REQUIRE(bytes.GetElementCount() == 100 * sizeof(double) - 3);
+}
+
+
+TEST_CASE("MappedBuffer reports missing files", "[mapped_buffer]")
+{
+    REQUIRE_THROWS_AS(
+        jive::MappedBuffer<uint8_t>("/this/file/does/not/exist"),
+        jive::MemoryMapError);
+}
+
+#endif
@@ -0,0 +1,68 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#ifdef __linux__
+
+#include <catch2/catch.hpp>
+
+#include <numeric>
+#include <vector>
+#include "jive/mirrored_buffer.h"
+
+
+TEST_CASE("MirroredBuffer capacity fills whole pages", "[mirrored_buffer]")
+{
+    jive::MirroredBuffer<uint8_t> buffer(100);
+
+    REQUIRE(buffer.GetCapacity() % jive::GetPageSize() == 0);
+    REQUIRE(buffer.GetCapacity() >= 100);
+    REQUIRE(buffer.IsEmpty());
+    REQUIRE(buffer.GetAvailable() == buffer.GetCapacity());
+}
+
+
+TEST_CASE(
+    "MirroredBuffer regions are contiguous across the wrap",
+    "[mirrored_buffer]")
+{
+    jive::MirroredBuffer<uint32_t> buffer(1);
+    auto capacity = buffer.GetCapacity();
+
+    // Move the read index close to the physical end.
+    std::vector<uint32_t> filler(capacity - 3);
+    REQUIRE(buffer.Write(filler.data(), filler.size()));
+    buffer.Remove(filler.size());
+    REQUIRE(buffer.IsEmpty());
+
+    std::vector<uint32_t> values(10);
+    std::iota(values.begin(), values.end(), 1000u);
+
+    REQUIRE(buffer.Write(values.data(), values.size()));
+    REQUIRE(buffer.GetSize() == values.size());
+
+    // The write wrapped, but the readable region is one span.
+    auto readable = buffer.GetReadable();
+    REQUIRE(readable.size() == values.size());
+    REQUIRE(std::equal(readable.begin(), readable.end(), values.begin()));
+
+    // The physical write position wrapped back to the start.
+    REQUIRE(buffer.GetWriteIndex() == 7);
+
+    std::vector<uint32_t> recovered(values.size());
+    REQUIRE(buffer.Read(recovered.data(), recovered.size()));
+    REQUIRE(recovered == values);
+    REQUIRE(buffer.GetReadIndex() == 7);
+
+    auto writable = buffer.GetWritable();
+    REQUIRE(writable.size() == capacity);
+    writable[capacity - 1] = 42;
+    buffer.CommitWrite(capacity);
+    REQUIRE(buffer.GetAvailable() == 0);
+    REQUIRE(!buffer.Write(values.data(), 1));
+    REQUIRE(buffer.GetReadable()[capacity - 1] == 42);
+}
+
+#endif
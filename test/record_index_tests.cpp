@@ -0,0 +1,117 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+#include <catch2/catch.hpp>
+
+#undef str
+#include <sstream>
+
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "jive/binary_io.h"
+#include "jive/buffered_io.h"
+#include "jive/record_index.h"
+#include "jive/view_reader.h"
+
+
+static std::string MakeRecords(size_t count)
+{
+    std::stringstream stream;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        jive::io::WriteString<uint16_t>(
+            stream,
+            std::string(i * 10, static_cast<char>('a' + i % 26)));
+    }
+
+    return stream.str();
+}
+
+
+TEST_CASE("RecordIndex finds every record.", "[record_index]")
+{
+    auto bytes = MakeRecords(50);
+    auto source = std::as_bytes(std::span<const char>(bytes));
+
+    jive::io::ViewReader viewReader(source);
+    auto index = jive::io::RecordIndex<uint16_t>::Build(viewReader);
+
+    REQUIRE(index.GetCount() == 50);
+    REQUIRE(index.GetOffset(0) == 2);
+    REQUIRE(index.GetByteCount(3) == 30);
+
+    auto record = index.GetRecord(source, 3);
+    REQUIRE(record.size() == 30);
+    REQUIRE(static_cast<char>(record[0]) == 'd');
+
+    // The same index from a seekable stream.
+    std::stringstream stream(bytes);
+    jive::io::BufferedReader bufferedReader(stream, 64);
+    auto streamIndex = jive::io::RecordIndex<uint16_t>::Build(bufferedReader);
+    REQUIRE(streamIndex.GetCount() == 50);
+    REQUIRE(streamIndex.GetOffset(49) == index.GetOffset(49));
+
+    // Seek directly to a record's length prefix.
+    stream.clear();
+    stream.seekg(static_cast<std::streamoff>(index.GetOffset(20) - 2));
+
+    REQUIRE(
+        jive::io::ReadString<uint16_t>(stream) == std::string(200, 'u'));
+}
+
+
+TEST_CASE("RecordIndex rejects a truncated last record.", "[record_index]")
+{
+    auto bytes = MakeRecords(10);
+    bytes.resize(bytes.size() - 1);
+
+    std::stringstream stream(bytes);
+    jive::io::BufferedReader streamReader(stream, 64);
+
+    REQUIRE_THROWS_AS(
+        jive::io::RecordIndex<uint16_t>::Build(streamReader),
+        jive::io::BinaryIoError);
+
+    // A file seeks past its end without failing.
+    char fileName[] = "/tmp/jive_record_index_XXXXXX";
+    int file = mkstemp(fileName);
+    REQUIRE(file != -1);
+    unlink(fileName);
+
+    REQUIRE(
+        write(file, bytes.data(), bytes.size())
+        == static_cast<ssize_t>(bytes.size()));
+
+    REQUIRE(lseek(file, 0, SEEK_SET) == 0);
+
+    {
+        jive::io::BufferedReader fileReader(file, 64);
+
+        REQUIRE_THROWS_AS(
+            jive::io::RecordIndex<uint16_t>::Build(fileReader),
+            jive::io::BinaryIoError);
+    }
+
+    close(file);
+}
+
+
+TEST_CASE("SkipRecords skips whole records.", "[record_index]")
+{
+    auto bytes = MakeRecords(10);
+
+    jive::io::ViewReader reader(
+        std::as_bytes(std::span<const char>(bytes)));
+
+    jive::io::SkipRecords<uint16_t>(reader, 9);
+    REQUIRE(reader.ReadString<uint16_t>() == std::string(90, 'j'));
+    REQUIRE(reader.IsEnd());
+
+    REQUIRE_THROWS_AS(
+        jive::io::SkipRecords<uint16_t>(reader, 1),
+        jive::io::BinaryIoError);
+}
@@ -0,0 +1,254 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#ifndef _WIN32
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "jive/socket/rpc_client.h"
+
+
+using namespace jive;
+using namespace std::chrono_literals;
+using namespace std::string_literals;
+
+
+namespace
+{
+
+
+// Replies to every frame with the same frame, unless silent.
+class EchoServer
+{
+public:
+    explicit EchoServer(const Endpoint &endpoint)
+        :
+        isSilent(false),
+        loop_(),
+        endpoint_(),
+        thread_()
+    {
+        Socket listener(endpoint.GetFamily(), SOCK_STREAM);
+        listener.Bind(endpoint);
+        this->endpoint_ = listener.GetLocalEndpoint();
+
+        this->loop_.Listen(
+            std::move(listener),
+            [this](Socket &&connection)
+            {
+                this->Serve_(std::move(connection));
+            });
+
+        this->thread_ = std::thread(
+            [this]()
+            {
+                this->loop_.Run();
+            });
+    }
+
+    ~EchoServer()
+    {
+        this->loop_.Stop();
+        this->thread_.join();
+    }
+
+    const Endpoint & GetEndpoint() const
+    {
+        return this->endpoint_;
+    }
+
+    std::atomic<bool> isSilent;
+
+private:
+    void Serve_(Socket &&connection)
+    {
+        auto channel = std::make_shared<std::unique_ptr<FramedChannel>>();
+
+        if (this->endpoint_.GetFamily() != AF_UNIX)
+        {
+            connection.SetOption<options::NoDelay>(true);
+        }
+
+        this->loop_.Add(
+            std::move(connection),
+            {
+                [this, channel](Socket &socket)
+                {
+                    if (!*channel)
+                    {
+                        *channel = std::make_unique<FramedChannel>(socket);
+                    }
+
+                    auto &framed = **channel;
+
+                    framed.Dispatch(
+                        [this, &framed](std::span<const std::byte> frame)
+                        {
+                            if (!this->isSilent)
+                            {
+                                framed.WriteFrame(frame);
+                            }
+                        });
+
+                    if (framed.IsClosed())
+                    {
+                        channel->reset();
+                        this->loop_.Remove(socket.GetHandle());
+                    }
+                },
+                {}});
+    }
+
+    EventLoop loop_;
+    Endpoint endpoint_;
+    std::thread thread_;
+};
+
+
+} // end anonymous namespace
+
+
+static std::string AsString(const RpcClient::Response &response)
+{
+    return std::string(
+        reinterpret_cast<const char *>(response.data()),
+        response.size());
+}
+
+
+static std::future<RpcClient::Response> Call(
+    RpcClient &client,
+    const std::string &body)
+{
+    return client.Call(std::as_bytes(std::span(body)));
+}
+
+
+TEST_CASE("RpcClient pipelines requests over its connections", "[socket]")
+{
+    EchoServer server(ServiceAddress("127.0.0.1", 0));
+
+    RpcOptions options;
+    options.connectionCount = 3;
+
+    // Requests wait in the queue until the connections are up.
+    RpcClient client(server.GetEndpoint(), options);
+    std::vector<std::future<RpcClient::Response>> responses;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        responses.push_back(Call(client, "request " + std::to_string(i)));
+    }
+
+    responses.push_back(Call(client, ""));
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        auto &response = responses[static_cast<size_t>(i)];
+        REQUIRE(response.wait_for(5s) == std::future_status::ready);
+        REQUIRE(AsString(response.get()) == "request " + std::to_string(i));
+    }
+
+    REQUIRE(responses.back().get().empty());
+    REQUIRE(client.GetConnectedCount() == 3);
+}
+
+
+TEST_CASE("RpcClient rejects requests larger than a frame", "[socket]")
+{
+    EchoServer server(ServiceAddress("127.0.0.1", 0));
+
+    RpcOptions options;
+    options.maximumFrameSize = 64;
+
+    RpcClient client(server.GetEndpoint(), options);
+    auto tooLarge = Call(client, std::string(57, 'x'));
+    auto largest = Call(client, std::string(56, 'x'));
+
+    REQUIRE_THROWS_AS(tooLarge.get(), FrameError);
+    REQUIRE(largest.get().size() == 56);
+}
+
+
+TEST_CASE("RpcClient reconnects after the server restarts", "[socket]")
+{
+    auto endpoint = Endpoint::Unix("\0jive_rpc_client_tests"s);
+
+    RpcOptions options;
+    options.connectionCount = 1;
+
+    auto server = std::make_unique<EchoServer>(endpoint);
+    RpcClient client(endpoint, options);
+
+    REQUIRE(AsString(Call(client, "before").get()) == "before");
+
+    server.reset();
+
+    while (client.GetConnectedCount() != 0)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    // Waits for the next connection.
+    auto response = Call(client, "after");
+    std::this_thread::sleep_for(50ms);
+    REQUIRE(response.wait_for(0s) == std::future_status::timeout);
+
+    server = std::make_unique<EchoServer>(endpoint);
+
+    REQUIRE(response.wait_for(5s) == std::future_status::ready);
+    REQUIRE(AsString(response.get()) == "after");
+}
+
+
+TEST_CASE("RpcClient drops a connection that stops answering", "[socket]")
+{
+    EchoServer server(ServiceAddress("127.0.0.1", 0));
+
+    RpcOptions options;
+    options.connectionCount = 1;
+    options.keepAliveInterval = TimeValue(50ms);
+
+    RpcClient client(server.GetEndpoint(), options);
+    REQUIRE(AsString(Call(client, "ping").get()) == "ping");
+
+    server.isSilent = true;
+    auto response = Call(client, "unanswered");
+
+    REQUIRE(response.wait_for(5s) == std::future_status::ready);
+    REQUIRE_THROWS_AS(response.get(), SocketError);
+
+    // It reconnects to the same server.
+    server.isSilent = false;
+    REQUIRE(AsString(Call(client, "again").get()) == "again");
+}
+
+
+TEST_CASE("RpcClient fails outstanding requests when destroyed", "[socket]")
+{
+    EchoServer server(ServiceAddress("127.0.0.1", 0));
+    server.isSilent = true;
+
+    std::future<RpcClient::Response> response;
+
+    {
+        RpcClient client(server.GetEndpoint());
+        response = Call(client, "never answered");
+    }
+
+    REQUIRE_THROWS_AS(response.get(), SocketError);
+}
+
+
+#endif
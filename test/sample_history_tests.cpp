@@ -0,0 +1,75 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#include <catch2/catch.hpp>
+
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "jive/sample_history.h"
+
+
+TEST_CASE("SampleHistory keeps the newest samples", "[sample_history]")
+{
+    jive::SampleHistory<double, 8> history;
+
+    std::vector<double> empty(4);
+    REQUIRE(history.Snapshot(empty) == 0);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        history.Write(static_cast<double>(i));
+    }
+
+    REQUIRE(history.GetWriteCount() == 20);
+
+    std::vector<double> newest(3);
+    REQUIRE(history.Snapshot(newest) == 3);
+    REQUIRE(newest == std::vector<double>{17.0, 18.0, 19.0});
+
+    std::vector<double> all(10);
+    REQUIRE(history.Snapshot(all) == 8);
+    REQUIRE(all[0] == 12.0);
+    REQUIRE(all[7] == 19.0);
+}
+
+
+TEST_CASE("SampleHistory readers never see torn copies", "[sample_history]")
+{
+    static constexpr size_t sampleCount = 1'000'000;
+    jive::SampleHistory<uint64_t, 64> history;
+
+    std::thread producer(
+        [&history]()
+        {
+            std::vector<uint64_t> batch(5);
+
+            for (uint64_t i = 0; i < sampleCount; i += batch.size())
+            {
+                std::iota(batch.begin(), batch.end(), i);
+                history.Write(batch.data(), batch.size());
+            }
+        });
+
+    std::vector<uint64_t> snapshot(16);
+    size_t checkedCount = 0;
+
+    while (history.GetWriteCount() < sampleCount)
+    {
+        auto count = history.Snapshot(snapshot);
+
+        for (size_t i = 1; i < count; ++i)
+        {
+            REQUIRE(snapshot[i] == snapshot[i - 1] + 1);
+        }
+
+        ++checkedCount;
+    }
+
+    producer.join();
+
+    REQUIRE(checkedCount > 0);
+}
@@ -0,0 +1,202 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+
+#ifndef _WIN32
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "jive/socket/server.h"
+
+
+using namespace jive;
+using namespace std::chrono_literals;
+
+
+static void Echo(Socket &socket, EventLoop &loop)
+{
+    std::array<char, 256> buffer;
+
+    while (auto receivedCount =
+            socket.ReceiveWait(buffer.data(), buffer.size()))
+    {
+        if (*receivedCount == 0)
+        {
+            loop.Remove(socket.GetHandle());
+
+            return;
+        }
+
+        socket.SendWait(buffer.data(), *receivedCount);
+    }
+}
+
+
+static void AddEcho(EventLoop &loop, Socket &&connection)
+{
+    loop.Add(
+        std::move(connection),
+        {
+            [&loop](Socket &socket)
+            {
+                Echo(socket, loop);
+            },
+            {}});
+}
+
+
+TEST_CASE("Server workers share one port", "[socket]")
+{
+    std::mutex mutex;
+    std::set<std::thread::id> acceptingThreads;
+
+    Server server(
+        ServiceAddress("127.0.0.1", 0),
+        [&](EventLoop &loop, Socket &&connection)
+        {
+            {
+                std::lock_guard lock(mutex);
+                acceptingThreads.insert(std::this_thread::get_id());
+            }
+
+            AddEcho(loop, std::move(connection));
+        },
+        4);
+
+    REQUIRE(server.GetWorkerCount() == 4);
+    REQUIRE(server.GetAddress().port != 0);
+
+    // The kernel hashes each connection to a listener, so 64 connections
+    // reach more than one worker.
+    std::vector<Socket> clients(64);
+
+    for (auto &client: clients)
+    {
+        client.Connect(server.GetAddress());
+    }
+
+    uint32_t value = 0;
+
+    for (auto &client: clients)
+    {
+        ++value;
+        client.SendWait(&value, sizeof(value));
+
+        uint32_t echoed = 0;
+        REQUIRE(client.ReceiveWait(&echoed, sizeof(echoed)) == sizeof(echoed));
+        REQUIRE(echoed == value);
+    }
+
+    server.Stop();
+
+    REQUIRE(acceptingThreads.size() > 1);
+}
+
+
+TEST_CASE("Server posts to a worker", "[socket]")
+{
+    Server server(ServiceAddress("127.0.0.1", 0), AddEcho, 2);
+
+    std::atomic<bool> isDone = false;
+    std::thread::id workerThread;
+
+    server.Post(
+        1,
+        [&](EventLoop &)
+        {
+            workerThread = std::this_thread::get_id();
+            isDone = true;
+        });
+
+    while (!isDone)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    REQUIRE(workerThread != std::this_thread::get_id());
+    REQUIRE_THROWS_AS(server.Post(2, [](EventLoop &) {}), std::out_of_range);
+}
+
+
+TEST_CASE("Server rethrows a worker's exception from Stop", "[socket]")
+{
+    Server server(ServiceAddress("127.0.0.1", 0), AddEcho, 1);
+    std::atomic<bool> isThrowing = false;
+
+    server.Post(
+        0,
+        [&](EventLoop &)
+        {
+            isThrowing = true;
+
+            throw std::runtime_error("worker failed");
+        });
+
+    // Stopping first could end the worker before the callback runs.
+    while (!isThrowing)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    REQUIRE_THROWS_WITH(server.Stop(), "worker failed");
+
+    // The error is reported once.
+    REQUIRE_NOTHROW(server.Stop());
+}
+
+
+TEST_CASE("Server keeps accepting after a callback throws", "[socket]")
+{
+    std::atomic<size_t> connectionCount = 0;
+
+    Server server(
+        ServiceAddress("127.0.0.1", 0),
+        [&](EventLoop &loop, Socket &&connection)
+        {
+            if (++connectionCount == 1)
+            {
+                throw std::runtime_error("connection failed");
+            }
+
+            AddEcho(loop, std::move(connection));
+        },
+        1);
+
+    Socket first;
+    first.Connect(server.GetAddress());
+
+    while (connectionCount < 1)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    Socket second;
+    second.Connect(server.GetAddress());
+
+    char sent = 'x';
+    second.SendWait(&sent, 1);
+
+    char received = 0;
+    auto receivedCount = second.ReceiveWait(&received, 1);
+
+    REQUIRE(receivedCount);
+    REQUIRE(*receivedCount == 1);
+    REQUIRE(received == sent);
+    REQUIRE(connectionCount == 2);
+
+    REQUIRE_THROWS_WITH(server.Stop(), "connection failed");
+}
+
+
+#endif
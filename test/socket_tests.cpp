@@ -9,8 +9,18 @@
 
 #include <catch2/catch.hpp>
 
+#include <array>
+#include <cstring>
+#include <numeric>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "jive/socket/socket.h"
 #include "jive/socket/address.h"
+#include "jive/socket/client.h"
+#include "jive/socket/tuning.h"
 
 
 TEST_CASE("Ill-formed address is detected", "[socket]")
@@ -29,4 +39,524 @@ TEST_CASE("Ill-formed address is detected", "[socket]")
     }
 }
 
+
+namespace
+{
+
+
+struct Header
+{
+    uint32_t id;
+    uint32_t byteCount;
+};
+
+
+struct Reading
+{
+    int32_t x;
+    int32_t y;
+};
+
+
+} // end anonymous namespace
+
+
+static std::string ReceiveExactly(const jive::Socket &socket, size_t count)
+{
+    std::string result(count, '\0');
+    size_t receivedCount = 0;
+
+    while (receivedCount < count)
+    {
+        auto increment = socket.ReceiveWait(
+            result.data() + receivedCount,
+            count - receivedCount);
+
+        REQUIRE(increment);
+        REQUIRE(*increment > 0);
+        receivedCount += *increment;
+    }
+
+    return result;
+}
+
+
+TEST_CASE("Socket gathers and scatters buffers", "[socket]")
+{
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    listener.Listen();
+
+    jive::Socket client;
+    client.Connect(listener.GetLocalAddress());
+    auto server = listener.Accept();
+
+    const jive::ServiceAddress &connected = client.GetConnectedAddress();
+    REQUIRE(connected.port == listener.GetLocalAddress().port);
+
+    std::string first = "head";
+    std::string second = "payload";
+
+    std::array<iovec, 2> sendBuffers{
+        iovec{first.data(), first.size()},
+        iovec{second.data(), second.size()}};
+
+    REQUIRE(client.SendVector(sendBuffers, 0) == 11);
+
+    std::array<char, 6> a{};
+    std::array<char, 5> b{};
+
+    std::array<iovec, 2> receiveBuffers{
+        iovec{a.data(), a.size()},
+        iovec{b.data(), b.size()}};
+
+    size_t receivedCount = 0;
+
+    while (receivedCount < 11)
+    {
+        auto count = server.ReceiveVector(receiveBuffers, 0);
+        REQUIRE(count > 0);
+        receivedCount += static_cast<size_t>(count);
+
+        // Continue where the previous call stopped.
+        auto remaining = static_cast<size_t>(count);
+
+        for (auto &buffer: receiveBuffers)
+        {
+            auto used = std::min(remaining, buffer.iov_len);
+            buffer.iov_base = static_cast<char *>(buffer.iov_base) + used;
+            buffer.iov_len -= used;
+            remaining -= used;
+        }
+    }
+
+    REQUIRE(std::string(a.data(), a.size()) == "headpa");
+    REQUIRE(std::string(b.data(), b.size()) == "yload");
+}
+
+
+TEST_CASE("Client writes many objects at once", "[socket]")
+{
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    listener.Listen();
+
+    jive::Client<32> client(listener.GetLocalAddress());
+    auto server = listener.Accept();
+
+    Header header{7, sizeof(Reading) * 2};
+    Reading first{1, 2};
+    Reading second{3, 4};
+
+    client.WriteMany(header, first, second);
+
+    auto received = ReceiveExactly(
+        server,
+        sizeof(Header) + 2 * sizeof(Reading));
+
+    Header receivedHeader;
+    std::array<Reading, 2> readings;
+    std::memcpy(&receivedHeader, received.data(), sizeof(Header));
+
+    std::memcpy(
+        readings.data(),
+        received.data() + sizeof(Header),
+        sizeof(readings));
+
+    REQUIRE(receivedHeader.id == 7);
+    REQUIRE(receivedHeader.byteCount == 16);
+    REQUIRE(readings[1].x == 3);
+    REQUIRE(readings[1].y == 4);
+}
+
+
+TEST_CASE("Client reads objects across the end of its buffer", "[socket]")
+{
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    listener.Listen();
+
+    // 20 bytes of storage, so the readings soon wrap around its end.
+    jive::Client<20> client(listener.GetLocalAddress());
+    auto server = listener.Accept();
+
+    for (int32_t i = 0; i < 10; ++i)
+    {
+        Reading reading{i, -i};
+        server.SendWait(&reading, sizeof(reading));
+
+        auto received = client.Read<Reading>();
+        REQUIRE(received.x == i);
+        REQUIRE(received.y == -i);
+    }
+
+    // Send a reading split across two segments.
+    Reading reading{42, 43};
+    auto bytes = reinterpret_cast<const char *>(&reading);
+    server.SendWait(bytes, 3);
+    server.SendWait(bytes + 3, sizeof(reading) - 3);
+
+    REQUIRE(client.Read<Reading>().y == 43);
+}
+
+
+TEST_CASE("Client reads opportunistically", "[socket]")
+{
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    listener.Listen();
+
+    jive::Client<64> client(listener.GetLocalAddress());
+    auto server = listener.Accept();
+
+    REQUIRE(!client.HasOpportunisticReads());
+    client.SetOpportunisticReads(true);
+    REQUIRE(client.HasOpportunisticReads());
+
+    // More readings than the buffer holds, so they arrive in several fills,
+    // and a header follows them in the same stream.
+    std::array<Reading, 20> readings;
+
+    for (int32_t i = 0; i < 20; ++i)
+    {
+        readings[static_cast<size_t>(i)] = Reading{i, -i};
+    }
+
+    Header header{9, 0};
+    server.SendWait(readings.data(), sizeof(readings));
+    server.SendWait(&header, sizeof(header));
+
+    for (int32_t i = 0; i < 20; ++i)
+    {
+        auto received = client.Read<Reading>();
+        REQUIRE(received.x == i);
+        REQUIRE(received.y == -i);
+    }
+
+    REQUIRE(client.Read<Header>().id == 9);
+}
+
+
+TEST_CASE("Client reads many objects at once", "[socket]")
+{
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    listener.Listen();
+
+    jive::Client<20> client(listener.GetLocalAddress());
+    auto server = listener.Accept();
+
+    std::array<Reading, 10> sent;
+
+    for (int32_t i = 0; i < 10; ++i)
+    {
+        sent[static_cast<size_t>(i)] = Reading{i, 2 * i};
+    }
+
+    Header header{5, 0};
+    server.SendWait(sent.data(), sizeof(sent));
+    server.SendWait(&header, sizeof(header));
+
+    // Buffered data is consumed before the batch is received.
+    REQUIRE(client.Peek<Reading>().x == 0);
+
+    std::array<Reading, 10> received{};
+    client.ReadMany(std::span(received));
+
+    for (size_t i = 0; i < received.size(); ++i)
+    {
+        REQUIRE(received[i].x == sent[i].x);
+        REQUIRE(received[i].y == sent[i].y);
+    }
+
+    REQUIRE(client.Read<Header>().id == 5);
+
+    // Raw reads also take buffered bytes first.
+    server.SendWait(sent.data(), 2 * sizeof(Reading));
+    REQUIRE(client.Peek<Reading>().x == 0);
+
+    std::array<Reading, 2> raw{};
+    client.Read(raw.data(), sizeof(raw));
+    REQUIRE(raw[1].x == 1);
+    REQUIRE(raw[1].y == 2);
+}
+
+
+TEST_CASE("Client holds writes until flushed", "[socket]")
+{
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    listener.Listen();
+
+    jive::Client<64> client(listener.GetLocalAddress());
+    auto server = listener.Accept();
+
+    REQUIRE(client.GetWriteHighWater() == 0);
+    client.SetWriteHighWater(1000);
+    REQUIRE(client.GetWriteHighWater() == 64);
+    client.SetWriteHighWater(32);
+
+    client.Write(Reading{1, 2});
+    client.WriteMany(Reading{3, 4}, Reading{5, 6});
+    REQUIRE(client.GetPendingWriteCount() == 3 * sizeof(Reading));
+
+    std::array<char, 64> discard;
+    REQUIRE(server.ReceiveNoWait(discard.data(), discard.size()) == 0);
+
+    client.Flush();
+    REQUIRE(client.GetPendingWriteCount() == 0);
+
+    auto received = ReceiveExactly(server, 3 * sizeof(Reading));
+    std::array<Reading, 3> readings;
+    std::memcpy(readings.data(), received.data(), sizeof(readings));
+    REQUIRE(readings[2].x == 5);
+
+    // Reaching the high-water mark sends everything.
+    for (int32_t i = 0; i < 4; ++i)
+    {
+        client.Write(Reading{i, i});
+    }
+
+    REQUIRE(client.GetPendingWriteCount() == 0);
+    REQUIRE(ReceiveExactly(server, 4 * sizeof(Reading)).size() == 32);
+}
+
+
+TEST_CASE("Client keeps buffered writes in order", "[socket]")
+{
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    listener.Listen();
+
+    jive::Client<16> client(listener.GetLocalAddress());
+    auto server = listener.Accept();
+    client.SetWriteHighWater(16);
+
+    // The header is buffered, and the payload does not fit behind it.
+    std::vector<int32_t> payload(1024 * 1024);
+    std::iota(payload.begin(), payload.end(), 0);
+    auto payloadByteCount = payload.size() * sizeof(int32_t);
+
+    Header header{3, static_cast<uint32_t>(payloadByteCount)};
+    std::string received;
+
+    std::thread reader(
+        [&]()
+        {
+            received = ReceiveExactly(
+                server,
+                sizeof(Header) + payloadByteCount);
+        });
+
+    client.Write(header);
+    REQUIRE(client.GetPendingWriteCount() == sizeof(Header));
+
+    // Larger than the socket buffers, so it takes several partial sends.
+    client.Write(payload.data(), payloadByteCount);
+    REQUIRE(client.GetPendingWriteCount() == 0);
+
+    reader.join();
+
+    Header receivedHeader;
+    std::memcpy(&receivedHeader, received.data(), sizeof(Header));
+    REQUIRE(receivedHeader.byteCount == payloadByteCount);
+
+    std::vector<int32_t> receivedPayload(payload.size());
+
+    std::memcpy(
+        receivedPayload.data(),
+        received.data() + sizeof(Header),
+        payloadByteCount);
+
+    REQUIRE(receivedPayload == payload);
+}
+
+
+TEST_CASE("Client flushes buffered writes when assigned over", "[socket]")
+{
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    listener.Listen();
+
+    jive::Client<64> client(listener.GetLocalAddress());
+    auto server = listener.Accept();
+    client.SetWriteHighWater(64);
+
+    client.Write(Header{7, 0});
+    REQUIRE(client.GetPendingWriteCount() == sizeof(Header));
+
+    client = jive::Client<64>(listener.GetLocalAddress());
+    auto replacement = listener.Accept();
+
+    Header header;
+    auto received = ReceiveExactly(server, sizeof(Header));
+    std::memcpy(&header, received.data(), sizeof(Header));
+    REQUIRE(header.id == 7);
+
+    client.Write(Header{8, 0});
+    received = ReceiveExactly(replacement, sizeof(Header));
+    std::memcpy(&header, received.data(), sizeof(Header));
+    REQUIRE(header.id == 8);
+}
+
+
+TEST_CASE("Client flushes writes before waiting to read", "[socket]")
+{
+    jive::Socket listener;
+    listener.Bind(jive::ServiceAddress("127.0.0.1", 0));
+    listener.Listen();
+
+    jive::Client<64> client(listener.GetLocalAddress());
+    auto server = listener.Accept();
+    client.SetWriteHighWater(64);
+#ifdef TCP_CORK
+    client.SetCorked(true);
+#endif
+
+    std::thread responder(
+        [&]()
+        {
+            auto request = ReceiveExactly(server, sizeof(Header));
+            server.SendWait(request.data(), request.size());
+        });
+
+    // Reading sends the buffered request before waiting for the reply.
+    client.Write(Header{11, 0});
+#ifdef TCP_CORK
+    client.SetCorked(false);
+#endif
+    REQUIRE(client.GetPendingWriteCount() == sizeof(Header));
+
+    REQUIRE(client.Read<Header>().id == 11);
+    responder.join();
+}
+
+
+TEST_CASE("Socket sets typed options", "[socket]")
+{
+    jive::Socket socket;
+
+    socket.SetOption<jive::options::ReuseAddress>(true);
+    REQUIRE(socket.GetOption<jive::options::ReuseAddress>());
+
+    socket.SetOption<jive::options::NoDelay>(true);
+    REQUIRE(socket.GetOption<jive::options::NoDelay>());
+    socket.SetOption<jive::options::NoDelay>(false);
+    REQUIRE(!socket.GetOption<jive::options::NoDelay>());
+
+#ifdef TCP_USER_TIMEOUT
+    socket.SetOption<jive::options::UserTimeout>(1500u);
+    REQUIRE(socket.GetOption<jive::options::UserTimeout>() == 1500u);
+#endif
+
+    // The kernel doubles the requested size.
+    socket.SetOption<jive::options::SendBufferSize>(64 * 1024);
+    REQUIRE(socket.GetOption<jive::options::SendBufferSize>() >= 64 * 1024);
+
+    // Untyped options take a level.
+    socket.SetSocketOption(IPPROTO_TCP, TCP_NODELAY, 1);
+    REQUIRE(socket.GetSocketOption<int>(IPPROTO_TCP, TCP_NODELAY) == 1);
+}
+
+
+#ifdef TCP_USER_TIMEOUT
+TEST_CASE("SocketTuning applies only the options it sets", "[socket]")
+{
+    jive::Socket socket;
+    socket.SetOption<jive::options::UserTimeout>(700u);
+
+    jive::SocketTuning::LowLatency().Apply(socket);
+    REQUIRE(socket.GetOption<jive::options::NoDelay>());
+    REQUIRE(socket.GetOption<jive::options::UserTimeout>() == 700u);
+
+    auto throughput = jive::SocketTuning::Throughput(256 * 1024);
+    throughput.userTimeoutMilliseconds = 0;
+    throughput.Apply(socket);
+
+    REQUIRE(!socket.GetOption<jive::options::NoDelay>());
+    REQUIRE(socket.GetOption<jive::options::UserTimeout>() == 0u);
+
+    REQUIRE(
+        socket.GetOption<jive::options::ReceiveBufferSize>() >= 256 * 1024);
+}
+#endif
+
+
+TEST_CASE("Endpoint describes each family", "[socket]")
+{
+    jive::Endpoint ipv4 = jive::ServiceAddress("127.0.0.1", 8080);
+    REQUIRE(ipv4.GetFamily() == AF_INET);
+    REQUIRE(ipv4.GetPort() == 8080);
+    REQUIRE(ipv4.ToString() == "127.0.0.1:8080");
+    REQUIRE(ipv4.GetServiceAddress().port == 8080);
+
+    auto ipv6 = jive::Endpoint::Ipv6("::1", 443);
+    REQUIRE(ipv6.GetFamily() == AF_INET6);
+    REQUIRE(ipv6.GetPort() == 443);
+    REQUIRE(ipv6.ToString() == "[::1]:443");
+    REQUIRE_THROWS_AS(ipv6.GetServiceAddress(), jive::SocketError);
+    REQUIRE_THROWS_AS(jive::Endpoint::Ipv6("1.2.3", 0), jive::SocketError);
+
+    auto path = jive::Endpoint::Unix("/tmp/jive.sock");
+    REQUIRE(path.GetFamily() == AF_UNIX);
+    REQUIRE(path.GetPort() == 0);
+    REQUIRE(path.ToString() == "/tmp/jive.sock");
+
+    using namespace std::string_literals;
+    auto abstract = jive::Endpoint::Unix("\0jive"s);
+    REQUIRE(abstract.ToString() == "@jive");
+
+    REQUIRE_THROWS_AS(
+        jive::Endpoint::Unix(std::string(200, 'x')),
+        jive::SocketError);
+
+    REQUIRE(jive::Endpoint().GetFamily() == AF_UNSPEC);
+}
+
+
+TEST_CASE("Client connects over IPv6", "[socket]")
+{
+    jive::Socket listener(AF_INET6, SOCK_STREAM);
+    listener.Bind(jive::Endpoint::Ipv6("::1", 0));
+    listener.Listen();
+
+    auto address = listener.GetLocalEndpoint();
+    REQUIRE(address.GetPort() != 0);
+
+    jive::Client<32> client(address);
+    auto server = listener.Accept();
+    REQUIRE(server.GetConnectedEndpoint().GetFamily() == AF_INET6);
+
+    REQUIRE_THROWS_AS(
+        server.GetConnectedAddress(),
+        jive::SocketError);
+
+    client.Write(Reading{6, 7});
+    auto received = ReceiveExactly(server, sizeof(Reading));
+    server.SendWait(received.data(), received.size());
+
+    REQUIRE(client.Read<Reading>().y == 7);
+}
+
+
+TEST_CASE("Client connects over a Unix domain socket", "[socket]")
+{
+    using namespace std::string_literals;
+
+    auto address = jive::Endpoint::Unix("\0jive_socket_tests"s);
+
+    jive::Socket listener(AF_UNIX, SOCK_STREAM);
+    listener.Bind(address);
+    listener.Listen();
+
+    jive::Client<32> client(address);
+    auto server = listener.Accept();
+
+    Header header{12, 0};
+    server.SendWait(&header, sizeof(header));
+
+    REQUIRE(client.Read<Header>().id == 12);
+}
+
+
 #endif
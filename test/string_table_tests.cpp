@@ -0,0 +1,140 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+#include <catch2/catch.hpp>
+
+#undef str
+#include <sstream>
+
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "jive/string_table.h"
+
+
+TEST_CASE("String tables round trip.", "[string_table]")
+{
+    // More strings than one block of lengths.
+    auto count = GENERATE(size_t{0}, size_t{1}, size_t{300});
+
+    std::vector<std::string> strings;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        strings.emplace_back(i % 17, static_cast<char>('A' + i % 26));
+    }
+
+    std::stringstream stream;
+    jive::io::WriteStringTable(stream, strings);
+
+    auto table = jive::io::ReadStringTable(stream);
+    REQUIRE(table.GetCount() == count);
+
+    size_t characterCount = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        REQUIRE(table[i] == strings[i]);
+        characterCount += strings[i].size();
+    }
+
+    REQUIRE(table.GetCharacters().size() == characterCount);
+
+    // Nothing but the table remains.
+    REQUIRE(stream.peek() == std::char_traits<char>::eof());
+}
+
+
+TEST_CASE("String tables through function objects.", "[string_table]")
+{
+    std::vector<std::string_view> strings{"alpha", "", "gamma", "delta"};
+
+    std::string bytes;
+
+    jive::io::WriteFunction writeFunction =
+        [&](const void * const source, size_t itemSize, size_t itemCount)
+        {
+            bytes.append(
+                static_cast<const char *>(source),
+                itemSize * itemCount);
+        };
+
+    jive::io::WriteStringTable<uint16_t>(writeFunction, strings);
+
+    REQUIRE(
+        bytes.size()
+        == sizeof(uint16_t) + sizeof(uint64_t) + 4 * sizeof(uint16_t) + 15);
+
+    size_t offset = 0;
+
+    jive::io::ReadFunction readFunction =
+        [&](void * const target, size_t itemSize, size_t itemCount)
+        {
+            if (offset + itemSize * itemCount > bytes.size())
+            {
+                throw jive::io::BinaryIoError("Read past end");
+            }
+
+            std::memcpy(target, bytes.data() + offset, itemSize * itemCount);
+            offset += itemSize * itemCount;
+        };
+
+    auto table = jive::io::ReadStringTable<uint16_t>(readFunction);
+    REQUIRE(table.GetCount() == 4);
+    REQUIRE(table[2] == "gamma");
+    REQUIRE(table.GetCharacters() == "alphagammadelta");
+
+    // A corrupted total is detected.
+    bytes[sizeof(uint16_t)] = 3;
+    offset = 0;
+
+    REQUIRE_THROWS_AS(
+        jive::io::ReadStringTable<uint16_t>(readFunction),
+        jive::io::BinaryIoError);
+}
+
+
+TEST_CASE("Corrupt string table headers throw.", "[string_table]")
+{
+    std::stringstream stream;
+    jive::io::Write(stream, uint32_t{3});
+    jive::io::Write(stream, uint64_t{1} << 62);
+    stream.write("abcdef", 6);
+
+    // Fails before allocating what the header claims.
+    REQUIRE_THROWS_AS(
+        jive::io::ReadStringTable(stream),
+        jive::io::BinaryIoError);
+
+    std::vector<std::string> strings{"alpha", "beta"};
+    std::stringstream valid;
+    jive::io::WriteStringTable(valid, strings);
+
+    REQUIRE_THROWS_AS(
+        jive::io::ReadStringTable(valid, 2 * sizeof(uint32_t) + 8),
+        jive::io::BinaryIoError);
+
+    valid.seekg(0);
+    REQUIRE(jive::io::ReadStringTable(valid, 2 * sizeof(uint32_t) + 9)[1]
+        == "beta");
+}
+
+
+TEST_CASE("String table lengths cannot wrap around.", "[string_table]")
+{
+    // UINT64_MAX + 2 wraps to the claimed total of 1.
+    std::stringstream stream;
+    jive::io::Write(stream, uint64_t{2});
+    jive::io::Write(stream, uint64_t{1});
+    jive::io::Write(stream, std::numeric_limits<uint64_t>::max());
+    jive::io::Write(stream, uint64_t{2});
+    stream.write("a", 1);
+
+    REQUIRE_THROWS_AS(
+        jive::io::ReadStringTable<uint64_t>(stream),
+        jive::io::BinaryIoError);
+}
@@ -0,0 +1,273 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+#include <catch2/catch.hpp>
+
+#undef str
+#include <sstream>
+
+#include <array>
+#include <limits>
+#include <random>
+#include <vector>
+#include "jive/buffered_io.h"
+#include "jive/varint.h"
+#include "jive/view_reader.h"
+
+
+TEST_CASE("ZigZag interleaves signed values.", "[varint]")
+{
+    REQUIRE(jive::io::ZigZagEncode(int32_t{0}) == 0u);
+    REQUIRE(jive::io::ZigZagEncode(int32_t{-1}) == 1u);
+    REQUIRE(jive::io::ZigZagEncode(int32_t{1}) == 2u);
+    REQUIRE(jive::io::ZigZagEncode(int32_t{-2}) == 3u);
+
+    REQUIRE(
+        jive::io::ZigZagEncode(std::numeric_limits<int64_t>::min())
+        == std::numeric_limits<uint64_t>::max());
+
+    for (auto value: std::array<int16_t, 4>{-32768, -5, 0, 32767})
+    {
+        REQUIRE(
+            jive::io::ZigZagDecode(jive::io::ZigZagEncode(value)) == value);
+    }
+}
+
+
+TEMPLATE_TEST_CASE(
+    "Varints round trip.",
+    "[varint]",
+    uint8_t,
+    int16_t,
+    uint32_t,
+    int32_t,
+    uint64_t,
+    int64_t)
+{
+    using Limits = std::numeric_limits<TestType>;
+
+    std::vector<TestType> values{
+        Limits::min(),
+        Limits::max(),
+        TestType{0},
+        TestType{1},
+        TestType{127},
+        static_cast<TestType>(Limits::max() / 3)};
+
+    if constexpr (std::is_signed_v<TestType>)
+    {
+        values.push_back(TestType{-1});
+        values.push_back(TestType{-64});
+    }
+
+    std::stringstream stream;
+
+    for (auto value: values)
+    {
+        jive::io::WriteVarint(stream, value);
+    }
+
+    for (auto value: values)
+    {
+        auto recovered = jive::io::ReadVarint<TestType>(stream);
+        REQUIRE(recovered == value);
+    }
+
+    uint8_t bytes[jive::io::maximumVarintByteCount];
+
+    for (auto value: values)
+    {
+        auto count = jive::io::EncodeVarint(value, &bytes[0]);
+        REQUIRE(count == jive::io::GetVarintByteCount(value));
+
+        TestType decoded;
+        REQUIRE(jive::io::DecodeVarint(&bytes[0], count, decoded) == count);
+        REQUIRE(decoded == value);
+
+        // Truncated input.
+        REQUIRE(jive::io::DecodeVarint(&bytes[0], count - 1, decoded) == 0);
+    }
+}
+
+
+TEST_CASE("Varint sizes and limits.", "[varint]")
+{
+    REQUIRE(jive::io::GetVarintByteCount(uint32_t{127}) == 1);
+    REQUIRE(jive::io::GetVarintByteCount(uint32_t{128}) == 2);
+    REQUIRE(jive::io::GetVarintByteCount(int32_t{-64}) == 1);
+    REQUIRE(jive::io::GetVarintByteCount(int32_t{-65}) == 2);
+
+    REQUIRE(
+        jive::io::GetVarintByteCount(std::numeric_limits<uint64_t>::max())
+        == 10);
+
+    // 300 does not fit in uint8_t.
+    uint8_t bytes[jive::io::maximumVarintByteCount];
+    auto count = jive::io::EncodeVarint(uint32_t{300}, &bytes[0]);
+    REQUIRE(count == 2);
+    REQUIRE(bytes[0] == 0xAC);
+    REQUIRE(bytes[1] == 0x02);
+
+    uint8_t small;
+    REQUIRE(jive::io::DecodeVarint(&bytes[0], count, small) == 0);
+
+    std::stringstream stream;
+    jive::io::WriteVarint(stream, uint32_t{300});
+    REQUIRE_THROWS_AS(
+        jive::io::ReadVarint<uint8_t>(stream),
+        jive::io::BinaryIoError);
+}
+
+
+TEST_CASE("Varints through buffered and view readers.", "[varint]")
+{
+    std::stringstream stream;
+
+    {
+        jive::io::BufferedWriter writer(stream);
+        jive::io::WriteVarint(writer, int64_t{-123456789});
+        jive::io::WriteVarint(writer, uint16_t{5});
+    }
+
+    auto bytes = stream.str();
+
+    jive::io::ViewReader viewReader(
+        std::as_bytes(std::span<const char>(bytes.data(), bytes.size())));
+
+    REQUIRE(jive::io::ReadVarint<int64_t>(viewReader) == -123456789);
+    REQUIRE(jive::io::ReadVarint<uint16_t>(viewReader) == 5);
+    REQUIRE(viewReader.IsEnd());
+
+    jive::io::BufferedReader bufferedReader(stream);
+    REQUIRE(jive::io::ReadVarint<int64_t>(bufferedReader) == -123456789);
+    REQUIRE(jive::io::ReadVarint<uint16_t>(bufferedReader) == 5);
+}
+
+
+TEST_CASE("Bulk varint arrays round trip.", "[varint]")
+{
+    std::mt19937_64 engine(42);
+
+    // Mostly small values, with occasional large ones.
+    std::vector<int64_t> values(1003);
+
+    for (auto &value: values)
+    {
+        auto bits = engine();
+        value = ((bits & 0xF) == 0)
+            ? static_cast<int64_t>(bits)
+            : static_cast<int64_t>(bits % 100) - 50;
+    }
+
+    std::vector<uint8_t> encoded(
+        values.size() * jive::io::maximumVarintByteCount);
+
+    auto byteCount = jive::io::EncodeVarints(
+        std::span<const int64_t>(values),
+        encoded.data());
+
+    std::vector<int64_t> decoded(values.size());
+
+    REQUIRE(
+        jive::io::DecodeVarints(
+            encoded.data(),
+            byteCount,
+            std::span<int64_t>(decoded))
+        == byteCount);
+
+    REQUIRE(decoded == values);
+
+    REQUIRE(
+        jive::io::DecodeVarints(
+            encoded.data(),
+            byteCount - 1,
+            std::span<int64_t>(decoded))
+        == 0);
+}
+
+
+TEST_CASE("Stream VByte round trips.", "[varint]")
+{
+    std::mt19937 engine(7);
+
+    auto count = GENERATE(size_t{0}, size_t{1}, size_t{5}, size_t{1000});
+
+    std::vector<uint32_t> values(count);
+
+    for (auto &value: values)
+    {
+        // Spread values over every encoded length.
+        value = static_cast<uint32_t>(engine() >> (8 * (engine() % 4)));
+    }
+
+    std::vector<uint8_t> encoded(
+        jive::io::GetStreamVByteMaximumByteCount(count));
+
+    auto byteCount = jive::io::EncodeStreamVByte(values, encoded.data());
+    REQUIRE(byteCount <= encoded.size());
+
+    // Exact-size input, so the vector loop must stop before the end.
+    std::vector<uint8_t> exact(
+        encoded.begin(),
+        encoded.begin() + static_cast<std::ptrdiff_t>(byteCount));
+    std::vector<uint32_t> decoded(count);
+
+    REQUIRE(
+        jive::io::DecodeStreamVByte(exact.data(), exact.size(), decoded)
+        == byteCount);
+
+    REQUIRE(decoded == values);
+
+    if (count > 0)
+    {
+        REQUIRE(
+            jive::io::DecodeStreamVByte(exact.data(), byteCount - 1, decoded)
+            == 0);
+    }
+}
+
+
+#if defined(JIVE_X86_DISPATCH) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+
+TEST_CASE("The Stream VByte shuffle kernel decodes.", "[varint]")
+{
+    if (!jive::detail::HasSsse3())
+    {
+        return;
+    }
+
+    std::vector<uint32_t> values(1000);
+
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = static_cast<uint32_t>(i * 2654435761u) >> (8 * (i % 4));
+    }
+
+    std::vector<uint8_t> encoded(
+        jive::io::GetStreamVByteMaximumByteCount(values.size()));
+
+    auto byteCount = jive::io::EncodeStreamVByte(values, encoded.data());
+    auto controlCount = (values.size() + 3) / 4;
+
+    const uint8_t *data = encoded.data() + controlCount;
+    std::vector<uint32_t> decoded(values.size());
+
+    auto decodedCount = jive::io::detail::DecodeStreamVByteSsse3(
+        encoded.data(),
+        data,
+        encoded.data() + byteCount,
+        decoded);
+
+    // Only the last few groups are left for the scalar loop.
+    REQUIRE(decodedCount % 4 == 0);
+    REQUIRE(decodedCount >= values.size() - 16);
+
+    for (size_t i = 0; i < decodedCount; ++i)
+    {
+        REQUIRE(decoded[i] == values[i]);
+    }
+}
+
+#endif
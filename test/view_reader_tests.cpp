@@ -0,0 +1,107 @@
+/**
+  * @author Jive Helix (jivehelix@gmail.com)
+  * @copyright 2020 Jive Helix
+  * Licensed under the MIT license. See LICENSE file.
+  */
+#include <catch2/catch.hpp>
+
+#undef str
+#include <sstream>
+
+#include <cstring>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <vector>
+#include "jive/binary_io.h"
+#include "jive/buffer.h"
+#include "jive/view_reader.h"
+
+
+static jive::Buffer<std::byte> ToBuffer(const std::string &bytes)
+{
+    jive::Buffer<std::byte> result(bytes.size());
+    std::memcpy(result.Get(), bytes.data(), bytes.size());
+
+    return result;
+}
+
+
+TEST_CASE("ViewReader parses the binary_io format.", "[view_reader]")
+{
+    std::vector<uint32_t> values(50);
+    std::iota(values.begin(), values.end(), uint32_t{7});
+
+    std::stringstream stream;
+    jive::io::Write(stream, uint8_t{3});
+    jive::io::Write(stream, std::string("short"));
+    jive::io::WriteString<uint16_t>(stream, "view into the source");
+    jive::io::Write(stream, std::optional<int64_t>(-9));
+    jive::io::Write(stream, std::optional<int64_t>());
+    jive::io::Write<std::endian::big>(stream, uint16_t{0x1234});
+    jive::io::Write(stream, double{1.25});
+    jive::io::WriteArray<uint32_t>(stream, values);
+
+    auto source = ToBuffer(stream.str());
+    jive::io::ViewReader reader(source);
+
+    // The uint8_t leaves the double misaligned.
+    REQUIRE(reader.Read<uint8_t>() == 3);
+    REQUIRE(reader.Read<std::string_view>() == "short");
+
+    auto view = reader.ReadString<uint16_t>();
+    REQUIRE(view == "view into the source");
+
+    // No copy was made.
+    auto viewBegin = reinterpret_cast<const std::byte *>(view.data());
+    REQUIRE(viewBegin > source.Get());
+    REQUIRE(viewBegin < source.Get() + source.GetElementCount());
+
+    REQUIRE(reader.Read<std::optional<int64_t>>() == -9);
+    REQUIRE(!reader.Read<std::optional<int64_t>>());
+    REQUIRE(reader.Read<std::endian::big, uint16_t>() == 0x1234);
+    REQUIRE(reader.Read<double>() == 1.25);
+
+    auto count = reader.Read<uint32_t>();
+    REQUIRE(count == values.size());
+
+    auto bytes = reader.ReadBytes(count * sizeof(uint32_t));
+    REQUIRE(std::memcmp(bytes.data(), values.data(), bytes.size()) == 0);
+    REQUIRE(reader.IsEnd());
+
+    REQUIRE_THROWS_AS(reader.Read<uint8_t>(), jive::io::BinaryIoError);
+}
+
+
+TEST_CASE("ViewReader returns aligned arrays in place.", "[view_reader]")
+{
+    std::vector<double> values(100);
+    std::iota(values.begin(), values.end(), 0.5);
+
+    std::stringstream stream;
+
+    // Pad the count so the elements are 8 byte aligned.
+    jive::io::WriteArray<uint64_t>(stream, values);
+
+    auto source = ToBuffer(stream.str());
+    jive::io::ViewReader reader(source);
+
+    auto elements = reader.ReadSpan<double, uint64_t>();
+    REQUIRE(elements.size() == values.size());
+    REQUIRE(std::equal(elements.begin(), elements.end(), values.begin()));
+
+    REQUIRE(
+        reinterpret_cast<const std::byte *>(elements.data())
+        == source.Get() + 8);
+
+    jive::io::ViewReader misaligned(
+        std::span<const std::byte>(source.Get() + 1, 16));
+
+    REQUIRE_THROWS_AS(
+        misaligned.ReadSpan<double>(1),
+        jive::io::BinaryIoError);
+
+    jive::io::ViewReader truncated(std::span<const std::byte>(source.Get(), 4));
+    REQUIRE_THROWS_AS(truncated.ReadString(), jive::io::BinaryIoError);
+    REQUIRE(truncated.GetRemaining() == 0);
+}